@@ -0,0 +1,52 @@
+#!/bin/sh
+
+# Form a Redis cluster out of redis-cluster-1..N (REDIS_CLUSTER_SIZE), one
+# master per node and no replicas: the slots are split into N even ranges,
+# then every node meets the first one. Unlike redis-cli --cluster create
+# this also works for a single node, so a 1-node cluster can be measured
+# with the same sharded pub/sub client as the larger ones.
+
+set -e
+
+N=${REDIS_CLUSTER_SIZE:-3}
+SLOTS=16384
+
+for i in $(seq 1 "$N"); do
+    until redis-cli -h "redis-cluster-$i" ping > /dev/null 2>&1; do sleep 1; done
+    redis-cli -h "redis-cluster-$i" cluster reset hard > /dev/null
+done
+
+for i in $(seq 1 "$N"); do
+    first=$(( (i - 1) * SLOTS / N ))
+    last=$(( i * SLOTS / N - 1 ))
+    redis-cli -h "redis-cluster-$i" cluster addslotsrange "$first" "$last" > /dev/null
+    # Distinct epochs, or the nodes stall resolving the collision
+    redis-cli -h "redis-cluster-$i" cluster set-config-epoch "$i" > /dev/null || true
+done
+
+# CLUSTER MEET wants an address, not a host name
+first_ip=$(getent hosts redis-cluster-1 | awk '{ print $1 }')
+for i in $(seq 2 "$N"); do
+    redis-cli -h "redis-cluster-$i" cluster meet "$first_ip" 6379 > /dev/null
+done
+
+echo "⏳ Waiting for $N-node cluster..."
+for attempt in $(seq 1 60); do
+    ready=0
+    for i in $(seq 1 "$N"); do
+        info=$(redis-cli -h "redis-cluster-$i" cluster info)
+        if echo "$info" | grep -q "cluster_state:ok" &&
+           echo "$info" | grep -q "cluster_known_nodes:$N"; then
+            ready=$((ready + 1))
+        fi
+    done
+    if [ "$ready" -eq "$N" ]; then
+        echo "✓ Redis cluster of $N node(s) is up"
+        exit 0
+    fi
+    sleep 1
+done
+
+echo "❌ Redis cluster did not converge"
+redis-cli -h redis-cluster-1 cluster nodes
+exit 1
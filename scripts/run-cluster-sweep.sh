@@ -0,0 +1,111 @@
+#!/bin/bash
+
+# Scale-out sweep over clustered brokers: a Redis Cluster with sharded
+# pub/sub (SPUBLISH/SSUBSCRIBE) and a routed NATS cluster, each at
+# 1, 3 and 5 nodes (CLUSTER_SWEEP_NODES). Every point is its own batch,
+# <sweep>_<topology>_n<nodes>, merged by the aggregator, whose report lists
+# broker CPU per node next to the delivered throughput.
+#
+#   CLUSTER_SWEEP_NODES="1 3 5" CLUSTER_TOPOLOGIES="redis-cluster nats-cluster" \
+#     ./scripts/run-cluster-sweep.sh
+
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+COMPOSE="docker-compose -f $PROJECT_DIR/docker/docker-compose.yml"
+
+if [ -f "$PROJECT_DIR/.env" ]; then
+    export $(grep -v '^#' "$PROJECT_DIR/.env" | xargs)
+else
+    echo "❌ Error: .env file not found"
+    exit 1
+fi
+
+NUM_SUBSCRIBERS=${NUM_SUBSCRIBERS:-3}
+PUBLISH_DURATION_SECONDS=${PUBLISH_DURATION_SECONDS:-10}
+READY_TIMEOUT_SECONDS=${READY_TIMEOUT_SECONDS:-60}
+PUBLISHER_PROCESSES=${PUBLISHER_PROCESSES:-1}
+CLUSTER_SWEEP_NODES=${CLUSTER_SWEEP_NODES:-"1 3 5"}
+CLUSTER_TOPOLOGIES=${CLUSTER_TOPOLOGIES:-"redis-cluster nats-cluster"}
+CLUSTER_NUM_TOPICS=${CLUSTER_NUM_TOPICS:-16}
+SWEEP_ID=${SWEEP_ID:-$(date +%Y-%m-%d_%H-%M-%S)}
+export NUM_SUBSCRIBERS PUBLISH_DURATION_SECONDS PUBLISHER_PROCESSES CLUSTER_NUM_TOPICS
+
+DATA_DIR="$PROJECT_DIR/bench-data"
+mkdir -p "$DATA_DIR"
+
+if ! docker info > /dev/null 2>&1; then
+    echo "❌ Error: Docker is not running. Please start Docker first."
+    exit 1
+fi
+
+echo "🧭 Cluster sweep $SWEEP_ID: $CLUSTER_TOPOLOGIES at $CLUSTER_SWEEP_NODES node(s), $CLUSTER_NUM_TOPICS topics"
+echo ""
+
+# Start the first $2 nodes of topology $1 and make a cluster of them
+start_cluster() {
+    local topology=$1 nodes=$2 services=()
+    for i in $(seq 1 "$nodes"); do services+=("$topology-$i"); done
+
+    if [ "$topology" = "nats-cluster" ]; then
+        local routes=() urls=()
+        for i in $(seq 1 "$nodes"); do
+            routes+=("nats://nats-cluster-$i:6222")
+            urls+=("nats://nats-cluster-$i:4222")
+        done
+        export NATS_CLUSTER_ROUTES=$(IFS=,; echo "${routes[*]}")
+        export NATS_CLUSTER_URLS=$(IFS=,; echo "${urls[*]}")
+        $COMPOSE --profile nats-cluster-bench up -d "${services[@]}" > /dev/null 2>&1
+    else
+        export REDIS_CLUSTER_SIZE=$nodes
+        $COMPOSE --profile redis-cluster-bench up -d "${services[@]}" > /dev/null 2>&1
+        $COMPOSE --profile redis-cluster-bench run --rm redis-cluster-init
+    fi
+}
+
+run_point() {
+    local topology=$1 nodes=$2
+    export BATCH_ID="${SWEEP_ID}_${topology}_n${nodes}"
+    echo "🔗 $topology, $nodes node(s) — batch $BATCH_ID"
+    echo "─────────────────────────────────────────────"
+
+    start_cluster "$topology" "$nodes"
+    $COMPOSE --profile "$topology-bench" up -d --scale "$topology-subscriber=$NUM_SUBSCRIBERS" \
+        "$topology-subscriber" > /dev/null 2>&1
+    $COMPOSE --profile "$topology-bench" up -d --scale "$topology-publisher=$PUBLISHER_PROCESSES" \
+        "$topology-publisher" > /dev/null 2>&1
+
+    echo "⏳ Publishing for $PUBLISH_DURATION_SECONDS seconds..."
+    local wait_timeout=$((PUBLISH_DURATION_SECONDS + READY_TIMEOUT_SECONDS + 30))
+    local wait_start=$(date +%s)
+    while docker ps --filter "name=$topology-publisher" --format "{{.Names}}" 2>/dev/null | grep -q "$topology-publisher"; do
+        if [ $(($(date +%s) - wait_start)) -gt $wait_timeout ]; then
+            echo "⚠️  Publisher timeout, forcing stop..."
+            $COMPOSE --profile "$topology-bench" stop "$topology-publisher" 2>/dev/null || true
+            break
+        fi
+        sleep 1
+    done
+    # Give the subscribers their END grace period before tearing down
+    sleep 5
+
+    $COMPOSE --profile "$topology-bench" run --rm --no-deps "$topology-publisher" \
+        ./aggregator "/data/$BATCH_ID" all --csv "/data/$BATCH_ID/merged" \
+        | sed -n '/🔀 Batch/,$p' || echo "⚠️  Aggregator failed for $BATCH_ID"
+
+    $COMPOSE --profile "$topology-bench" down -v > /dev/null 2>&1 || true
+    echo ""
+}
+
+for topology in $CLUSTER_TOPOLOGIES; do
+    for nodes in $CLUSTER_SWEEP_NODES; do
+        if [ "$nodes" -lt 1 ] || [ "$nodes" -gt 5 ]; then
+            echo "⚠️  Skipping $nodes node(s): docker-compose.yml defines 1 to 5"
+            continue
+        fi
+        run_point "$topology" "$nodes"
+    done
+done
+
+echo "✅ Sweep $SWEEP_ID complete; batches are in $DATA_DIR/${SWEEP_ID}_*"
@@ -21,11 +21,17 @@ fi
 NUM_SUBSCRIBERS=${NUM_SUBSCRIBERS:-3}
 NUM_PUBLISHERS=${NUM_PUBLISHERS:-3}
 PUBLISH_DURATION_SECONDS=${PUBLISH_DURATION_SECONDS:-10}
+READY_TIMEOUT_SECONDS=${READY_TIMEOUT_SECONDS:-60}
+# Publisher processes in the run, and how many of them run on this machine;
+# the rest join from other nodes with scripts/run-publisher-node.sh
+PUBLISHER_PROCESSES=${PUBLISHER_PROCESSES:-1}
+LOCAL_PUBLISHER_PROCESSES=${LOCAL_PUBLISHER_PROCESSES:-$PUBLISHER_PROCESSES}
 
 # Export variables for docker-compose
 export NUM_SUBSCRIBERS
 export NUM_PUBLISHERS
 export PUBLISH_DURATION_SECONDS
+export PUBLISHER_PROCESSES
 
 DATA_DIR="$PROJECT_DIR/bench-data"
 
@@ -33,7 +39,7 @@ export BATCH_ID=$(date +%Y-%m-%d_%H-%M-%S)
 
 echo "📋 Configuration:"
 echo "  Subscribers:  $NUM_SUBSCRIBERS"
-echo "  Publishers:   $NUM_PUBLISHERS"
+echo "  Publishers:   $NUM_PUBLISHERS per process, $PUBLISHER_PROCESSES process(es) ($LOCAL_PUBLISHER_PROCESSES here)"
 echo "  Duration:     $PUBLISH_DURATION_SECONDS seconds"
 echo "  Batch ID:     $BATCH_ID"
 echo "  DATA_DIR:     $DATA_DIR"
@@ -51,7 +57,7 @@ fi
 # Cleanup function
 cleanup() {
     echo "Cleaning up..."
-    # docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench --profile nats-bench down -v 2>/dev/null || true
+    # docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench --profile redis-streams-bench --profile nats-bench --profile jetstream-bench down -v 2>/dev/null || true
 }
 
 # Set trap to cleanup on exit
@@ -66,18 +72,14 @@ run_redis_benchmark() {
     docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench up -d redis > /dev/null 2>&1
     docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench up -d --scale redis-subscriber=$NUM_SUBSCRIBERS redis-subscriber > /dev/null 2>&1
     
-    # Wait for subscribers to be ready (Redis Pub/Sub requires subscribers to be fully subscribed before publishing)
-    echo "⏳ Waiting for subscribers to connect and subscribe..."
-    sleep 5
-    
-    # Start publisher
-    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench up -d redis-publisher > /dev/null 2>&1
+    # Start publishers right away: they block until NUM_SUBSCRIBERS subscribers announce READY
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench up -d --scale redis-publisher=$LOCAL_PUBLISHER_PROCESSES redis-publisher > /dev/null 2>&1
     
     # Show publisher is running
     echo "⏳ Publishing for $PUBLISH_DURATION_SECONDS seconds..."
     
-    # Wait for publisher to finish (with timeout of duration + 30 seconds buffer)
-    local wait_timeout=$((PUBLISH_DURATION_SECONDS + 30))
+    # Wait for the publishers to finish (duration + readiness timeout + 30 seconds buffer)
+    local wait_timeout=$((PUBLISH_DURATION_SECONDS + READY_TIMEOUT_SECONDS + 30))
     local wait_start=$(date +%s)
     while docker ps --filter "name=redis-publisher" --format "{{.Names}}" 2>/dev/null | grep -q redis-publisher; do
         local elapsed=$(($(date +%s) - wait_start))
@@ -93,6 +95,39 @@ run_redis_benchmark() {
     docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench logs redis-publisher 2>/dev/null | grep -E "Configuration|Results|Throughput|Complete" | head -15
 }
 
+# Function to run Redis Streams benchmark (same Redis server, XADD/XREADGROUP)
+run_redis_streams_benchmark() {
+    echo ""
+    echo "🟠 REDIS STREAMS BENCHMARK"
+    echo "─────────────────────────────────────────────"
+    
+    # Start Redis and subscribers first
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-streams-bench up -d redis > /dev/null 2>&1
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-streams-bench up -d --scale redis-streams-subscriber=$NUM_SUBSCRIBERS redis-streams-subscriber > /dev/null 2>&1
+    
+    # Start publishers right away: they block until NUM_SUBSCRIBERS subscribers announce READY
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-streams-bench up -d --scale redis-streams-publisher=$LOCAL_PUBLISHER_PROCESSES redis-streams-publisher > /dev/null 2>&1
+    
+    # Show publisher is running
+    echo "⏳ Publishing for $PUBLISH_DURATION_SECONDS seconds..."
+    
+    # Wait for the publishers to finish (duration + readiness timeout + 30 seconds buffer)
+    local wait_timeout=$((PUBLISH_DURATION_SECONDS + READY_TIMEOUT_SECONDS + 30))
+    local wait_start=$(date +%s)
+    while docker ps --filter "name=redis-streams-publisher" --format "{{.Names}}" 2>/dev/null | grep -q redis-streams-publisher; do
+        local elapsed=$(($(date +%s) - wait_start))
+        if [ $elapsed -gt $wait_timeout ]; then
+            echo "⚠️  Publisher timeout after ${elapsed}s, forcing stop..."
+            docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-streams-bench stop redis-streams-publisher 2>/dev/null || true
+            break
+        fi
+        sleep 1
+    done
+    
+    # Get publisher output
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-streams-bench logs redis-streams-publisher 2>/dev/null | grep -E "Configuration|Results|Throughput|Complete" | head -15
+}
+
 # Function to run NATS benchmark
 run_nats_benchmark() {
     echo ""
@@ -103,18 +138,14 @@ run_nats_benchmark() {
     docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile nats-bench up -d nats > /dev/null 2>&1
     docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile nats-bench up -d --scale nats-subscriber=$NUM_SUBSCRIBERS nats-subscriber > /dev/null 2>&1
     
-    # Wait for subscribers to be ready (give them time to connect and subscribe)
-    echo "⏳ Waiting for subscribers to connect..."
-    sleep 3
-    
-    # Start publisher
-    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile nats-bench up -d nats-publisher > /dev/null 2>&1
+    # Start publishers right away: they block until NUM_SUBSCRIBERS subscribers announce READY
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile nats-bench up -d --scale nats-publisher=$LOCAL_PUBLISHER_PROCESSES nats-publisher > /dev/null 2>&1
     
     # Show publisher is running
     echo "⏳ Publishing for $PUBLISH_DURATION_SECONDS seconds..."
     
-    # Wait for publisher to finish (with timeout of duration + 30 seconds buffer)
-    local wait_timeout=$((PUBLISH_DURATION_SECONDS + 30))
+    # Wait for the publishers to finish (duration + readiness timeout + 30 seconds buffer)
+    local wait_timeout=$((PUBLISH_DURATION_SECONDS + READY_TIMEOUT_SECONDS + 30))
     local wait_start=$(date +%s)
     while docker ps --filter "name=nats-publisher" --format "{{.Names}}" 2>/dev/null | grep -q nats-publisher; do
         local elapsed=$(($(date +%s) - wait_start))
@@ -130,7 +161,50 @@ run_nats_benchmark() {
     docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile nats-bench logs nats-publisher 2>/dev/null | grep -E "Configuration|Results|Throughput|Complete" | head -15
 }
 
-# Analyze JSON files in /data using DuckDB and print analytics
+# Function to run JetStream benchmark (same NATS server, js_PublishAsync/Fetch)
+run_jetstream_benchmark() {
+    echo ""
+    echo "🔵 JETSTREAM BENCHMARK"
+    echo "─────────────────────────────────────────────"
+    
+    # Start NATS and subscribers first
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile jetstream-bench up -d nats > /dev/null 2>&1
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile jetstream-bench up -d --scale jetstream-subscriber=$NUM_SUBSCRIBERS jetstream-subscriber > /dev/null 2>&1
+    
+    # Start publishers right away: they block until NUM_SUBSCRIBERS subscribers announce READY
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile jetstream-bench up -d --scale jetstream-publisher=$LOCAL_PUBLISHER_PROCESSES jetstream-publisher > /dev/null 2>&1
+    
+    # Show publisher is running
+    echo "⏳ Publishing for $PUBLISH_DURATION_SECONDS seconds..."
+    
+    # Wait for the publishers to finish (duration + readiness timeout + 30 seconds buffer)
+    local wait_timeout=$((PUBLISH_DURATION_SECONDS + READY_TIMEOUT_SECONDS + 30))
+    local wait_start=$(date +%s)
+    while docker ps --filter "name=jetstream-publisher" --format "{{.Names}}" 2>/dev/null | grep -q jetstream-publisher; do
+        local elapsed=$(($(date +%s) - wait_start))
+        if [ $elapsed -gt $wait_timeout ]; then
+            echo "⚠️  Publisher timeout after ${elapsed}s, forcing stop..."
+            docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile jetstream-bench stop jetstream-publisher 2>/dev/null || true
+            break
+        fi
+        sleep 1
+    done
+    
+    # Get publisher output
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile jetstream-bench logs jetstream-publisher 2>/dev/null | grep -E "Configuration|Results|Throughput|Complete" | head -15
+}
+
+# Merge the per-container JSON files into CSV with the aggregator (any
+# benchmark image has it), so DuckDB reads flat tables instead of raw JSON
+merge_results() {
+    echo ""
+    echo "🗂️  Merging results for batch $BATCH_ID..."
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile redis-bench run --rm --no-deps \
+        redis-publisher ./aggregator "/data/$BATCH_ID" all --csv "/data/$BATCH_ID/merged" \
+        || echo "⚠️  Aggregator failed, the summary below will be empty"
+}
+
+# Analyze the merged CSV files in /data using DuckDB and print analytics
 analyze_with_duckdb() {
     echo ""
     echo "📊 Benchmark Results Summary"
@@ -139,36 +213,52 @@ analyze_with_duckdb() {
     docker run --rm \
       -v "$DATA_DIR":/data \
       duckdb/duckdb:latest \
-      duckdb -c "INSTALL json; LOAD json; \
-          CREATE OR REPLACE TABLE results AS SELECT * FROM read_json('/data/$BATCH_ID/*.json'); \
+      duckdb -c "CREATE OR REPLACE TABLE subscribers AS SELECT * FROM read_csv('/data/$BATCH_ID/merged/subscribers.csv', header = true); \
+          CREATE OR REPLACE TABLE publishers AS SELECT * FROM read_csv('/data/$BATCH_ID/merged/publishers.csv', header = true); \
           
           -- Display configuration
           SELECT 
               'Test Configuration' AS info_type,
-              MAX(config['num_publishers']) || ' Publisher' AS publishers,
-              MAX(config['num_subscribers']) || ' Subscribers' AS subscribers,
-              MAX(config['publish_duration_seconds']) || ' seconds' AS duration
-          FROM results 
-          WHERE role = 'publisher'
+              MAX(num_publishers) || ' Publisher' AS publishers,
+              MAX(num_subscribers) || ' Subscribers' AS subscribers,
+              MAX(publish_duration_seconds) || ' seconds' AS duration
+          FROM publishers
           LIMIT 1;
           
           -- Display performance metrics
+          WITH pub AS (
+              SELECT broker_type, MAX(publish_mode) AS publish_mode, MAX(publish_batch_size) AS batch,
+                     SUM(messages_published) AS sent, SUM(throughput_msg_per_sec) AS send_rate
+              FROM publishers GROUP BY broker_type
+          ), sub AS (
+              SELECT broker_type, SUM(messages_received) AS received, AVG(throughput_msg_per_sec) AS receive_rate,
+                     AVG(throughput_bytes_per_sec) AS receive_bytes, MAX(latency_p99_us) AS worst_p99,
+                     SUM(dropped_messages) AS drops
+              FROM subscribers GROUP BY broker_type
+          )
           SELECT 
               UPPER(broker_type) AS \"Message Broker\",
-              format('{:,}', COALESCE(MAX(CASE WHEN role = 'publisher' THEN results['messages_published'] END), 0)) AS \"Messages Sent\",
-              format('{:,.0f}', COALESCE(MAX(CASE WHEN role = 'publisher' THEN results['throughput_msg_per_sec'] END), 0)) AS \"Send Rate (msg/s)\",
-              format('{:,}', COALESCE(SUM(CASE WHEN role IS NULL THEN messages_received END), 0)) AS \"Total Received\",
-              format('{:,.0f}', COALESCE(AVG(CASE WHEN role IS NULL THEN throughput_msg_per_sec END), 0)) AS \"Avg Receive Rate (msg/s)\"
-          FROM results 
-          GROUP BY broker_type 
+              pub.publish_mode AS \"Publish Mode\",
+              pub.batch AS \"Batch\",
+              format('{:,}', COALESCE(pub.sent, 0)) AS \"Messages Sent\",
+              format('{:,.0f}', COALESCE(pub.send_rate, 0)) AS \"Send Rate (msg/s)\",
+              format('{:,}', COALESCE(sub.received, 0)) AS \"Total Received\",
+              format('{:,.0f}', COALESCE(sub.receive_rate, 0)) AS \"Avg Receive Rate (msg/s)\",
+              format('{:,.2f}', COALESCE(sub.receive_bytes, 0) / 1048576) AS \"Avg Receive MiB/s\",
+              format('{:,.1f}', COALESCE(sub.worst_p99, 0)) AS \"Worst p99 (us)\",
+              format('{:,}', COALESCE(sub.drops, 0)) AS \"Client Drops\"
+          FROM sub FULL OUTER JOIN pub USING (broker_type)
           ORDER BY broker_type;" 2>&1 | grep -v "varchar\|int64\|BIGINT\|DOUBLE"
 }
 
 # Run benchmarks
 run_redis_benchmark
+run_redis_streams_benchmark
 run_nats_benchmark
+run_jetstream_benchmark
 
-# Run analytics over persisted JSON results
+# Merge persisted JSON results and run analytics over them
+merge_results
 analyze_with_duckdb
 
 echo "╔═══════════════════════════════════════════════╗"
@@ -0,0 +1,145 @@
+#!/bin/bash
+
+# Broker outage in the middle of a run, to see how each client recovers.
+# FAULT_AT_SECONDS into the publish window the broker container is hit
+# with FAULT_MODE, and brought back FAULT_DURATION_SECONDS later:
+#   kill   SIGKILL the container, then start it again: connections reset,
+#          the clients reconnect and resubscribe (BROKER_RECONNECT=1)
+#   pause  freeze it (docker pause), then unpause: connections stay open
+#          but nothing moves, as with a stalled broker or a network stall
+# Every broker in FAULT_BROKERS is its own batch, <run>_<broker>_<mode>.
+# The fault window goes to bench-data/<batch>/fault.json, and the
+# aggregator's recovery report measures the throughput dip against it.
+#
+#   FAULT_MODE=kill FAULT_AT_SECONDS=10 FAULT_DURATION_SECONDS=5 \
+#     FAULT_BROKERS="redis nats" ./scripts/run-fault-test.sh
+
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+COMPOSE="docker-compose -f $PROJECT_DIR/docker/docker-compose.yml"
+
+if [ -f "$PROJECT_DIR/.env" ]; then
+    export $(grep -v '^#' "$PROJECT_DIR/.env" | xargs)
+else
+    echo "❌ Error: .env file not found"
+    exit 1
+fi
+
+NUM_SUBSCRIBERS=${NUM_SUBSCRIBERS:-3}
+PUBLISH_DURATION_SECONDS=${PUBLISH_DURATION_SECONDS:-30}
+READY_TIMEOUT_SECONDS=${READY_TIMEOUT_SECONDS:-60}
+PUBLISHER_PROCESSES=${PUBLISHER_PROCESSES:-1}
+FAULT_MODE=${FAULT_MODE:-kill}
+FAULT_AT_SECONDS=${FAULT_AT_SECONDS:-10}
+FAULT_DURATION_SECONDS=${FAULT_DURATION_SECONDS:-5}
+FAULT_BROKERS=${FAULT_BROKERS:-"redis nats"}
+RUN_ID=${RUN_ID:-$(date +%Y-%m-%d_%H-%M-%S)}
+export NUM_SUBSCRIBERS PUBLISH_DURATION_SECONDS PUBLISHER_PROCESSES
+
+if [ "$FAULT_MODE" != "kill" ] && [ "$FAULT_MODE" != "pause" ]; then
+    echo "❌ Error: FAULT_MODE must be kill or pause, not '$FAULT_MODE'"
+    exit 1
+fi
+if [ $((FAULT_AT_SECONDS + FAULT_DURATION_SECONDS)) -ge "$PUBLISH_DURATION_SECONDS" ]; then
+    echo "⚠️  The fault ends after the publish window; recovery will not be measured"
+fi
+
+DATA_DIR="$PROJECT_DIR/bench-data"
+mkdir -p "$DATA_DIR"
+
+if ! docker info > /dev/null 2>&1; then
+    echo "❌ Error: Docker is not running. Please start Docker first."
+    exit 1
+fi
+
+echo "💥 Fault test $RUN_ID: $FAULT_MODE the broker at ${FAULT_AT_SECONDS}s for ${FAULT_DURATION_SECONDS}s" \
+     "of a ${PUBLISH_DURATION_SECONDS}s run ($FAULT_BROKERS)"
+echo ""
+
+# Wall-clock milliseconds, the clock of the result files' timeseries
+now_ms() {
+    date +%s%3N
+}
+
+# Hit broker service $2 of profile $1, wait, bring it back; the window goes to $3
+inject_fault() {
+    local compose="$COMPOSE --profile $1" service=$2 fault_file=$3 start_ms end_ms
+    start_ms=$(now_ms)
+    if [ "$FAULT_MODE" = "kill" ]; then
+        echo "💀 Killing $service"
+        $compose kill "$service" > /dev/null 2>&1
+        sleep "$FAULT_DURATION_SECONDS"
+        $compose start "$service" > /dev/null 2>&1
+    else
+        echo "⏸️  Pausing $service"
+        $compose pause "$service" > /dev/null 2>&1
+        sleep "$FAULT_DURATION_SECONDS"
+        $compose unpause "$service" > /dev/null 2>&1
+    fi
+    end_ms=$(now_ms)
+    echo "▶️  $service is back after $((end_ms - start_ms)) ms"
+    mkdir -p "$(dirname "$fault_file")"
+    echo "{\"mode\": \"$FAULT_MODE\", \"service\": \"$service\", \"start_ms\": $start_ms, \"end_ms\": $end_ms}" \
+        > "$fault_file"
+}
+
+run_broker() {
+    local broker=$1 profile="$1-bench" service
+    case "$broker" in
+        redis|redis-streams) service=redis ;;
+        nats|jetstream) service=nats ;;
+        *) echo "⚠️  Skipping $broker: no single broker container to fail"; return ;;
+    esac
+    export BATCH_ID="${RUN_ID}_${broker}_${FAULT_MODE}"
+    echo "🔌 $broker — batch $BATCH_ID"
+    echo "─────────────────────────────────────────────"
+
+    $COMPOSE --profile "$profile" up -d "$service" > /dev/null 2>&1
+    $COMPOSE --profile "$profile" up -d --scale "$broker-subscriber=$NUM_SUBSCRIBERS" \
+        "$broker-subscriber" > /dev/null 2>&1
+    $COMPOSE --profile "$profile" up -d --scale "$broker-publisher=$PUBLISHER_PROCESSES" \
+        "$broker-publisher" > /dev/null 2>&1
+
+    # The publishers wait for READY first; start the clock once they publish
+    local ready_start=$(date +%s)
+    until $COMPOSE --profile "$profile" logs "$broker-publisher" 2>/dev/null \
+        | grep -qE "ready after|Start time received|starting anyway"; do
+        if [ $(($(date +%s) - ready_start)) -gt "$READY_TIMEOUT_SECONDS" ]; then
+            echo "⚠️  Publishers never started, skipping the fault"
+            break
+        fi
+        sleep 0.2
+    done
+
+    echo "⏳ Publishing for $PUBLISH_DURATION_SECONDS seconds..."
+    sleep "$FAULT_AT_SECONDS"
+    inject_fault "$profile" "$service" "$DATA_DIR/$BATCH_ID/fault.json"
+
+    local wait_timeout=$((PUBLISH_DURATION_SECONDS + READY_TIMEOUT_SECONDS + 30))
+    local wait_start=$(date +%s)
+    while docker ps --filter "name=$broker-publisher" --format "{{.Names}}" 2>/dev/null | grep -q "$broker-publisher"; do
+        if [ $(($(date +%s) - wait_start)) -gt $wait_timeout ]; then
+            echo "⚠️  Publisher timeout, forcing stop..."
+            $COMPOSE --profile "$profile" stop "$broker-publisher" 2>/dev/null || true
+            break
+        fi
+        sleep 1
+    done
+    # Give the subscribers their END grace period before tearing down
+    sleep 5
+
+    $COMPOSE --profile "$profile" run --rm --no-deps "$broker-publisher" \
+        ./aggregator "/data/$BATCH_ID" all --csv "/data/$BATCH_ID/merged" \
+        | sed -n '/🔀 Batch/,$p' || echo "⚠️  Aggregator failed for $BATCH_ID"
+
+    $COMPOSE --profile "$profile" down -v > /dev/null 2>&1 || true
+    echo ""
+}
+
+for broker in $FAULT_BROKERS; do
+    run_broker "$broker"
+done
+
+echo "✅ Fault test $RUN_ID complete; batches are in $DATA_DIR/${RUN_ID}_*"
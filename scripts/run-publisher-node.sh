@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Join a running benchmark batch with publisher processes on this machine.
+# Start it on every extra publisher node while run-docker-benchmark.sh runs
+# on the main node with the same BATCH_ID and PUBLISHER_PROCESSES:
+#
+#   BATCH_ID=<batch> PUBLISHER_PROCESSES=3 LOCAL_PUBLISHER_PROCESSES=1 \
+#     ./scripts/run-publisher-node.sh redis <broker-host>
+#
+# The processes find each other and the leader on the control channel, so
+# only the broker has to be reachable. Results land in this node's
+# bench-data/<batch>; copy them to the main node's before merging.
+
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+
+BROKER_TYPE=${1:-redis}
+BROKER_HOST=${2:?usage: run-publisher-node.sh <redis|redis-streams|redis-cluster|nats|jetstream> <broker-host>}
+
+if [ -f "$PROJECT_DIR/.env" ]; then
+    export $(grep -v '^#' "$PROJECT_DIR/.env" | xargs)
+fi
+
+if [ -z "$BATCH_ID" ]; then
+    echo "❌ Error: BATCH_ID must match the batch of the main node"
+    exit 1
+fi
+PUBLISHER_PROCESSES=${PUBLISHER_PROCESSES:-1}
+LOCAL_PUBLISHER_PROCESSES=${LOCAL_PUBLISHER_PROCESSES:-1}
+NODE_NAME=${NODE_NAME:-$(hostname)}
+export BATCH_ID PUBLISHER_PROCESSES NODE_NAME
+
+case "$BROKER_TYPE" in
+    redis|redis-streams|redis-cluster) BROKER_ENV=(-e REDIS_HOST="$BROKER_HOST" -e REDIS_PORT="${REDIS_PORT:-6379}") ;;
+    nats|jetstream)      BROKER_ENV=(-e NATS_URL="nats://$BROKER_HOST:4222") ;;
+    *) echo "❌ Unknown broker type: $BROKER_TYPE"; exit 1 ;;
+esac
+
+mkdir -p "$PROJECT_DIR/bench-data"
+
+echo "🚀 Node $NODE_NAME: $LOCAL_PUBLISHER_PROCESSES of $PUBLISHER_PROCESSES $BROKER_TYPE publisher process(es), batch $BATCH_ID"
+pids=()
+for i in $(seq 1 "$LOCAL_PUBLISHER_PROCESSES"); do
+    docker-compose -f "$PROJECT_DIR/docker/docker-compose.yml" --profile "$BROKER_TYPE-bench" run --rm --no-deps \
+        "${BROKER_ENV[@]}" "$BROKER_TYPE-publisher" > /dev/null 2>&1 &
+    pids+=($!)
+done
+for pid in "${pids[@]}"; do
+    wait "$pid" || echo "⚠️  A publisher process exited with an error"
+done
+echo "✅ Done; results are in $PROJECT_DIR/bench-data/$BATCH_ID"
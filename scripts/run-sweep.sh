@@ -0,0 +1,179 @@
+#!/bin/bash
+
+# Parameter sweep: runs every point of
+#   SWEEP_BROKERS × SWEEP_SUBSCRIBERS × SWEEP_PUBLISHERS × SWEEP_PAYLOAD_SIZES × SWEEP_RATES
+# as its own batch (<sweep>_<broker>_s<subs>_p<pubs>_b<bytes>_r<rate>) with the
+# usual readiness handshake, merges it with the aggregator and appends it to
+# one DuckDB store, bench-data/sweeps.duckdb, keyed by sweep, batch and
+# parameters. At the end it prints throughput and latency curves per
+# parameter and exports them with the whole store as Parquet.
+#
+# The broker and the subscriber fleet stay up between points: subscribers
+# run with SUBSCRIBER_PERSISTENT=1 and pick up each point's batch id from
+# its START marker, so only the publisher is started per point, and the
+# fleet is only rescaled when the subscriber count changes.
+#
+#   SWEEP_BROKERS="redis nats" SWEEP_PUBLISHERS="1 2 4" SWEEP_SUBSCRIBERS="1 4" \
+#   SWEEP_PAYLOAD_SIZES="64 1024" SWEEP_RATES="0" ./scripts/run-sweep.sh
+#
+# A rate of 0 is closed loop (as fast as possible).
+
+set -e
+
+SCRIPT_DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+COMPOSE="docker-compose -f $PROJECT_DIR/docker/docker-compose.yml"
+
+if [ -f "$PROJECT_DIR/.env" ]; then
+    export $(grep -v '^#' "$PROJECT_DIR/.env" | xargs)
+else
+    echo "❌ Error: .env file not found"
+    exit 1
+fi
+
+SWEEP_BROKERS=${SWEEP_BROKERS:-"redis nats"}
+SWEEP_PUBLISHERS=${SWEEP_PUBLISHERS:-"1 2 4"}
+SWEEP_SUBSCRIBERS=${SWEEP_SUBSCRIBERS:-"1 3"}
+SWEEP_PAYLOAD_SIZES=${SWEEP_PAYLOAD_SIZES:-"64 1024"}
+SWEEP_RATES=${SWEEP_RATES:-"0"}
+SWEEP_ID=${SWEEP_ID:-sweep_$(date +%Y-%m-%d_%H-%M-%S)}
+PUBLISH_DURATION_SECONDS=${PUBLISH_DURATION_SECONDS:-10}
+READY_TIMEOUT_SECONDS=${READY_TIMEOUT_SECONDS:-60}
+export PUBLISH_DURATION_SECONDS READY_TIMEOUT_SECONDS
+# Subscribers outlive the points; their own BATCH_ID only names the fleet
+export SUBSCRIBER_PERSISTENT=1
+export BATCH_ID=$SWEEP_ID
+
+DATA_DIR="$PROJECT_DIR/bench-data"
+STORE=sweeps.duckdb
+mkdir -p "$DATA_DIR"
+
+if ! docker info > /dev/null 2>&1; then
+    echo "❌ Error: Docker is not running. Please start Docker first."
+    exit 1
+fi
+
+duckdb_store() {
+    docker run --rm -v "$DATA_DIR":/data duckdb/duckdb:latest duckdb "/data/$STORE" -c "$1"
+}
+
+broker_server() {
+    case "$1" in
+        redis|redis-streams) echo redis ;;
+        nats|jetstream)      echo nats ;;
+        *) echo "❌ Unknown broker type: $1" >&2; exit 1 ;;
+    esac
+}
+
+# Merge one point and append it to the store with its parameters
+store_point() {
+    local broker=$1 batch=$2 subs=$3 pubs=$4 bytes=$5 rate=$6
+    $COMPOSE --profile "$broker-bench" run --rm --no-deps "$broker-publisher" \
+        ./aggregator "/data/$batch" "$broker" --csv "/data/$batch/merged" > /dev/null \
+        || { echo "⚠️  Aggregator failed for $batch"; return; }
+
+    local params="'$SWEEP_ID' AS sweep_id, '$batch' AS point_batch, '$broker' AS broker, $subs AS subscribers,
+                  $pubs AS publishers, $bytes AS payload_size, $rate AS target_rate"
+    duckdb_store "
+        CREATE TABLE IF NOT EXISTS sweep_points AS
+            SELECT $params, * FROM read_csv('/data/$batch/merged/batch.csv', header = true) LIMIT 0;
+        CREATE TABLE IF NOT EXISTS sweep_subscribers AS
+            SELECT $params, * FROM read_csv('/data/$batch/merged/subscribers.csv', header = true) LIMIT 0;
+        CREATE TABLE IF NOT EXISTS sweep_publishers AS
+            SELECT $params, * FROM read_csv('/data/$batch/merged/publishers.csv', header = true) LIMIT 0;
+        DELETE FROM sweep_points WHERE point_batch = '$batch';
+        DELETE FROM sweep_subscribers WHERE point_batch = '$batch';
+        DELETE FROM sweep_publishers WHERE point_batch = '$batch';
+        INSERT INTO sweep_points BY NAME
+            SELECT $params, * FROM read_csv('/data/$batch/merged/batch.csv', header = true);
+        INSERT INTO sweep_subscribers BY NAME
+            SELECT $params, * FROM read_csv('/data/$batch/merged/subscribers.csv', header = true);
+        INSERT INTO sweep_publishers BY NAME
+            SELECT $params, * FROM read_csv('/data/$batch/merged/publishers.csv', header = true);" > /dev/null \
+        || echo "⚠️  Could not store $batch in $STORE"
+}
+
+run_point() {
+    local broker=$1 subs=$2 pubs=$3 bytes=$4 rate=$5
+    local batch="${SWEEP_ID}_${broker}_s${subs}_p${pubs}_b${bytes}_r${rate}"
+    echo "▶️  $broker: $subs subscriber(s), $pubs publisher thread(s), ${bytes}B, rate $rate — $batch"
+
+    # The publisher is the only container started per point
+    $COMPOSE --profile "$broker-bench" run --rm --no-deps \
+        -e BATCH_ID="$batch" -e NUM_SUBSCRIBERS="$subs" -e NUM_PUBLISHERS="$pubs" \
+        -e PAYLOAD_DISTRIBUTION=fixed -e PAYLOAD_SIZE="$bytes" -e PUBLISH_RATE="$rate" -e PUBLISH_RATE_RAMP= \
+        "$broker-publisher" 2>/dev/null | grep -E "Publish Throughput|Messages Published" || true
+    # Subscribers write once every END is in, within their 2s grace period
+    sleep 3
+    store_point "$broker" "$batch" "$subs" "$pubs" "$bytes" "$rate"
+}
+
+echo "🧪 Sweep $SWEEP_ID"
+echo "  Brokers:       $SWEEP_BROKERS"
+echo "  Subscribers:   $SWEEP_SUBSCRIBERS"
+echo "  Publishers:    $SWEEP_PUBLISHERS"
+echo "  Payload sizes: $SWEEP_PAYLOAD_SIZES"
+echo "  Rates:         $SWEEP_RATES"
+echo ""
+
+for broker in $SWEEP_BROKERS; do
+    server=$(broker_server "$broker")
+    echo "🔌 $broker"
+    echo "─────────────────────────────────────────────"
+    $COMPOSE --profile "$broker-bench" up -d "$server" > /dev/null 2>&1
+
+    # Subscribers outermost: the fleet changes size once per subscriber count
+    for subs in $SWEEP_SUBSCRIBERS; do
+        $COMPOSE --profile "$broker-bench" up -d --no-recreate --scale "$broker-subscriber=$subs" \
+            "$broker-subscriber" > /dev/null 2>&1
+        for pubs in $SWEEP_PUBLISHERS; do
+            for bytes in $SWEEP_PAYLOAD_SIZES; do
+                for rate in $SWEEP_RATES; do
+                    run_point "$broker" "$subs" "$pubs" "$bytes" "$rate"
+                done
+            done
+        done
+    done
+
+    $COMPOSE --profile "$broker-bench" rm -sf "$broker-subscriber" > /dev/null 2>&1 || true
+    echo ""
+done
+
+$COMPOSE --profile redis-bench --profile redis-streams-bench --profile nats-bench --profile jetstream-bench \
+    down > /dev/null 2>&1 || true
+
+# Each parameter's curve, averaged over the other swept parameters
+echo "📈 Curves for $SWEEP_ID"
+echo "─────────────────────────────────────────────"
+duckdb_store "
+    CREATE OR REPLACE VIEW sweep_point_latency AS
+        SELECT point_batch, MAX(latency_p99_us) AS worst_p99_us, SUM(dropped_messages) AS drops
+        FROM sweep_subscribers GROUP BY point_batch;
+    CREATE OR REPLACE TABLE sweep_curves AS
+        WITH points AS (
+            SELECT p.*, l.worst_p99_us, l.drops
+            FROM sweep_points p LEFT JOIN sweep_point_latency l USING (point_batch)
+        ), curves AS (
+            SELECT 'publishers' AS parameter, publishers AS value, * FROM points
+            UNION ALL SELECT 'subscribers', subscribers, * FROM points
+            UNION ALL SELECT 'payload_size', payload_size, * FROM points
+            UNION ALL SELECT 'target_rate', target_rate, * FROM points
+        )
+        SELECT sweep_id, broker, parameter, value, COUNT(*) AS points,
+               AVG(send_rate_msg_per_sec) AS send_rate, AVG(receive_rate_msg_per_sec) AS receive_rate,
+               AVG(worst_p99_us) AS p99_us, MAX(worst_p99_us) AS max_p99_us, SUM(drops) AS drops
+        FROM curves GROUP BY sweep_id, broker, parameter, value;
+    SELECT broker AS \"Broker\", parameter AS \"Parameter\", value AS \"Value\", points AS \"Points\",
+           format('{:,.0f}', send_rate) AS \"Send (msg/s)\", format('{:,.0f}', receive_rate) AS \"Receive (msg/s)\",
+           format('{:,.1f}', p99_us) AS \"Avg p99 (us)\", format('{:,.1f}', max_p99_us) AS \"Max p99 (us)\",
+           drops AS \"Drops\"
+    FROM sweep_curves WHERE sweep_id = '$SWEEP_ID'
+    ORDER BY broker, parameter, value;
+    COPY (SELECT * FROM sweep_curves WHERE sweep_id = '$SWEEP_ID') TO '/data/${SWEEP_ID}_curves.csv' (HEADER);
+    COPY sweep_points TO '/data/sweep_points.parquet' (FORMAT parquet);
+    COPY sweep_subscribers TO '/data/sweep_subscribers.parquet' (FORMAT parquet);
+    COPY sweep_publishers TO '/data/sweep_publishers.parquet' (FORMAT parquet);" \
+    2>&1 | grep -v "varchar\|int64\|BIGINT\|DOUBLE"
+
+echo ""
+echo "✅ Sweep $SWEEP_ID complete: $DATA_DIR/$STORE, ${SWEEP_ID}_curves.csv and sweep_*.parquet"
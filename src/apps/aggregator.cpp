@@ -4,91 +4,739 @@
 #include <string>
 #include <filesystem>
 #include <iomanip>
-#include <regex>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include "latency_histogram.h"
+#include "json_reader.h"
 
 namespace fs = std::filesystem;
 
+// A result file's "memory" object; allocation figures cover the run
+struct MemoryResult {
+    uint64_t peak_rss_bytes = 0;
+    uint64_t heap_in_use_bytes = 0;
+    bool allocations_counted = false;  // built with FANOUT_ALLOC_STATS
+    double allocs_per_message = 0;
+    double alloc_bytes_per_message = 0;
+};
+
+// One entry of a result file's "outages": a thread's connection lost and
+// recovered, in wall-clock ms (0: did not happen)
+struct OutageResult {
+    uint64_t thread = 0;
+    uint64_t down_ms = 0;
+    uint64_t up_ms = 0;
+    uint64_t first_message_ms = 0;
+    uint64_t lost_messages = 0;
+};
+
 struct SubscriberResult {
+    std::string batch_id;
+    std::string broker_type;
     std::string subscriber_id;
-    uint64_t messages_received;
-    uint64_t duration_us;
-    double throughput_msg_per_sec;
+    std::string host;
+    std::string node;  // NODE_NAME, defaults to host
+    uint64_t messages_received = 0;
+    uint64_t bytes_received = 0;
+    uint64_t duration_us = 0;
+    double throughput_msg_per_sec = 0;
+    double throughput_bytes_per_sec = 0;
+    uint64_t lost = 0;
+    uint64_t duplicates = 0;
+    uint64_t out_of_order = 0;
+    uint64_t longest_gap = 0;
+    uint64_t dropped_messages = 0;
+    uint64_t disconnects = 0;
+    uint64_t reconnects = 0;
+    std::vector<OutageResult> outages;
+    uint64_t queue_drops = 0;          // CONSUMER_HANDOFF ring overflow
+    uint64_t queue_high_water = 0;
+    uint64_t logical_subscribers = 0;  // multiplexed mode; received_* describe their spread
+    uint64_t received_min = 0;
+    uint64_t received_median = 0;
+    uint64_t received_max = 0;
+    int sample_interval_ms = 0;
+    std::vector<std::vector<uint64_t>> samples;  // [t_ms, messages, bytes, dropped, ...] per interval
+    int rss_column = -1;                         // optional sample columns, -1 if absent
+    int allocs_column = -1;
+    int alloc_bytes_column = -1;
+    std::unique_ptr<LatencyHistogram> latency;   // rebuilt from the serialized buckets
+    MemoryResult memory;
+};
+
+// One broker node's load over the publish window (publisher "broker_nodes")
+struct BrokerNodeLoad {
+    std::string node;
+    bool ok = false;
+    double cpu_seconds = 0;
+    double cpu_percent = 0;
+    double out_bytes_per_sec = 0;
+    double out_msgs_per_sec = -1;  // -1: not reported (Redis)
 };
 
-// Simple JSON value extractor
-std::string extractJsonValue(const std::string& json, const std::string& key) {
-    std::regex pattern("\"" + key + "\"\\s*:\\s*([^,}]+)");
-    std::smatch match;
-    if (std::regex_search(json, match, pattern)) {
-        std::string value = match[1];
-        // Remove quotes if present
-        if (value.front() == '"') value = value.substr(1);
-        if (value.back() == '"') value = value.substr(0, value.length() - 1);
-        return value;
+struct PublisherResult {
+    std::string batch_id;
+    std::string broker_type;
+    std::string host;
+    std::string node;
+    std::string publish_mode;
+    uint64_t publish_batch_size = 1;
+    uint64_t num_publishers = 0;
+    uint64_t num_subscribers = 0;
+    uint64_t publisher_processes = 1;
+    uint64_t publish_duration_seconds = 0;
+    uint64_t messages_published = 0;
+    uint64_t messages_steady = 0;  // inside the measurement window, like messages_received
+    uint64_t bytes_published = 0;
+    double throughput_msg_per_sec = 0;
+    double throughput_bytes_per_sec = 0;
+    std::vector<BrokerNodeLoad> broker_nodes;  // leader only
+    MemoryResult memory;
+};
+
+// Outcome of parsing one results file; at most one of sub/pub is set
+struct ParsedFile {
+    fs::path path;
+    std::string error;
+    std::unique_ptr<SubscriberResult> sub;
+    std::unique_ptr<PublisherResult> pub;
+};
+
+bool readFile(const fs::path& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    contents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    return static_cast<bool>(file.read(contents.data(), static_cast<std::streamsize>(contents.size())));
+}
+
+// Rows of a numeric array-of-arrays ([[1,2,3],[4,5,6]])
+std::vector<std::vector<uint64_t>> numberRows(const JsonDocument& doc, uint32_t array) {
+    std::vector<std::vector<uint64_t>> rows;
+    for (uint32_t row = doc.firstChild(array); row != JsonDocument::NONE; row = doc.next(row)) {
+        auto& values = rows.emplace_back();
+        for (uint32_t v = doc.firstChild(row); v != JsonDocument::NONE; v = doc.next(v)) {
+            values.push_back(doc.u64(v));
+        }
     }
-    return "";
+    return rows;
 }
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: aggregator <results_directory> [<broker_type>]" << std::endl;
-        std::cerr << "Example: aggregator /app/results redis" << std::endl;
-        return 1;
+// Index of a named column in a "columns" array, -1 if absent
+int columnIndex(const JsonDocument& doc, uint32_t columns, const std::string& name) {
+    int index = 0;
+    for (uint32_t c = doc.firstChild(columns); c != JsonDocument::NONE; c = doc.next(c), index++) {
+        if (doc.str(c) == name) return index;
     }
+    return -1;
+}
 
-    std::string resultsDir = argv[1];
-    std::string brokerType = argc > 2 ? argv[2] : "unknown";
+MemoryResult parseMemory(const JsonDocument& doc, uint32_t memory) {
+    MemoryResult result;
+    result.peak_rss_bytes = doc.u64(doc.get(memory, "peak_rss_bytes"));
+    result.heap_in_use_bytes = doc.u64(doc.get(memory, "heap_in_use_bytes"));
+    uint32_t allocations = doc.get(memory, "allocations");
+    result.allocations_counted = doc.str(doc.get(allocations, "enabled")) == "true";
+    result.allocs_per_message = doc.number(doc.get(allocations, "per_message"));
+    result.alloc_bytes_per_message = doc.number(doc.get(allocations, "bytes_per_message"));
+    return result;
+}
 
-    // Check if directory exists
-    if (!fs::exists(resultsDir)) {
-        std::cerr << "❌ Results directory not found: " << resultsDir << std::endl;
-        return 1;
+// Empty for files written without allocation counting
+std::string allocationFields(const MemoryResult& memory) {
+    if (!memory.allocations_counted) return ",";
+    std::ostringstream fields;
+    fields << std::fixed << std::setprecision(4) << memory.allocs_per_message << ','
+           << std::setprecision(2) << memory.alloc_bytes_per_message;
+    return fields.str();
+}
+
+void parseResultFile(ParsedFile& parsed) {
+    std::string json;
+    if (!readFile(parsed.path, json)) {
+        parsed.error = "could not read file";
+        return;
+    }
+    JsonDocument doc;
+    if (!doc.parse(json)) {
+        parsed.error = "malformed JSON at byte " + std::to_string(doc.error());
+        return;
     }
 
-    std::vector<SubscriberResult> results;
+    if (doc.str("role") == "publisher") {
+        auto pub = std::make_unique<PublisherResult>();
+        pub->batch_id = doc.str("batch_id");
+        pub->broker_type = doc.str("broker_type");
+        pub->host = doc.str("host");
+        pub->node = doc.str("node");
+        if (pub->node.empty()) pub->node = pub->host;
+        pub->publish_mode = doc.str("config.publish_mode");
+        pub->publish_batch_size = doc.u64("config.publish_batch_size", 1);
+        pub->num_publishers = doc.u64("config.num_publishers");
+        pub->num_subscribers = doc.u64("config.num_subscribers");
+        pub->publisher_processes = doc.u64("config.publisher_processes", 1);
+        pub->publish_duration_seconds = doc.u64("config.publish_duration_seconds");
+        pub->messages_published = doc.u64("results.messages_published");
+        pub->messages_steady = doc.u64("results.phases.steady.messages_published", pub->messages_published);
+        pub->bytes_published = doc.u64("results.bytes_published");
+        pub->throughput_msg_per_sec = doc.number("results.throughput_msg_per_sec");
+        pub->throughput_bytes_per_sec = doc.number("results.throughput_bytes_per_sec");
+        uint32_t nodes = doc.at("results.broker_nodes");
+        for (uint32_t n = doc.firstChild(nodes); n != JsonDocument::NONE; n = doc.next(n)) {
+            BrokerNodeLoad& load = pub->broker_nodes.emplace_back();
+            load.node = doc.str(doc.get(n, "node"));
+            load.ok = doc.str(doc.get(n, "ok")) == "true";
+            load.cpu_seconds = doc.number(doc.get(n, "cpu_seconds"));
+            load.cpu_percent = doc.number(doc.get(n, "cpu_percent"));
+            load.out_bytes_per_sec = doc.number(doc.get(n, "out_bytes_per_sec"));
+            load.out_msgs_per_sec = doc.number(doc.get(n, "out_msgs_per_sec"), -1);
+        }
+        pub->memory = parseMemory(doc, doc.at("results.memory"));
+        parsed.pub = std::move(pub);
+        return;
+    }
 
-    // Read all JSON files from the results directory
-    std::cout << "📂 Reading results from: " << resultsDir << std::endl;
-    for (const auto& entry : fs::directory_iterator(resultsDir)) {
-        if (entry.is_regular_file() && entry.path().extension() == ".json") {
-            std::ifstream file(entry.path());
-            if (file.is_open()) {
-                try {
-                    std::string json((std::istreambuf_iterator<char>(file)),
-                                    std::istreambuf_iterator<char>());
-
-                    SubscriberResult result;
-                    result.subscriber_id = extractJsonValue(json, "subscriber_id");
-                    result.messages_received = std::stoull(extractJsonValue(json, "messages_received"));
-                    result.duration_us = std::stoull(extractJsonValue(json, "duration_us"));
-                    result.throughput_msg_per_sec = std::stod(extractJsonValue(json, "throughput_msg_per_sec"));
-
-                    if (!result.subscriber_id.empty() && result.messages_received > 0) {
-                        results.push_back(result);
-                        std::cout << "  ✓ " << entry.path().filename() << std::endl;
-                    }
-                } catch (const std::exception& e) {
-                    std::cerr << "  ⚠️  Error parsing " << entry.path().filename() << ": " << e.what() << std::endl;
-                }
-                file.close();
+    auto sub = std::make_unique<SubscriberResult>();
+    sub->subscriber_id = doc.str("subscriber_id");
+    sub->messages_received = doc.u64("messages_received");
+    if (sub->subscriber_id.empty() || sub->messages_received == 0) return;
+
+    sub->batch_id = doc.str("batch_id");
+    sub->broker_type = doc.str("broker_type");
+    sub->host = doc.str("host");
+    sub->node = doc.str("node");
+    if (sub->node.empty()) sub->node = sub->host;
+    sub->bytes_received = doc.u64("bytes_received");
+    sub->duration_us = doc.u64("duration_us");
+    sub->throughput_msg_per_sec = doc.number("throughput_msg_per_sec");
+    sub->throughput_bytes_per_sec = doc.number("throughput_bytes_per_sec");
+    // Older files wrote the sequence counters at the top level
+    uint32_t sequence = doc.at("sequence");
+    if (sequence == JsonDocument::NONE) sequence = doc.root();
+    sub->lost = doc.u64(doc.get(sequence, "lost"));
+    sub->duplicates = doc.u64(doc.get(sequence, "duplicates"));
+    sub->out_of_order = doc.u64(doc.get(sequence, "out_of_order"));
+    sub->longest_gap = doc.u64(doc.get(sequence, "longest_gap"));
+    sub->dropped_messages = doc.u64("dropped_messages");
+    sub->disconnects = doc.u64("disconnects");
+    sub->reconnects = doc.u64("reconnects");
+    uint32_t outages = doc.at("outages");
+    for (uint32_t o = doc.firstChild(outages); o != JsonDocument::NONE; o = doc.next(o)) {
+        OutageResult& outage = sub->outages.emplace_back();
+        outage.thread = doc.u64(doc.get(o, "thread"));
+        outage.down_ms = doc.u64(doc.get(o, "down_ms"));
+        outage.up_ms = doc.u64(doc.get(o, "up_ms"));
+        outage.first_message_ms = doc.u64(doc.get(o, "first_message_ms"));
+        outage.lost_messages = doc.u64(doc.get(o, "lost_messages"));
+    }
+    sub->queue_drops = doc.u64("consumer.queue_drops");
+    sub->queue_high_water = doc.u64("consumer.queue_high_water");
+    sub->logical_subscribers = doc.u64("fanout.logical_subscribers");
+    sub->received_min = doc.u64("fanout.received_min");
+    sub->received_median = doc.u64("fanout.received_median");
+    sub->received_max = doc.u64("fanout.received_max");
+    sub->sample_interval_ms = static_cast<int>(doc.u64("timeseries.interval_ms"));
+    sub->samples = numberRows(doc, doc.at("timeseries.samples"));
+    uint32_t columns = doc.at("timeseries.columns");
+    sub->rss_column = columnIndex(doc, columns, "rss_bytes");
+    sub->allocs_column = columnIndex(doc, columns, "allocs");
+    sub->alloc_bytes_column = columnIndex(doc, columns, "alloc_bytes");
+    sub->memory = parseMemory(doc, doc.at("memory"));
+
+    // Serialized as [[index, count], ...]
+    sub->latency = std::make_unique<LatencyHistogram>();
+    uint32_t buckets = doc.at("latency_histogram.buckets");
+    for (uint32_t b = doc.firstChild(buckets); b != JsonDocument::NONE; b = doc.next(b)) {
+        uint32_t index = doc.firstChild(b);
+        if (index == JsonDocument::NONE || doc.next(index) == JsonDocument::NONE) continue;
+        sub->latency->addToBucket(static_cast<size_t>(doc.u64(index)), doc.u64(doc.next(index)));
+    }
+    parsed.sub = std::move(sub);
+}
+
+// Parse every file on a small pool of threads; results keep the input order
+std::vector<ParsedFile> parseResultFiles(const std::vector<fs::path>& paths, unsigned numThreads) {
+    std::vector<ParsedFile> parsed(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        parsed[i].path = paths[i];
+    }
+
+    std::atomic<size_t> nextFile{0};
+    auto worker = [&] {
+        for (size_t i = nextFile.fetch_add(1); i < parsed.size(); i = nextFile.fetch_add(1)) {
+            parseResultFile(parsed[i]);
+        }
+    };
+    numThreads = std::max(1u, std::min<unsigned>(numThreads, static_cast<unsigned>(paths.size())));
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < numThreads; t++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : workers) {
+        t.join();
+    }
+    return parsed;
+}
+
+// Quote a CSV field when it needs it
+std::string csvField(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) return value;
+    std::string quoted = "\"";
+    for (char c : value) {
+        quoted += c;
+        if (c == '"') quoted += '"';
+    }
+    return quoted + "\"";
+}
+
+// Publishers and subscribers of one batch and broker, merged
+struct BatchReport {
+    struct Node {
+        uint64_t publisher_processes = 0;
+        uint64_t sent = 0;
+        double send_rate = 0;
+        uint64_t subscriber_instances = 0;
+        uint64_t delivered = 0;
+        double receive_rate = 0;
+    };
+
+    std::string batch_id;
+    std::string broker_type;
+    uint64_t publisher_processes = 0;
+    uint64_t expected_publisher_processes = 0;  // PUBLISHER_PROCESSES as configured
+    uint64_t sent = 0;                          // steady state, summed over publisher processes
+    double send_rate = 0;
+    uint64_t endpoints = 0;                     // subscriber instances, or their logical subscribers
+    uint64_t delivered = 0;
+    double receive_rate = 0;
+    std::map<std::string, Node> nodes;
+    std::vector<BrokerNodeLoad> broker_nodes;   // from the leading publisher
+
+    // Deliveries per message sent: the broker's fan-out work
+    double amplification() const { return sent > 0 ? static_cast<double>(delivered) / sent : 0; }
+    // Against every endpoint receiving every message (all topics subscribed)
+    double deliveryRatio() const {
+        return sent > 0 && endpoints > 0 ? static_cast<double>(delivered) / (sent * endpoints) : 0;
+    }
+};
+
+std::vector<BatchReport> batchReports(const std::vector<const SubscriberResult*>& subscribers,
+                                      const std::vector<const PublisherResult*>& publishers) {
+    std::map<std::pair<std::string, std::string>, BatchReport> reports;
+    auto reportFor = [&](const std::string& batch, const std::string& broker) -> BatchReport& {
+        BatchReport& report = reports[{batch, broker}];
+        report.batch_id = batch;
+        report.broker_type = broker;
+        return report;
+    };
+    for (const auto* p : publishers) {
+        BatchReport& report = reportFor(p->batch_id, p->broker_type);
+        report.publisher_processes++;
+        report.expected_publisher_processes = std::max(report.expected_publisher_processes, p->publisher_processes);
+        report.sent += p->messages_steady;
+        report.send_rate += p->throughput_msg_per_sec;
+        BatchReport::Node& node = report.nodes[p->node];
+        node.publisher_processes++;
+        node.sent += p->messages_steady;
+        node.send_rate += p->throughput_msg_per_sec;
+        if (!p->broker_nodes.empty()) report.broker_nodes = p->broker_nodes;
+    }
+    for (const auto* r : subscribers) {
+        BatchReport& report = reportFor(r->batch_id, r->broker_type);
+        report.endpoints += std::max<uint64_t>(r->logical_subscribers, 1);
+        report.delivered += r->messages_received;
+        report.receive_rate += r->throughput_msg_per_sec;
+        BatchReport::Node& node = report.nodes[r->node];
+        node.subscriber_instances++;
+        node.delivered += r->messages_received;
+        node.receive_rate += r->throughput_msg_per_sec;
+    }
+    std::vector<BatchReport> merged;
+    for (auto& [key, report] : reports) merged.push_back(std::move(report));
+    return merged;
+}
+
+void printBatchReport(const BatchReport& report) {
+    std::cout << "\n🔀 Batch " << report.batch_id << " (publishers + subscribers):" << std::endl;
+    std::cout << "───────────────────────────────────────────────" << std::endl;
+    std::cout << "  Publisher Processes:    " << report.publisher_processes;
+    if (report.expected_publisher_processes > report.publisher_processes) {
+        std::cout << " of " << report.expected_publisher_processes << " ⚠️  results missing";
+    }
+    std::cout << std::endl;
+    std::cout << "  Total Sent:             " << report.sent << " msgs, " << std::fixed << std::setprecision(0)
+              << report.send_rate << " msg/sec" << std::endl;
+    std::cout << "  Subscriber Endpoints:   " << report.endpoints << std::endl;
+    std::cout << "  Total Delivered:        " << report.delivered << " msgs, " << std::fixed << std::setprecision(0)
+              << report.receive_rate << " msg/sec" << std::endl;
+    std::cout << "  Fan-out Amplification:  " << std::setprecision(2) << report.amplification()
+              << "x (" << report.endpoints << "x if every endpoint gets every message)" << std::endl;
+    std::cout << "  Delivery Ratio:         " << std::setprecision(2) << report.deliveryRatio() * 100 << "%" << std::endl;
+
+    std::cout << "\n📍 Per-Node Rates:" << std::endl;
+    std::cout << "───────────────────────────────────────────────" << std::endl;
+    std::cout << "  " << std::setw(20) << std::left << "node" << std::right << std::setw(5) << "pubs"
+              << std::setw(14) << "sent msg/s" << std::setw(6) << "subs" << std::setw(14) << "recv msg/s"
+              << std::endl;
+    for (const auto& [name, node] : report.nodes) {
+        std::cout << "  " << std::setw(20) << std::left << name << std::right
+                  << std::setw(5) << node.publisher_processes << std::setprecision(0)
+                  << std::setw(14) << node.send_rate << std::setw(6) << node.subscriber_instances
+                  << std::setw(14) << node.receive_rate << std::endl;
+    }
+
+    if (!report.broker_nodes.empty()) {
+        // The busiest node caps a cluster long before the average does
+        double totalOut = 0;
+        for (const BrokerNodeLoad& load : report.broker_nodes) totalOut += load.out_bytes_per_sec;
+        std::cout << "\n🖥️  Broker Nodes (" << report.broker_nodes.size() << ", "
+                  << std::setprecision(0) << report.receive_rate << " msg/sec delivered):" << std::endl;
+        std::cout << "───────────────────────────────────────────────" << std::endl;
+        std::cout << "  " << std::setw(24) << std::left << "node" << std::right << std::setw(8) << "cpu %"
+                  << std::setw(10) << "cpu s" << std::setw(12) << "out MiB/s" << std::setw(8) << "share"
+                  << std::setw(14) << "out msg/s" << std::endl;
+        for (const BrokerNodeLoad& load : report.broker_nodes) {
+            std::cout << "  " << std::setw(24) << std::left << load.node << std::right;
+            if (!load.ok) {
+                std::cout << std::setw(8) << "-" << "  no reading" << std::endl;
+                continue;
+            }
+            std::cout << std::setprecision(1) << std::setw(8) << load.cpu_percent
+                      << std::setw(10) << load.cpu_seconds << std::setprecision(2)
+                      << std::setw(12) << load.out_bytes_per_sec / (1024.0 * 1024.0) << std::setprecision(1)
+                      << std::setw(7) << (totalOut > 0 ? load.out_bytes_per_sec / totalOut * 100 : 0) << "%";
+            if (load.out_msgs_per_sec >= 0) {
+                std::cout << std::setprecision(0) << std::setw(14) << load.out_msgs_per_sec;
+            } else {
+                std::cout << std::setw(14) << "-";
             }
+            std::cout << std::endl;
         }
     }
+    std::cout << std::left;
+}
 
-    if (results.empty()) {
-        std::cerr << "❌ No results found in " << resultsDir << std::endl;
-        return 1;
+// fault.json of a batch from scripts/run-fault-test.sh: when the broker
+// container was killed or paused and when it was back, in wall-clock ms
+struct FaultWindow {
+    std::string mode;
+    std::string service;
+    uint64_t start_ms = 0;
+    uint64_t end_ms = 0;
+};
+
+bool readFaultWindow(const fs::path& path, FaultWindow& fault) {
+    std::string json;
+    JsonDocument doc;
+    if (!readFile(path, json) || !doc.parse(json)) return false;
+    fault.mode = doc.str("mode");
+    fault.service = doc.str("service");
+    fault.start_ms = doc.u64("start_ms");
+    fault.end_ms = doc.u64("end_ms");
+    return fault.start_ms > 0 && fault.end_ms >= fault.start_ms;
+}
+
+// How one subscriber instance rode out a broker outage. The outage is the
+// batch's fault window or, without one, the instance's first disconnect to
+// its last reconnect; times are ms after its start.
+//   baseline   mean rate of the intervals before the outage
+//   trough     slowest interval from the outage until recovered
+//   recovered  end of the first interval after the outage back at 90% of
+//              baseline, -1 if the run ended first
+//   shortfall  messages short of baseline over those intervals
+// time to first message comes from the outages the subscriber recorded;
+// a paused broker resets no connection, so then from the time series, to
+// the end of the interval.
+struct RecoveryReport {
+    std::string batch_id;
+    std::string broker_type;
+    std::string subscriber_id;
+    uint64_t start_ms = 0;
+    uint64_t end_ms = 0;
+    size_t outages = 0;
+    double baseline_rate = 0;
+    double trough_rate = 0;
+    int64_t first_message_ms = -1;
+    int64_t recovered_ms = -1;
+    uint64_t shortfall = 0;
+    uint64_t lost = 0;  // sequence loss over the recorded outages
+
+    double dip() const { return baseline_rate > 0 ? 1 - trough_rate / baseline_rate : 0; }
+};
+
+// False if the instance saw no outage and its batch had no fault
+bool recoveryOf(const SubscriberResult& r, const FaultWindow* fault, RecoveryReport& report) {
+    report.batch_id = r.batch_id;
+    report.broker_type = r.broker_type;
+    report.subscriber_id = r.subscriber_id;
+    report.outages = r.outages.size();
+    if (fault != nullptr) {
+        report.start_ms = fault->start_ms;
+        report.end_ms = fault->end_ms;
+    } else if (!r.outages.empty()) {
+        report.start_ms = UINT64_MAX;
+        for (const OutageResult& outage : r.outages) {
+            report.start_ms = std::min(report.start_ms, outage.down_ms);
+            report.end_ms = std::max({report.end_ms, outage.down_ms, outage.up_ms});
+        }
+    } else {
+        return false;
+    }
+
+    bool everyFirstMessage = !r.outages.empty();
+    uint64_t lastFirstMessage = 0;
+    for (const OutageResult& outage : r.outages) {
+        report.lost += outage.lost_messages;
+        everyFirstMessage = everyFirstMessage && outage.first_message_ms != 0;
+        lastFirstMessage = std::max(lastFirstMessage, outage.first_message_ms);
+    }
+    if (everyFirstMessage && lastFirstMessage >= report.start_ms) {
+        report.first_message_ms = static_cast<int64_t>(lastFirstMessage - report.start_ms);
+    }
+    if (r.samples.empty() || r.sample_interval_ms <= 0) return true;
+
+    // Rows are [t_ms, messages, ...] for the interval ending at t_ms; the
+    // first one is partial, so it stays out of the baseline
+    double intervalSeconds = r.sample_interval_ms / 1000.0;
+    double before = 0;
+    size_t beforeIntervals = 0;
+    for (size_t i = 1; i < r.samples.size() && r.samples[i][0] <= report.start_ms; i++) {
+        before += r.samples[i][1];
+        beforeIntervals++;
+    }
+    if (beforeIntervals > 0) report.baseline_rate = before / beforeIntervals / intervalSeconds;
+
+    bool first = true;
+    bool firstFromSamples = report.first_message_ms < 0;
+    for (const auto& row : r.samples) {
+        if (row.size() < 2 || row[0] <= report.start_ms) continue;
+        double rate = row[1] / intervalSeconds;
+        report.trough_rate = first ? rate : std::min(report.trough_rate, rate);
+        first = false;
+        double expected = report.baseline_rate * intervalSeconds;
+        if (expected > row[1]) report.shortfall += static_cast<uint64_t>(expected - row[1]);
+        if (row[0] < report.end_ms) continue;
+        if (firstFromSamples && report.first_message_ms < 0 && row[1] > 0) {
+            report.first_message_ms = static_cast<int64_t>(row[0] - report.start_ms);
+        }
+        if (report.baseline_rate > 0 && rate >= 0.9 * report.baseline_rate) {
+            report.recovered_ms = static_cast<int64_t>(row[0] - report.start_ms);
+            break;
+        }
+    }
+    return true;
+}
+
+std::vector<RecoveryReport> recoveryReports(const std::vector<const SubscriberResult*>& subscribers,
+                                            const FaultWindow* fault) {
+    std::vector<RecoveryReport> reports;
+    for (const auto* r : subscribers) {
+        RecoveryReport report;
+        if (recoveryOf(*r, fault, report)) reports.push_back(std::move(report));
+    }
+    return reports;
+}
+
+// -1 (not measured) as an empty CSV field or a dash
+std::string msField(int64_t ms, const char* missing) {
+    return ms >= 0 ? std::to_string(ms) : missing;
+}
+
+void printRecovery(const std::vector<const SubscriberResult*>& results, const FaultWindow* fault) {
+    std::vector<RecoveryReport> reports = recoveryReports(results, fault);
+    if (reports.empty()) return;
+
+    std::cout << "\n🩹 Recovery ";
+    if (fault != nullptr) {
+        std::cout << "(" << fault->mode << " " << fault->service << ", back after "
+                  << fault->end_ms - fault->start_ms << " ms):" << std::endl;
+    } else {
+        std::cout << "(from the subscribers' disconnects):" << std::endl;
+    }
+    std::cout << "───────────────────────────────────────────────" << std::endl;
+    std::cout << "  " << std::setw(25) << std::left << "instance" << std::right << std::setw(8) << "outages"
+              << std::setw(12) << "base msg/s" << std::setw(8) << "dip" << std::setw(12) << "first ms"
+              << std::setw(12) << "90% ms" << std::setw(10) << "lost" << std::setw(12) << "shortfall"
+              << std::endl;
+    for (const RecoveryReport& report : reports) {
+        std::cout << "  " << std::setw(25) << std::left << report.subscriber_id << std::right
+                  << std::setw(8) << report.outages << std::fixed << std::setprecision(0)
+                  << std::setw(12) << report.baseline_rate << std::setw(7) << report.dip() * 100 << "%"
+                  << std::setw(12) << msField(report.first_message_ms, "-")
+                  << std::setw(12) << msField(report.recovered_ms, "-")
+                  << std::setw(10) << (report.outages > 0 ? std::to_string(report.lost) : "-")
+                  << std::setw(12) << report.shortfall << std::endl;
+    }
+    std::cout << std::left;
+}
+
+// Merged columnar output: one row per instance, plus the flattened time series
+bool writeCsv(const fs::path& outputDir, const std::vector<const SubscriberResult*>& subscribers,
+              const std::vector<const PublisherResult*>& publishers, const FaultWindow* fault) {
+    std::error_code ec;
+    fs::create_directories(outputDir, ec);
+
+    std::ofstream subs(outputDir / "subscribers.csv");
+    std::ofstream series(outputDir / "timeseries.csv");
+    std::ofstream pubs(outputDir / "publishers.csv");
+    if (!subs.is_open() || !series.is_open() || !pubs.is_open()) {
+        std::cerr << "❌ Could not write CSV files to " << outputDir << std::endl;
+        return false;
+    }
+
+    subs << "batch_id,broker_type,subscriber_id,host,messages_received,bytes_received,duration_us,"
+            "throughput_msg_per_sec,throughput_bytes_per_sec,latency_p50_us,latency_p90_us,latency_p99_us,"
+            "latency_p999_us,latency_max_us,lost,duplicates,out_of_order,longest_gap,dropped_messages,"
+            "logical_subscribers,received_min,received_median,received_max,node,peak_rss_bytes,heap_in_use_bytes,"
+            "allocs_per_message,alloc_bytes_per_message,disconnects,queue_drops,queue_high_water,reconnects\n";
+    subs << std::fixed;
+    for (const auto* r : subscribers) {
+        const LatencyHistogram& h = *r->latency;
+        subs << csvField(r->batch_id) << ',' << csvField(r->broker_type) << ',' << csvField(r->subscriber_id)
+             << ',' << csvField(r->host) << ',' << r->messages_received << ',' << r->bytes_received
+             << ',' << r->duration_us << std::setprecision(2) << ',' << r->throughput_msg_per_sec
+             << ',' << r->throughput_bytes_per_sec << std::setprecision(1)
+             << ',' << h.percentile(50.0) / 1000.0 << ',' << h.percentile(90.0) / 1000.0
+             << ',' << h.percentile(99.0) / 1000.0 << ',' << h.percentile(99.9) / 1000.0
+             << ',' << h.max() / 1000.0 << ',' << r->lost << ',' << r->duplicates
+             << ',' << r->out_of_order << ',' << r->longest_gap << ',' << r->dropped_messages
+             << ',' << r->logical_subscribers << ',' << r->received_min << ',' << r->received_median
+             << ',' << r->received_max << ',' << csvField(r->node) << ',' << r->memory.peak_rss_bytes
+             << ',' << r->memory.heap_in_use_bytes << ',' << allocationFields(r->memory)
+             << ',' << r->disconnects << ',' << r->queue_drops << ',' << r->queue_high_water
+             << ',' << r->reconnects << '\n';
+    }
+
+    series << "batch_id,broker_type,subscriber_id,interval_ms,t_ms,messages,bytes,dropped,rss_bytes,allocs,alloc_bytes\n";
+    for (const auto* r : subscribers) {
+        std::string prefix = csvField(r->batch_id) + ',' + csvField(r->broker_type) + ',' +
+                             csvField(r->subscriber_id) + ',' + std::to_string(r->sample_interval_ms);
+        auto optional = [](const std::vector<uint64_t>& row, int column) {
+            return column >= 0 && static_cast<size_t>(column) < row.size() ? std::to_string(row[column]) : "";
+        };
+        for (const auto& row : r->samples) {
+            if (row.size() < 4) continue;
+            series << prefix << ',' << row[0] << ',' << row[1] << ',' << row[2] << ',' << row[3]
+                   << ',' << optional(row, r->rss_column) << ',' << optional(row, r->allocs_column)
+                   << ',' << optional(row, r->alloc_bytes_column) << '\n';
+        }
+    }
+
+    pubs << "batch_id,broker_type,host,publish_mode,publish_batch_size,num_publishers,num_subscribers,"
+            "publish_duration_seconds,messages_published,bytes_published,throughput_msg_per_sec,"
+            "throughput_bytes_per_sec,node,publisher_processes,messages_steady,peak_rss_bytes,heap_in_use_bytes,"
+            "allocs_per_message,alloc_bytes_per_message\n";
+    pubs << std::fixed << std::setprecision(2);
+    for (const auto* p : publishers) {
+        pubs << csvField(p->batch_id) << ',' << csvField(p->broker_type) << ',' << csvField(p->host)
+             << ',' << csvField(p->publish_mode) << ',' << p->publish_batch_size << ',' << p->num_publishers
+             << ',' << p->num_subscribers << ',' << p->publish_duration_seconds << ',' << p->messages_published
+             << ',' << p->bytes_published << ',' << p->throughput_msg_per_sec
+             << ',' << p->throughput_bytes_per_sec << ',' << csvField(p->node)
+             << ',' << p->publisher_processes << ',' << p->messages_steady << ',' << p->memory.peak_rss_bytes
+             << ',' << p->memory.heap_in_use_bytes << ',' << allocationFields(p->memory) << '\n';
+    }
+
+    std::ofstream batch(outputDir / "batch.csv");
+    batch << "batch_id,broker_type,publisher_processes,expected_publisher_processes,messages_sent,"
+             "send_rate_msg_per_sec,subscriber_endpoints,messages_delivered,receive_rate_msg_per_sec,"
+             "amplification,delivery_ratio\n";
+    batch << std::fixed;
+    for (const BatchReport& report : batchReports(subscribers, publishers)) {
+        batch << csvField(report.batch_id) << ',' << csvField(report.broker_type)
+              << ',' << report.publisher_processes << ',' << report.expected_publisher_processes
+              << ',' << report.sent << std::setprecision(2) << ',' << report.send_rate
+              << ',' << report.endpoints << ',' << report.delivered << ',' << report.receive_rate
+              << std::setprecision(4) << ',' << report.amplification() << ',' << report.deliveryRatio() << '\n';
+    }
+
+    std::ofstream brokerNodes(outputDir / "broker_nodes.csv");
+    brokerNodes << "batch_id,broker_type,node,ok,cpu_seconds,cpu_percent,out_bytes_per_sec,out_msgs_per_sec,"
+                   "receive_rate_msg_per_sec\n";
+    brokerNodes << std::fixed;
+    for (const BatchReport& report : batchReports(subscribers, publishers)) {
+        for (const BrokerNodeLoad& load : report.broker_nodes) {
+            brokerNodes << csvField(report.batch_id) << ',' << csvField(report.broker_type)
+                        << ',' << csvField(load.node) << ',' << (load.ok ? "true" : "false")
+                        << std::setprecision(3) << ',' << load.cpu_seconds << std::setprecision(2)
+                        << ',' << load.cpu_percent << ',' << load.out_bytes_per_sec
+                        << ',' << load.out_msgs_per_sec << ',' << report.receive_rate << '\n';
+        }
     }
 
+    std::ofstream outages(outputDir / "outages.csv");
+    outages << "batch_id,broker_type,subscriber_id,thread,down_ms,up_ms,first_message_ms,lost_messages\n";
+    for (const auto* r : subscribers) {
+        for (const OutageResult& outage : r->outages) {
+            outages << csvField(r->batch_id) << ',' << csvField(r->broker_type) << ',' << csvField(r->subscriber_id)
+                    << ',' << outage.thread << ',' << outage.down_ms << ',' << outage.up_ms
+                    << ',' << outage.first_message_ms << ',' << outage.lost_messages << '\n';
+        }
+    }
+
+    std::ofstream recovery(outputDir / "recovery.csv");
+    recovery << "batch_id,broker_type,subscriber_id,fault_mode,start_ms,end_ms,outages,baseline_msg_per_sec,"
+                "trough_msg_per_sec,dip,first_message_after_ms,recovered_after_ms,lost_messages,shortfall\n";
+    recovery << std::fixed;
+    for (const RecoveryReport& report : recoveryReports(subscribers, fault)) {
+        recovery << csvField(report.batch_id) << ',' << csvField(report.broker_type)
+                 << ',' << csvField(report.subscriber_id) << ',' << (fault != nullptr ? csvField(fault->mode) : "")
+                 << ',' << report.start_ms << ',' << report.end_ms << ',' << report.outages
+                 << std::setprecision(2) << ',' << report.baseline_rate << ',' << report.trough_rate
+                 << std::setprecision(4) << ',' << report.dip()
+                 << ',' << msField(report.first_message_ms, "") << ',' << msField(report.recovered_ms, "")
+                 << ',' << (report.outages > 0 ? std::to_string(report.lost) : "") << ',' << report.shortfall
+                 << '\n';
+    }
+
+    std::cout << "🗂️  Wrote subscribers.csv, timeseries.csv, publishers.csv, batch.csv, broker_nodes.csv, "
+                 "outages.csv and recovery.csv to " << outputDir << std::endl;
+    return true;
+}
+
+void printSummary(const std::string& brokerType, const std::vector<const SubscriberResult*>& results) {
     // Calculate aggregated statistics
     uint64_t total_messages = 0;
     uint64_t total_duration_us = 0;
     double total_throughput = 0;
+    uint64_t total_lost = 0;
+    uint64_t total_duplicates = 0;
+    uint64_t total_out_of_order = 0;
+    uint64_t longest_gap = 0;
+    uint64_t total_dropped = 0;
+    uint64_t total_disconnects = 0;
+    uint64_t total_reconnects = 0;
+    uint64_t total_queue_drops = 0;
+    uint64_t logical_subscribers = 0;
+    uint64_t received_min = UINT64_MAX;
+    uint64_t received_max = 0;
+    LatencyHistogram mergedLatency;
 
-    for (const auto& result : results) {
-        total_messages += result.messages_received;
-        total_duration_us += result.duration_us;
-        total_throughput += result.throughput_msg_per_sec;
+    for (const auto* result : results) {
+        total_messages += result->messages_received;
+        total_lost += result->lost;
+        total_duplicates += result->duplicates;
+        total_out_of_order += result->out_of_order;
+        total_dropped += result->dropped_messages;
+        total_disconnects += result->disconnects;
+        total_reconnects += result->reconnects;
+        total_queue_drops += result->queue_drops;
+        longest_gap = std::max(longest_gap, result->longest_gap);
+        total_duration_us += result->duration_us;
+        total_throughput += result->throughput_msg_per_sec;
+        mergedLatency.merge(*result->latency);
+        if (result->logical_subscribers > 0) {
+            logical_subscribers += result->logical_subscribers;
+            received_min = std::min(received_min, result->received_min);
+            received_max = std::max(received_max, result->received_max);
+        }
     }
 
     uint64_t avg_messages = total_messages / results.size();
@@ -111,12 +759,208 @@ int main(int argc, char* argv[]) {
     std::cout << "  Avg Throughput:         " << std::fixed << std::setprecision(2) << avg_throughput << " msg/sec" << std::endl;
     std::cout << "  Combined Throughput:    " << std::fixed << std::setprecision(2) << total_throughput_combined << " msg/sec" << std::endl;
 
+    std::cout << "  Lost Messages:          " << total_lost << std::endl;
+    std::cout << "  Client Drops:           " << total_dropped << std::endl;
+    std::cout << "  Disconnects:            " << total_disconnects << " (" << total_reconnects << " reconnected)"
+              << std::endl;
+    if (total_queue_drops > 0) {
+        std::cout << "  Handoff Queue Drops:    " << total_queue_drops << std::endl;
+    }
+    std::cout << "  Duplicates:             " << total_duplicates << std::endl;
+    std::cout << "  Out of Order:           " << total_out_of_order << std::endl;
+    std::cout << "  Longest Gap:            " << longest_gap << " messages" << std::endl;
+    if (logical_subscribers > 0) {
+        // Fairness across every logical subscriber of every multiplexed instance
+        std::cout << "  Logical Subscribers:    " << logical_subscribers << " (received min/max "
+                  << received_min << " / " << received_max << ")" << std::endl;
+    }
+
+    // The instance closest to its mem_limit, and allocations per delivery
+    // over every instance that counted them
+    uint64_t peak_rss = 0;
+    uint64_t counted_instances = 0;
+    double allocs_per_message = 0;
+    double alloc_bytes_per_message = 0;
+    for (const auto* result : results) {
+        peak_rss = std::max(peak_rss, result->memory.peak_rss_bytes);
+        if (!result->memory.allocations_counted) continue;
+        counted_instances++;
+        allocs_per_message += result->memory.allocs_per_message;
+        alloc_bytes_per_message += result->memory.alloc_bytes_per_message;
+    }
+    if (peak_rss > 0) {
+        std::cout << "  Peak RSS (max):         " << std::fixed << std::setprecision(1)
+                  << peak_rss / (1024.0 * 1024.0) << " MiB" << std::endl;
+    }
+    if (counted_instances > 0) {
+        std::cout << "  Allocations/Message:    " << std::fixed << std::setprecision(4)
+                  << allocs_per_message / counted_instances << " (" << std::setprecision(1)
+                  << alloc_bytes_per_message / counted_instances << " bytes, mean of "
+                  << counted_instances << " instance(s))" << std::endl;
+    }
+
+    if (mergedLatency.count() > 0) {
+        // Percentiles of the merged histogram, not averages of per-instance percentiles
+        std::cout << "\n⏱️  End-to-End Latency (merged across instances):" << std::endl;
+        std::cout << "───────────────────────────────────────────────" << std::endl;
+        std::cout << "  Samples:                " << mergedLatency.count() << std::endl;
+        std::cout << "  p50:                    " << std::fixed << std::setprecision(1) << mergedLatency.percentile(50.0) / 1000.0 << " us" << std::endl;
+        std::cout << "  p90:                    " << std::fixed << std::setprecision(1) << mergedLatency.percentile(90.0) / 1000.0 << " us" << std::endl;
+        std::cout << "  p99:                    " << std::fixed << std::setprecision(1) << mergedLatency.percentile(99.0) / 1000.0 << " us" << std::endl;
+        std::cout << "  p99.9:                  " << std::fixed << std::setprecision(1) << mergedLatency.percentile(99.9) / 1000.0 << " us" << std::endl;
+        std::cout << "  max:                    " << std::fixed << std::setprecision(1) << mergedLatency.max() / 1000.0 << " us" << std::endl;
+    }
+
+    // Align the per-interval series by wall-clock time and show the spread
+    // across instances for each interval
+    int intervalMs = 0;
+    std::map<uint64_t, std::vector<double>> intervalRates;  // interval index -> msg/s per instance
+    for (const auto* result : results) {
+        if (result->samples.empty() || result->sample_interval_ms <= 0) continue;
+        if (intervalMs == 0) intervalMs = result->sample_interval_ms;
+        if (result->sample_interval_ms != intervalMs) {
+            std::cerr << "  ⚠️  " << result->subscriber_id << " sampled every " << result->sample_interval_ms
+                      << " ms (expected " << intervalMs << "), skipping its time series" << std::endl;
+            continue;
+        }
+        for (const auto& row : result->samples) {
+            if (row.size() < 2) continue;
+            uint64_t index = (row[0] + intervalMs / 2) / intervalMs;
+            intervalRates[index].push_back(row[1] * 1000.0 / intervalMs);
+        }
+    }
+
+    if (!intervalRates.empty()) {
+        std::cout << "\n📈 Throughput Over Time (msg/sec per instance, " << intervalMs << " ms intervals):" << std::endl;
+        std::cout << "───────────────────────────────────────────────" << std::endl;
+        std::cout << "  " << std::setw(8) << std::right << "t (s)" << std::setw(6) << "n"
+                  << std::setw(12) << "min" << std::setw(12) << "max"
+                  << std::setw(12) << "mean" << std::setw(12) << "stddev" << std::endl;
+        uint64_t firstIndex = intervalRates.begin()->first;
+        for (const auto& [index, rates] : intervalRates) {
+            double sum = 0, sumSquares = 0;
+            for (double r : rates) {
+                sum += r;
+                sumSquares += r * r;
+            }
+            double mean = sum / rates.size();
+            double stddev = std::sqrt(std::max(0.0, sumSquares / rates.size() - mean * mean));
+            std::cout << "  " << std::setw(8) << std::fixed << std::setprecision(1)
+                      << (index - firstIndex) * intervalMs / 1000.0
+                      << std::setw(6) << rates.size() << std::setprecision(0)
+                      << std::setw(12) << *std::min_element(rates.begin(), rates.end())
+                      << std::setw(12) << *std::max_element(rates.begin(), rates.end())
+                      << std::setw(12) << mean << std::setw(12) << stddev << std::endl;
+        }
+        std::cout << std::left;
+    }
+
     std::cout << "\n📋 Per-Instance Details:" << std::endl;
     std::cout << "───────────────────────────────────────────────" << std::endl;
-    for (const auto& result : results) {
-        std::cout << "  " << std::setw(25) << std::left << result.subscriber_id
-                  << ": " << std::setw(12) << result.messages_received << " msgs, "
-                  << std::fixed << std::setprecision(2) << result.throughput_msg_per_sec << " msg/sec" << std::endl;
+    for (const auto* result : results) {
+        std::cout << "  " << std::setw(25) << std::left << result->subscriber_id
+                  << ": " << std::setw(12) << result->messages_received << " msgs, "
+                  << std::fixed << std::setprecision(2) << result->throughput_msg_per_sec << " msg/sec, p99 "
+                  << std::setprecision(1) << result->latency->percentile(99.0) / 1000.0 << " us" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> positional;
+    std::string csvDir;
+    unsigned numThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--csv" && i + 1 < argc) {
+            csvDir = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            numThreads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.empty()) {
+        std::cerr << "Usage: aggregator <results_directory> [<broker_type>|all] [--csv <output_dir>] [--threads N]" << std::endl;
+        std::cerr << "Example: aggregator /data/20240101_120000 redis" << std::endl;
+        std::cerr << "         aggregator /data/20240101_120000 all --csv /data/20240101_120000/merged" << std::endl;
+        return 1;
+    }
+
+    std::string resultsDir = positional[0];
+    std::string brokerType = positional.size() > 1 ? positional[1] : "all";
+
+    // Check if directory exists
+    if (!fs::exists(resultsDir)) {
+        std::cerr << "❌ Results directory not found: " << resultsDir << std::endl;
+        return 1;
+    }
+
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::directory_iterator(resultsDir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".json" && entry.path().filename() != "fault.json") {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::cout << "📂 Reading results from: " << resultsDir << std::endl;
+    std::vector<ParsedFile> parsed = parseResultFiles(paths, numThreads);
+
+    // Files without a broker_type (older runs) always match
+    auto selected = [&](const std::string& type) {
+        return brokerType == "all" || type.empty() || type == brokerType;
+    };
+
+    std::vector<const SubscriberResult*> results;
+    std::vector<const PublisherResult*> publishers;
+    for (const auto& file : parsed) {
+        if (!file.error.empty()) {
+            std::cerr << "  ⚠️  Error parsing " << file.path.filename() << ": " << file.error << std::endl;
+        } else if (file.sub && selected(file.sub->broker_type)) {
+            results.push_back(file.sub.get());
+            std::cout << "  ✓ " << file.path.filename() << std::endl;
+        } else if (file.pub && selected(file.pub->broker_type)) {
+            publishers.push_back(file.pub.get());
+        }
+    }
+
+    if (results.empty()) {
+        std::cerr << "❌ No results found in " << resultsDir << std::endl;
+        return 1;
+    }
+
+    // Written by scripts/run-fault-test.sh next to the result files
+    FaultWindow faultWindow;
+    const FaultWindow* fault = readFaultWindow(fs::path(resultsDir) / "fault.json", faultWindow) ? &faultWindow : nullptr;
+
+    if (!csvDir.empty() && !writeCsv(csvDir, results, publishers, fault)) {
+        return 1;
+    }
+
+    // Publisher and subscriber files of a batch, per broker
+    std::vector<BatchReport> reports = batchReports(results, publishers);
+    auto printReports = [&](const std::string& type) {
+        for (const BatchReport& report : reports) {
+            if (report.broker_type == type && report.publisher_processes > 0) printBatchReport(report);
+        }
+    };
+
+    if (brokerType != "all") {
+        printSummary(brokerType, results);
+        printReports(brokerType);
+        printRecovery(results, fault);
+    } else {
+        // One summary per broker in the directory
+        std::map<std::string, std::vector<const SubscriberResult*>> byBroker;
+        for (const auto* result : results) {
+            byBroker[result->broker_type.empty() ? "unknown" : result->broker_type].push_back(result);
+        }
+        for (const auto& [type, group] : byBroker) {
+            printSummary(type, group);
+            printReports(type);
+            printRecovery(group, fault);
+        }
     }
 
     std::cout << "\n";
@@ -1,8 +1,25 @@
 #include "benchmark_common.h"
 #include "config.h"
+#include "message_header.h"
+#include "latency_histogram.h"
+#include "rate_schedule.h"
+#include "payload_pool.h"
+#include "cpu_affinity.h"
+#include "throughput_sampler.h"
+#include "start_barrier.h"
+#include "topic_model.h"
+#include "hot_path_stats.h"
+#include "memory_stats.h"
 #include "message_broker.h"
 #include "redis_broker.h"
+#include "async_redis_broker.h"
+#include "redis_streams_broker.h"
+#include "redis_cluster_broker.h"
 #include "nats_broker.h"
+#include "jetstream_broker.h"
+#include "broker_dispatch.h"
+#include "broker_node_stats.h"
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <thread>
@@ -11,20 +28,107 @@
 #include <memory>
 #include <fstream>
 #include <sstream>
+#include <csignal>
 #include <cstring>
+#include <cstdlib>
 #include <unistd.h>
 #include <sys/stat.h>
 
 std::atomic<uint64_t> totalMessagesPublished(0);
+std::atomic<uint64_t> totalBytesPublished(0);
 std::mutex resultsMutex;
 
-std::unique_ptr<MessageBroker> createBroker(const std::string& brokerType) {
-    if (brokerType == "redis") {
-        return std::make_unique<RedisBroker>(
+// Open-loop bookkeeping, merged from every thread under resultsMutex
+std::vector<uint64_t> stepMessagesPublished;
+LatencyHistogram sendLagHistogram;  // actual - intended send time, ns
+std::vector<ThreadLocation> publisherLocations;
+
+// Live per-thread progress, read by the throughput sampler during the run
+struct alignas(64) PublisherProgress {
+    LocalCounter messages;
+    LocalCounter bytes;
+};
+std::unique_ptr<PublisherProgress[]> publisherProgress;
+
+std::unique_ptr<MessageBroker> createBroker(const std::string& brokerType, const Config& config) {
+    if (brokerType == "redis" && config.get("REDIS_CLIENT", "sync") == "async") {
+        // Every async broker of the process shares the event loop group
+        RedisEventLoop::setSharedLoopCount(config.getInt("REDIS_ASYNC_LOOP_THREADS", 1));
+        auto broker = std::make_unique<AsyncRedisBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+        broker->setConnectionOptions(config.getInt("REDIS_ASYNC_CONNECTIONS", 1),
+                                     config.getInt("REDIS_ASYNC_MAX_INFLIGHT", 1000));
+        return broker;
+    } else if (brokerType == "redis") {
+        auto broker = std::make_unique<RedisBroker>(
             std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
             std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
         );
+        if (config.get("REDIS_PUBLISH_MODE", "sync") == "pipelined") {
+            broker->setPipelining(config.getInt("REDIS_PIPELINE_SIZE", 1000),
+                                  config.getInt("REDIS_PIPELINE_FLUSH_US", 1000));
+        }
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
+    } else if (brokerType == "redis-cluster") {
+        return std::make_unique<RedisClusterBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+    } else if (brokerType == "redis-streams") {
+        auto broker = std::make_unique<RedisStreamsBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+        if (config.get("REDIS_PUBLISH_MODE", "sync") == "pipelined") {
+            broker->setPipelining(config.getInt("REDIS_PIPELINE_SIZE", 1000),
+                                  config.getInt("REDIS_PIPELINE_FLUSH_US", 1000));
+        }
+        broker->setStreamOptions(config.getInt("REDIS_STREAMS_MAXLEN", 0), 0, 0, "");
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
     } else if (brokerType == "nats") {
+        auto broker = std::make_unique<NatsBroker>(
+            std::getenv("NATS_URL") ? std::getenv("NATS_URL") : "nats://localhost:4222"
+        );
+        broker->setServerIndex(NatsBroker::nextServerIndex());
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
+    } else if (brokerType == "jetstream") {
+        auto broker = std::make_unique<JetStreamBroker>(
+            std::getenv("NATS_URL") ? std::getenv("NATS_URL") : "nats://localhost:4222"
+        );
+        broker->setStreamOptions(config.get("JETSTREAM_STREAM", "BENCHMARK"),
+                                 config.get("JETSTREAM_STORAGE", "file"),
+                                 config.getInt("JETSTREAM_REPLICAS", 1),
+                                 config.getInt("JETSTREAM_MAX_MSGS", 0));
+        if (config.getInt("NUM_TOPICS", 1) > 1) {
+            // One stream for the marker channel and every topic
+            broker->setStreamSubjects({ TopicModel::MARKER_CHANNEL,
+                                        std::string(TopicModel::MARKER_CHANNEL) + ".>" });
+        }
+        broker->setPublishWindow(config.getInt("JETSTREAM_PUBLISH_MAX_PENDING", 4000));
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
+    }
+    return nullptr;
+}
+
+// Plain pub/sub connection for the readiness handshake (see start_barrier.h)
+std::unique_ptr<MessageBroker> createControlBroker(const std::string& brokerType) {
+    // Plain PUBLISH reaches every node of a Redis cluster, so the seed node will do
+    if (brokerType == "redis" || brokerType == "redis-streams" || brokerType == "redis-cluster") {
+        return std::make_unique<RedisBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+    } else if (brokerType == "nats" || brokerType == "jetstream") {
         return std::make_unique<NatsBroker>(
             std::getenv("NATS_URL") ? std::getenv("NATS_URL") : "nats://localhost:4222"
         );
@@ -32,73 +136,206 @@ std::unique_ptr<MessageBroker> createBroker(const std::string& brokerType) {
     return nullptr;
 }
 
+// What a publisher thread's loop needs besides the broker
+struct PublisherRun {
+    int publisherId;
+    int numPublishers;
+    const int& publisherIdBase;  // this process' first id across all publisher processes
+    size_t batchSize;
+    const TopicModel& topics;
+    const RateSchedule& schedule;
+    PayloadPool& payloads;
+    PublisherProgress& progress;
+    const std::chrono::steady_clock::time_point& startTime;
+    const std::chrono::steady_clock::time_point& endTime;
+};
+
+// The publish loop, instantiated once per broker class by withConcreteBroker()
+template <typename Broker>
+void runPublisher(Broker& broker, const PublisherRun& run) {
+    const int publisherId = run.publisherId;
+    const int numPublishers = run.numPublishers;
+    const size_t batchSize = run.batchSize;
+    const TopicModel& topics = run.topics;
+    const RateSchedule& schedule = run.schedule;
+    PayloadPool& payloads = run.payloads;
+    PublisherProgress& progress = run.progress;
+    const auto& startTime = run.startTime;
+    const auto& endTime = run.endTime;
+
+    std::vector<std::string_view> batch;
+    batch.reserve(batchSize);
+    // Unique across publisher processes, so their sequence streams stay apart
+    const uint32_t streamId = static_cast<uint32_t>(run.publisherIdBase + publisherId);
+    MessageHeader header;
+    header.publisherId = streamId;
+
+    // Sequences are numbered per topic, so a subscriber holding only some
+    // topics still sees gap-free streams. A batch goes to a single topic.
+    TopicPicker picker(topics, static_cast<uint64_t>(streamId) + 1);
+    std::vector<uint64_t> sequences(topics.size(), 0);
+    size_t topic = 0;
+
+    if (schedule.isOpenLoop()) {
+        // Open loop: each thread owns 1/numPublishers of the target rate and
+        // sends on a fixed schedule, staggered so threads interleave evenly.
+        // Timestamps carry the intended send time, so when the broker pushes
+        // back the delay shows up as latency instead of a lower send rate.
+        std::vector<uint64_t> stepCounts(schedule.rates.size(), 0);
+        std::vector<uint16_t> batchSteps;
+        batchSteps.reserve(batchSize);
+        auto sendBatch = [&]() {
+            size_t accepted = publishBatchTo(broker, topics.names[topic], batch);
+            for (size_t i = 0; i < accepted; i++) {
+                progress.messages.add();
+                progress.bytes.add(batch[i].size());
+                stepCounts[batchSteps[i]]++;
+            }
+            batch.clear();
+            batchSteps.clear();
+        };
+        auto lag = std::make_unique<LatencyHistogram>();
+        auto steadyBase = std::chrono::steady_clock::now();
+        uint64_t wallBase = wallClockNs();
+
+        size_t step = schedule.stepAt(steadyBase - startTime);
+        auto interval = std::chrono::duration<double, std::nano>(1e9 * numPublishers / schedule.rates[step]);
+        auto intended = steadyBase + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            interval * (static_cast<double>(publisherId) / numPublishers));
+        std::chrono::duration<double, std::nano> carry(0);
+
+        while (intended < endTime) {
+            waitUntil(intended);
+            auto actual = std::chrono::steady_clock::now();
+
+            if (batch.empty()) topic = picker.next();
+            header.sequence = sequences[topic]++;
+            header.rateStep = static_cast<uint16_t>(step);
+            header.sendTimestampNs = wallBase + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                intended - steadyBase).count();
+            const std::string& message = payloads.next(header);
+            if (batchSize > 1) {
+                // Messages wait for the rest of their batch; that delay is
+                // part of their latency, as it would be for a real producer
+                batch.push_back(message);
+                batchSteps.push_back(static_cast<uint16_t>(step));
+                if (batch.size() == batchSize) sendBatch();
+            } else if (publishTo(broker, topics.names[topic], message)) {
+                progress.messages.add();
+                progress.bytes.add(message.size());
+                stepCounts[step]++;
+            }
+            lag->record(std::chrono::duration_cast<std::chrono::nanoseconds>(actual - intended).count());
+
+            // Advance the schedule by whole clock ticks, carrying the fractional part
+            size_t nextStep = schedule.stepAt(intended - startTime);
+            if (nextStep != step) {
+                step = nextStep;
+                interval = std::chrono::duration<double, std::nano>(1e9 * numPublishers / schedule.rates[step]);
+            }
+            carry += interval;
+            auto whole = std::chrono::duration_cast<std::chrono::steady_clock::duration>(carry);
+            carry -= whole;
+            intended += whole;
+        }
+        if (!batch.empty()) sendBatch();
+
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        for (size_t i = 0; i < stepCounts.size(); i++) {
+            stepMessagesPublished[i] += stepCounts[i];
+        }
+        sendLagHistogram.merge(*lag);
+    } else if (batchSize > 1) {
+        // Closed loop, batched: stamp a full batch, then hand it over in one call
+        while (std::chrono::steady_clock::now() < endTime) {
+            topic = picker.next();
+            for (size_t i = 0; i < batchSize; i++) {
+                header.sequence = sequences[topic]++;
+                header.sendTimestampNs = wallClockNs();
+                batch.push_back(payloads.next(header));
+            }
+            size_t accepted = publishBatchTo(broker, topics.names[topic], batch);
+            progress.messages.add(accepted);
+            for (size_t i = 0; i < accepted; i++) {
+                progress.bytes.add(batch[i].size());
+            }
+            batch.clear();
+        }
+    } else {
+        // Closed loop: publish as fast as the broker accepts
+        while (std::chrono::steady_clock::now() < endTime) {
+            topic = picker.next();
+            header.sequence = sequences[topic]++;
+            header.sendTimestampNs = wallClockNs();
+            const std::string& message = payloads.next(header);
+            if (publishTo(broker, topics.names[topic], message)) {
+                progress.messages.add();
+                progress.bytes.add(message.size());
+            }
+        }
+    }
+}
+
 void publisherThread(int publisherId,
                     int numPublishers,
                     int publishDurationSeconds,
                     const std::string& brokerType,
-                    const std::string& channel,
-                    std::chrono::steady_clock::time_point endTime,
-                    std::chrono::steady_clock::time_point& firstMessageTime,
-                    std::chrono::steady_clock::time_point& lastMessageTime) {
-    uint64_t messagesPublished = 0;
-    uint64_t messageCounter = 0;
+                    const Config& config,
+                    const TopicModel& topics,
+                    const RateSchedule& schedule,
+                    const PayloadSizeDistribution& payloadSizes,
+                    const ThreadPlacement& placement,
+                    Barrier& runBarrier,
+                    const int& publisherIdBase,
+                    const std::chrono::steady_clock::time_point& startTime,
+                    const std::chrono::steady_clock::time_point& endTime) {
+    // Pin before anything is allocated so the thread's buffers are node-local
+    ThreadLocation location = placement.apply(publisherId);
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        publisherLocations[publisherId] = location;
+    }
+
+    PublisherProgress& progress = publisherProgress[publisherId];
 
     // Each thread needs its own connection (Redis connections are NOT thread-safe!)
-    auto broker = createBroker(brokerType);
-    if (!broker) {
-        std::cerr << "❌ Thread " << publisherId << " failed to create broker" << std::endl;
-        return;
-    }
-    
-    if (!broker->connect()) {
-        std::cerr << "❌ Thread " << publisherId << " failed to connect" << std::endl;
+    auto broker = createBroker(brokerType, config);
+    if (!broker || !broker->connect()) {
+        std::cerr << "❌ Thread " << publisherId << " failed to " << (broker ? "connect" : "create broker") << std::endl;
+        // Still arrive at both barrier points so the others are not held up
+        runBarrier.wait();
+        runBarrier.wait();
         return;
     }
     
     std::cerr << "✓ Thread " << publisherId << " connected successfully" << std::endl;
 
-    // Send START marker only from first publisher
-    if (publisherId == 0) {
-        broker->publish(channel, "START_BENCHMARK");
-        broker->flush();  // Flush immediately to ensure START signal is sent
-        
-        // Give subscribers a moment to receive and process START signal before flood begins
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-        
-        {
-            std::lock_guard<std::mutex> lock(resultsMutex);
-            firstMessageTime = std::chrono::steady_clock::now();
-        }
-    }
-    
-    // Wait for all threads to receive START signal before publishing
-    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    // PUBLISH_BATCH_SIZE > 1 hands messages to the broker through publishBatch()
+    size_t batchSize = static_cast<size_t>(std::max(config.getInt("PUBLISH_BATCH_SIZE", 1), 1));
 
-    // Publish messages for the specified duration
-    while (std::chrono::steady_clock::now() < endTime) {
-        std::string message = "msg_" + std::to_string(publisherId) + "_" + std::to_string(messageCounter++);
-        if (broker->publish(channel, message)) {
-            messagesPublished++;
-        }
-    }
+    // Payload buffers are pre-filled; only the header is rewritten per message.
+    // A batch must not wrap around the ring, so keep at least batchSize slots.
+    PayloadPool payloads(payloadSizes,
+                         std::max<size_t>(config.getInt("PAYLOAD_POOL_SIZE", 1024), batchSize),
+                         static_cast<uint32_t>(publisherId) + 1);
+    PublisherRun run{publisherId, numPublishers, publisherIdBase, batchSize, topics, schedule, payloads,
+                     progress, startTime, endTime};
+
+    // Released by main once every subscriber has seen START; publisherIdBase,
+    // startTime and endTime are set before that
+    runBarrier.wait();
+
+    // One instantiation of the loop per broker class: no virtual call per publish
+    withConcreteBroker(*broker, [&run](auto& concrete) { runPublisher(concrete, run); });
     
-    // Flush any pending messages
+    // Flush any pending messages, then let main send END once every thread is done
     broker->flush();
+    runBarrier.wait();
 
-    // Send END marker only from first publisher
-    if (publisherId == 0) {
-        broker->publish(channel, "END_BENCHMARK");
-        broker->flush();
-        
-        {
-            std::lock_guard<std::mutex> lock(resultsMutex);
-            lastMessageTime = std::chrono::steady_clock::now();
-        }
-    }
-
-    totalMessagesPublished.fetch_add(messagesPublished, std::memory_order_relaxed);
+    totalMessagesPublished.fetch_add(progress.messages.get(), std::memory_order_relaxed);
+    totalBytesPublished.fetch_add(progress.bytes.get(), std::memory_order_relaxed);
     
-    std::cerr << "✓ Thread " << publisherId << " published " << messagesPublished << " messages" << std::endl;
+    std::cerr << "✓ Thread " << publisherId << " published " << progress.messages.get() << " messages" << std::endl;
     
     // Clean up thread-local connection
     broker->disconnect();
@@ -107,11 +344,48 @@ void publisherThread(int publisherId,
 }
 
 int main() {
+    // A broker that goes away mid-run must show up as a failed write the
+    // reconnect logic can handle, not as a SIGPIPE that kills the process
+    std::signal(SIGPIPE, SIG_IGN);
     // Load configuration from .env file
     Config config;
     int numPublishers = config.getInt("NUM_PUBLISHERS", 10);
+    int numSubscribers = config.getInt("NUM_SUBSCRIBERS", 1);  // subscriber processes to wait for
+    int publisherProcesses = std::max(config.getInt("PUBLISHER_PROCESSES", 1), 1);  // this one included
     int publishDurationSeconds = config.getInt("PUBLISH_DURATION_SECONDS", 60);
     
+    // Optional open-loop schedule; a ramp with explicit step length sets the duration
+    RateSchedule schedule = RateSchedule::parse(config.get("PUBLISH_RATE_RAMP"),
+                                                config.getInt("PUBLISH_RATE", 0),
+                                                publishDurationSeconds,
+                                                config.getInt("PUBLISH_RATE_STEP_SECONDS", 0));
+    if (schedule.totalSeconds() > publishDurationSeconds) {
+        publishDurationSeconds = static_cast<int>(schedule.totalSeconds() + 0.999);
+    }
+    stepMessagesPublished.assign(schedule.rates.size(), 0);
+    int publishBatchSize = std::max(config.getInt("PUBLISH_BATCH_SIZE", 1), 1);
+    
+    ThreadPlacement placement = ThreadPlacement::fromConfig(config.get("PUBLISHER_CPUS"),
+                                                            config.get("NUMA_POLICY", "none"));
+    publisherLocations.assign(numPublishers, ThreadLocation());
+    publisherProgress = std::make_unique<PublisherProgress[]>(numPublishers);
+    
+    // Capacity covers the run plus START/END handling with room to spare
+    int sampleIntervalMs = std::max(config.getInt("SAMPLE_INTERVAL_MS", 100), 1);
+    ThroughputSampler sampler(sampleIntervalMs,
+                              static_cast<size_t>(publishDurationSeconds + 60) * 1000 / sampleIntervalMs);
+    
+    PayloadSizeDistribution payloadSizes = PayloadSizeDistribution::fromConfig(
+        config.get("PAYLOAD_DISTRIBUTION", "fixed"),
+        config.getInt("PAYLOAD_SIZE", 0),
+        config.getInt("PAYLOAD_SIZE_MIN", 0),
+        config.getInt("PAYLOAD_SIZE_MAX", 0),
+        config.get("PAYLOAD_HISTOGRAM_FILE"));
+    
+    TopicModel topics = TopicModel::fromConfig(config.getInt("NUM_TOPICS", 1),
+                                               config.get("TOPIC_DISTRIBUTION", "uniform"),
+                                               std::atof(config.get("TOPIC_ZIPF_EXPONENT", "1.0").c_str()));
+    
     config.print();
 
     // Determine broker type from first argument or environment variable
@@ -121,7 +395,7 @@ int main() {
     }
     
     // Create a test broker just to get the name (threads will create their own connections)
-    auto testBroker = createBroker(brokerType);
+    auto testBroker = createBroker(brokerType, config);
     if (!testBroker) {
         std::cerr << "❌ Unknown broker type: " << brokerType << std::endl;
         return 1;
@@ -131,23 +405,213 @@ int main() {
     
     std::cout << "\n🚀 Starting " << testBroker->getName() << " Publisher..." << std::endl;
     std::cout << "✓ Each publisher thread will create its own connection" << std::endl;
+    std::cout << "✓ Publish mode: " << testBroker->getPublishMode() << std::endl;
+    std::cout << "✓ Payload size: " << payloadSizes.describe() << std::endl;
+    std::cout << "✓ Publish batch size: " << publishBatchSize << std::endl;
+    std::cout << "✓ Topics: " << topics.describe() << std::endl;
+    std::cout << "✓ Thread placement: " << placement.describe() << std::endl;
+    if (schedule.isOpenLoop()) {
+        std::cout << "✓ Open loop: " << schedule.rates.size() << " rate step(s) of "
+                  << std::fixed << std::setprecision(1) << schedule.stepSeconds << "s, starting at "
+                  << std::setprecision(0) << schedule.rates.front() << " msg/sec" << std::endl;
+    } else {
+        std::cout << "✓ Closed loop: publishing as fast as possible" << std::endl;
+    }
 
-    // Calculate end time
-    auto startTime = std::chrono::steady_clock::now();
-    auto endTime = startTime + std::chrono::seconds(publishDurationSeconds);
+    // Threads connect and prepare while we wait for the subscribers, then
+    // park on runBarrier: once at the start, once when they are done
+    Barrier runBarrier(numPublishers + 1);
+    int publisherIdBase = 0;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point endTime;
+
+    auto readProgress = [numPublishers] {
+        CounterSnapshot snapshot;
+        for (int i = 0; i < numPublishers; i++) {
+            snapshot.messages += publisherProgress[i].messages.get();
+            snapshot.bytes += publisherProgress[i].bytes.get();
+        }
+        return snapshot;
+    };
+    sampler.start(readProgress);
 
     std::cout << "   Starting " << numPublishers << " concurrent publishers for " 
               << publishDurationSeconds << " seconds..." << std::endl;
 
-    std::chrono::steady_clock::time_point firstMessageTime;
-    std::chrono::steady_clock::time_point lastMessageTime;
-
     // Launch publisher threads - each will create its own connection
     std::vector<std::thread> threads;
     for (int i = 0; i < numPublishers; i++) {
         threads.emplace_back(publisherThread, i, numPublishers, publishDurationSeconds,
-                           brokerType, "benchmark_channel",
-                           endTime, std::ref(firstMessageTime), std::ref(lastMessageTime));
+                           brokerType, std::cref(config), std::cref(topics),
+                           std::cref(schedule), std::cref(payloadSizes), std::cref(placement),
+                           std::ref(runBarrier), std::cref(publisherIdBase),
+                           std::cref(startTime), std::cref(endTime));
+    }
+
+    auto control = createControlBroker(brokerType);
+    SubscriberReadiness readiness(*control);
+    int readyTimeoutSeconds = std::max(config.getInt("READY_TIMEOUT_SECONDS", 60), 1);
+    auto readinessStart = std::chrono::steady_clock::now();
+    bool controlOpen = control->connect() && readiness.listen();
+    if (!controlOpen) {
+        std::cerr << "⚠️  Could not open the control channel, starting without the readiness handshake" << std::endl;
+    }
+
+    // Several publisher processes first find each other. The first by
+    // instance id leads: it alone runs the subscriber handshake.
+    std::string instanceId = controlInstanceId("publisher");
+    PublisherRank rank;
+    if (publisherProcesses > 1 && controlOpen) {
+        std::cout << "⏳ Waiting for " << publisherProcesses << " publisher process(es)..." << std::endl;
+        size_t peers = readiness.waitForPublishers(
+            static_cast<size_t>(publisherProcesses), std::chrono::seconds(readyTimeoutSeconds),
+            [&] { announcePublisher(*control, instanceId, numPublishers); });
+        // Once more, for a peer that joined after our last announcement
+        announcePublisher(*control, instanceId, numPublishers);
+        if (peers < static_cast<size_t>(publisherProcesses)) {
+            std::cerr << "⚠️  Only " << peers << " of " << publisherProcesses << " publisher processes after "
+                      << readyTimeoutSeconds << "s, starting anyway" << std::endl;
+        }
+        rank = readiness.rankOf(instanceId);
+        std::cout << "✓ Publisher process " << rank.index + 1 << " of " << rank.processes
+                  << (rank.index == 0 ? " (leader)" : "") << ", publisher ids from "
+                  << rank.publisherIdBase << std::endl;
+    }
+    publisherIdBase = rank.publisherIdBase;
+    bool leader = rank.index == 0;
+
+    // Wait until every subscriber process has announced itself
+    size_t subscribersReady = 0;
+    if (leader && controlOpen) {
+        std::cout << "⏳ Waiting for " << numSubscribers << " subscriber(s) to be ready..." << std::endl;
+        subscribersReady = readiness.waitForReady(static_cast<size_t>(numSubscribers),
+                                                  std::chrono::seconds(readyTimeoutSeconds));
+    }
+    if (leader && subscribersReady < static_cast<size_t>(numSubscribers)) {
+        std::cerr << "⚠️  Only " << subscribersReady << " of " << numSubscribers
+                  << " subscribers ready after " << readyTimeoutSeconds << "s, starting anyway" << std::endl;
+    }
+
+    // START and END go out on main's own connection, after the publisher
+    // threads are parked and after they have all flushed
+    bool markersConnected = testBroker->connect();
+    if (!markersConnected) {
+        std::cerr << "❌ Failed to connect for the START/END markers" << std::endl;
+    }
+
+    // The leader arms the subscribers with START and waits for STARTED
+    // before it fixes the start instant, so a slow acknowledgement cannot
+    // eat into the time the GO needs to reach every follower
+    std::string markerBatchId = std::getenv("BATCH_ID") ? std::getenv("BATCH_ID") : "";
+    size_t subscribersStarted = 0;
+    auto startSent = std::chrono::steady_clock::now();
+    if (markersConnected && leader) {
+        // The batch id lets subscribers that outlive one run file this one correctly
+        testBroker->publish(TopicModel::MARKER_CHANNEL, formatStartMarker(MeasurementWindow(), markerBatchId));
+        testBroker->flush();
+        if (subscribersReady > 0) {
+            subscribersStarted = readiness.waitForStarted(subscribersReady, std::chrono::seconds(10));
+        }
+    }
+    auto setupDuration = std::chrono::duration_cast<std::chrono::milliseconds>(startSent - readinessStart);
+    auto startAckDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startSent);
+
+    // The start instant. With several publisher processes it lies
+    // PUBLISHER_START_DELAY_MS ahead, so that the leader's GO reaches every
+    // follower in time; it is a wall clock time, so nodes need synchronized
+    // clocks (NTP) as for latency.
+    int startDelayMs = publisherProcesses > 1 ? std::max(config.getInt("PUBLISHER_START_DELAY_MS", 1000), 0) : 0;
+    uint64_t startWallNs = 0;
+    if (leader) {
+        startWallNs = wallClockNs() + static_cast<uint64_t>(startDelayMs) * 1000000;
+        if (publisherProcesses > 1 && controlOpen) {
+            announceGo(*control, startWallNs);
+        }
+    } else {
+        std::cout << "⏳ Waiting for the leading publisher's start time..." << std::endl;
+        // The leader may still be waiting for subscribers, then for STARTED
+        startWallNs = readiness.waitForGo(std::chrono::seconds(readyTimeoutSeconds + 20));
+        if (startWallNs == 0) {
+            std::cerr << "⚠️  No start time from the leading publisher, starting now" << std::endl;
+            startWallNs = wallClockNs();
+        }
+        setupDuration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - readinessStart);
+    }
+    {
+        auto nowSteady = std::chrono::steady_clock::now();
+        int64_t aheadNs = static_cast<int64_t>(startWallNs) - static_cast<int64_t>(wallClockNs());
+        startTime = nowSteady + std::chrono::nanoseconds(aheadNs);
+    }
+    endTime = startTime + std::chrono::seconds(publishDurationSeconds);
+
+    // Steady-state window: publishers run flat out the whole time, but only
+    // messages stamped inside [start + warm-up, end - cool-down) are counted
+    // in the headline numbers. The window is fixed relative to the start
+    // instant, so the leader restates START with it once that is known.
+    int warmupSeconds = std::max(config.getInt("WARMUP_SECONDS", 0), 0);
+    int cooldownSeconds = std::max(config.getInt("COOLDOWN_SECONDS", 0), 0);
+    if (warmupSeconds + cooldownSeconds >= publishDurationSeconds && warmupSeconds + cooldownSeconds > 0) {
+        std::cerr << "⚠️  WARMUP_SECONDS + COOLDOWN_SECONDS must be shorter than the run, measuring the whole run" << std::endl;
+        warmupSeconds = cooldownSeconds = 0;
+    }
+    auto steadyStart = startTime + std::chrono::seconds(warmupSeconds);
+    auto steadyEnd = endTime - std::chrono::seconds(cooldownSeconds);
+    MeasurementWindow window;
+    if (warmupSeconds > 0 || cooldownSeconds > 0) {
+        auto nowSteady = std::chrono::steady_clock::now();
+        uint64_t nowWall = wallClockNs();
+        auto toWallNs = [&](std::chrono::steady_clock::time_point t) {
+            return nowWall + std::chrono::duration_cast<std::chrono::nanoseconds>(t - nowSteady).count();
+        };
+        window.fromNs = toWallNs(steadyStart);
+        window.toNs = toWallNs(steadyEnd);
+        std::cout << "✓ Steady-state window: " << warmupSeconds << "s warm-up, "
+                  << cooldownSeconds << "s cool-down" << std::endl;
+    }
+    if (markersConnected && leader && window.enabled()) {
+        testBroker->publish(TopicModel::MARKER_CHANNEL, formatStartMarker(window, markerBatchId));
+        testBroker->flush();
+    }
+
+    if (leader) {
+        std::cout << "✓ " << subscribersReady << " subscriber(s) ready after " << setupDuration.count() << " ms, "
+                  << subscribersStarted << " saw START within " << startAckDuration.count() << " ms" << std::endl;
+    } else {
+        std::cout << "✓ Start time received after " << setupDuration.count() << " ms" << std::endl;
+    }
+
+    // Broker-side CPU and output per node over the publish window, read by
+    // the leader only: the nodes are shared by every publisher process
+    std::unique_ptr<BrokerNodeProbe> nodeProbe;
+    if (leader && config.getInt("BROKER_NODE_STATS", 1) != 0) {
+        nodeProbe = std::make_unique<BrokerNodeProbe>(brokerType);
+    }
+
+    std::this_thread::sleep_until(startTime);
+    runBarrier.wait();  // release the publisher threads together
+    AllocationCounts allocationsAtStart = allocationCounts();
+    if (nodeProbe) nodeProbe->start();
+
+    // Snapshot the counters at the window edges; the difference is what was
+    // published during the steady state
+    CounterSnapshot atSteadyStart;
+    CounterSnapshot atSteadyEnd;
+    if (window.enabled()) {
+        std::this_thread::sleep_until(steadyStart);
+        atSteadyStart = readProgress();
+        std::this_thread::sleep_until(steadyEnd);
+        atSteadyEnd = readProgress();
+    }
+
+    // Every thread has flushed; END can no longer overtake a data message.
+    // Each publisher process sends its own; subscribers count them.
+    runBarrier.wait();
+    if (nodeProbe) nodeProbe->stop();
+    if (markersConnected) {
+        testBroker->publish(TopicModel::MARKER_CHANNEL, "END_BENCHMARK");
+        testBroker->flush();
     }
 
     // Wait for all threads to complete
@@ -156,22 +620,77 @@ int main() {
     }
 
     auto overallEndTime = std::chrono::steady_clock::now();
+    sampler.stop();
+    MemoryReport memory = MemoryReport::since(allocationsAtStart, totalMessagesPublished);
 
     // Calculate and display results
     auto totalDuration = std::chrono::duration_cast<std::chrono::milliseconds>(overallEndTime - startTime);
     double totalSeconds = totalDuration.count() / 1000.0;
     double throughput = totalSeconds > 0 ? totalMessagesPublished / totalSeconds : 0;
+    double throughputBytes = totalSeconds > 0 ? totalBytesPublished / totalSeconds : 0;
+
+    // Per-phase counts; without a window everything is steady state
+    uint64_t warmupMessages = window.enabled() ? atSteadyStart.messages : 0;
+    uint64_t steadyMessages = window.enabled() ? atSteadyEnd.messages - atSteadyStart.messages : totalMessagesPublished.load();
+    uint64_t cooldownMessages = window.enabled() ? totalMessagesPublished - atSteadyEnd.messages : 0;
+    if (window.enabled()) {
+        double steadySeconds = window.seconds();
+        throughput = steadyMessages / steadySeconds;
+        throughputBytes = (atSteadyEnd.bytes - atSteadyStart.bytes) / steadySeconds;
+    }
 
     std::cout << "\n========================================" << std::endl;
     std::cout << testBroker->getName() << " Publisher Results:" << std::endl;
     std::cout << "========================================" << std::endl;
     std::cout << "Concurrent Publishers:  " << numPublishers << std::endl;
+    if (publisherProcesses > 1) {
+        std::cout << "Publisher Process:      " << rank.index + 1 << " of " << rank.processes
+                  << (leader ? " (leader)" : "") << std::endl;
+    }
+    std::cout << "Publish Mode:           " << testBroker->getPublishMode() << std::endl;
+    std::cout << "Publish Batch Size:     " << publishBatchSize << std::endl;
     std::cout << "Duration:               " << publishDurationSeconds << " seconds" << std::endl;
     std::cout << "Messages Published:     " << totalMessagesPublished << std::endl;
     std::cout << "Total Duration:         " << std::fixed << std::setprecision(3) << totalSeconds << " seconds" << std::endl;
-    std::cout << "Publish Throughput:     " << std::fixed << std::setprecision(0) << throughput << " msg/sec" << std::endl;
+    if (window.enabled()) {
+        std::cout << "Warm-up / Steady / Cool-down: " << warmupMessages << " / " << steadyMessages
+                  << " / " << cooldownMessages << " msgs" << std::endl;
+    }
+    std::cout << "Publish Throughput:     " << std::fixed << std::setprecision(0) << throughput << " msg/sec"
+              << (window.enabled() ? " (steady state)" : "") << std::endl;
+    std::cout << "Publish Bandwidth:      " << std::fixed << std::setprecision(2) << throughputBytes / (1024.0 * 1024.0) << " MiB/sec" << std::endl;
     std::cout << "Avg per Publisher:      " << std::fixed << std::setprecision(0) 
               << (throughput / numPublishers) << " msg/sec" << std::endl;
+    std::cout << "RSS / Peak / Heap:      " << std::fixed << std::setprecision(1)
+              << memory.usage.rssBytes / (1024.0 * 1024.0) << " / " << memory.usage.peakRssBytes / (1024.0 * 1024.0)
+              << " / " << memory.usage.heapInUseBytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+    if (ALLOCATION_COUNTING) {
+        std::cout << "Allocations:            " << memory.allocations.allocations << " ("
+                  << std::setprecision(4) << memory.allocationsPerMessage() << " per message, "
+                  << std::setprecision(1) << memory.bytesPerMessage() << " bytes per message)" << std::endl;
+    }
+    if (schedule.isOpenLoop()) {
+        std::cout << "Send Lag p99 / max:     " << std::fixed << std::setprecision(1)
+                  << sendLagHistogram.percentile(99.0) / 1000.0 << " / "
+                  << sendLagHistogram.max() / 1000.0 << " us" << std::endl;
+        for (size_t i = 0; i < schedule.rates.size(); i++) {
+            std::cout << "  Step " << std::setw(2) << i << ": target " << std::setprecision(0)
+                      << schedule.rates[i] << " msg/sec, achieved "
+                      << (schedule.stepSeconds > 0 ? stepMessagesPublished[i] / schedule.stepSeconds : 0)
+                      << " msg/sec" << std::endl;
+        }
+    }
+    if (nodeProbe) {
+        for (const auto& load : nodeProbe->results()) {
+            if (!load.ok) {
+                std::cout << "Broker Node " << load.node << ": no reading" << std::endl;
+                continue;
+            }
+            std::cout << "Broker Node " << load.node << ": " << std::fixed << std::setprecision(1)
+                      << load.cpuPercent << "% CPU, " << std::setprecision(2)
+                      << load.outBytesPerSec / (1024.0 * 1024.0) << " MiB/sec out" << std::endl;
+        }
+    }
     std::cout << "========================================\n" << std::endl;
 
     // Write results to JSON file for analytics
@@ -189,6 +708,9 @@ int main() {
         }
     }
     std::string hostname = hostnameEnv ? std::string(hostnameEnv) : std::string(hostbuf);
+    // Containers get random hostnames; NODE_NAME names the machine for per-node reports
+    std::string nodeName = config.get("NODE_NAME");
+    if (nodeName.empty()) nodeName = hostname;
 
     // Get timestamp
     auto now = std::chrono::system_clock::now();
@@ -210,12 +732,6 @@ int main() {
         ::mkdir(batchDir.c_str(), 0755);
     }
 
-    // Get environment configuration
-    int numSubscribers = 1;
-    if (std::getenv("NUM_SUBSCRIBERS")) {
-        numSubscribers = std::atoi(std::getenv("NUM_SUBSCRIBERS"));
-    }
-
     std::ostringstream filepath;
     filepath << batchDir << "/" << brokerType << "_publisher_" << hostname << "_" << tsbuf << ".json";
     std::ofstream out(filepath.str());
@@ -225,18 +741,88 @@ int main() {
         out << "  \"broker_type\": \"" << brokerType << "\",\n";
         out << "  \"role\": \"publisher\",\n";
         out << "  \"host\": \"" << hostname << "\",\n";
+        out << "  \"node\": \"" << nodeName << "\",\n";
         out << "  \"timestamp\": \"" << tsbuf << "\",\n";
+        out << "  \"publisher_process\": {\"index\": " << rank.index
+            << ", \"processes\": " << rank.processes
+            << ", \"leader\": " << (leader ? "true" : "false")
+            << ", \"publisher_id_base\": " << rank.publisherIdBase
+            << ", \"start_wall_ns\": " << startWallNs << "},\n";
+        out << "  \"placement\": ";
+        placement.writeJson(out, publisherLocations);
+        out << ",\n";
         out << "  \"config\": {\n";
         out << "    \"num_publishers\": " << numPublishers << ",\n";
         out << "    \"num_subscribers\": " << numSubscribers << ",\n";
-        out << "    \"publish_duration_seconds\": " << publishDurationSeconds << "\n";
+        out << "    \"publisher_processes\": " << publisherProcesses << ",\n";
+        out << "    \"publish_duration_seconds\": " << publishDurationSeconds << ",\n";
+        out << "    \"publish_mode\": \"" << testBroker->getPublishMode() << "\",\n";
+        out << "    \"publish_batch_size\": " << publishBatchSize << ",\n";
+        out << "    \"num_topics\": " << topics.size() << ",\n";
+        out << "    \"topic_distribution\": \"" << (topics.zipf ? "zipf" : "uniform") << "\",\n";
+        out << "    \"topic_zipf_exponent\": " << std::fixed << std::setprecision(2) << topics.zipfExponent << ",\n";
+        out << "    \"warmup_seconds\": " << warmupSeconds << ",\n";
+        out << "    \"cooldown_seconds\": " << cooldownSeconds << ",\n";
+        out << "    \"ready_timeout_seconds\": " << readyTimeoutSeconds << ",\n";
+        out << "    \"pipeline_size\": " << config.getInt("REDIS_PIPELINE_SIZE", 1000) << ",\n";
+        out << "    \"pipeline_flush_us\": " << config.getInt("REDIS_PIPELINE_FLUSH_US", 1000) << ",\n";
+        out << "    \"redis_async_connections\": " << config.getInt("REDIS_ASYNC_CONNECTIONS", 1) << ",\n";
+        out << "    \"redis_async_max_inflight\": " << config.getInt("REDIS_ASYNC_MAX_INFLIGHT", 1000) << ",\n";
+        out << "    \"payload_distribution\": \"" << payloadSizes.kind << "\",\n";
+        out << "    \"payload_size_min\": " << (payloadSizes.kind == "fixed" ? payloadSizes.fixedSize : payloadSizes.minSize) << ",\n";
+        out << "    \"payload_size_max\": " << (payloadSizes.kind == "fixed" ? payloadSizes.fixedSize : payloadSizes.maxSize) << ",\n";
+        out << "    \"load_model\": \"" << (schedule.isOpenLoop() ? "open" : "closed") << "\",\n";
+        out << "    \"rate_step_seconds\": " << std::fixed << std::setprecision(3) << schedule.stepSeconds << ",\n";
+        out << "    \"rate_schedule\": [";
+        for (size_t i = 0; i < schedule.rates.size(); i++) {
+            out << (i ? ", " : "") << std::setprecision(0) << schedule.rates[i];
+        }
+        out << "]\n";
         out << "  },\n";
+        out << "  \"startup\": {\"subscribers_ready\": " << subscribersReady
+            << ", \"subscriber_threads_ready\": " << readiness.readyThreads()
+            << ", \"subscribers_started\": " << subscribersStarted
+            << ", \"ready_wait_ms\": " << setupDuration.count()
+            << ", \"start_ack_ms\": " << startAckDuration.count() << "},\n";
         out << "  \"results\": {\n";
         out << "    \"messages_published\": " << totalMessagesPublished << ",\n";
+        out << "    \"bytes_published\": " << totalBytesPublished << ",\n";
         out << "    \"duration_ms\": " << totalDuration.count() << ",\n";
         out << "    \"duration_seconds\": " << std::fixed << std::setprecision(3) << totalSeconds << ",\n";
         out << "    \"throughput_msg_per_sec\": " << std::fixed << std::setprecision(2) << throughput << ",\n";
-        out << "    \"avg_per_publisher_msg_per_sec\": " << std::fixed << std::setprecision(2) << (throughput / numPublishers) << "\n";
+        out << "    \"throughput_bytes_per_sec\": " << std::fixed << std::setprecision(2) << throughputBytes << ",\n";
+        out << "    \"avg_per_publisher_msg_per_sec\": " << std::fixed << std::setprecision(2) << (throughput / numPublishers) << ",\n";
+        out << "    \"phases\": {\"warmup\": {\"messages_published\": " << warmupMessages
+            << "}, \"steady\": {\"messages_published\": " << steadyMessages
+            << ", \"duration_seconds\": " << std::setprecision(3) << (window.enabled() ? window.seconds() : totalSeconds)
+            << ", \"throughput_msg_per_sec\": " << std::setprecision(2) << throughput
+            << "}, \"cooldown\": {\"messages_published\": " << cooldownMessages << "}},\n";
+        out << "    \"send_lag_us\": ";
+        sendLagHistogram.writeSummaryJson(out);
+        out << ",\n";
+        out << "    \"rate_steps\": [";
+        for (size_t i = 0; i < schedule.rates.size(); i++) {
+            out << (i ? ", " : "") << "{\"step\": " << i
+                << ", \"target_msg_per_sec\": " << std::setprecision(0) << schedule.rates[i]
+                << ", \"messages_published\": " << stepMessagesPublished[i] << "}";
+        }
+        out << "],\n";
+        out << "    \"timeseries\": ";
+        sampler.writeJson(out);
+        out << ",\n";
+        out << "    \"hot_path\": ";
+        hotPathSnapshot().writeJson(out);
+        out << ",\n";
+        out << "    \"memory\": ";
+        memory.writeJson(out);
+        out << ",\n";
+        out << "    \"broker_nodes\": ";
+        if (nodeProbe) {
+            nodeProbe->writeJson(out);
+        } else {
+            out << "[]";
+        }
+        out << "\n";
         out << "  }\n";
         out << "}\n";
         out.flush();
@@ -1,37 +1,632 @@
 #include "benchmark_common.h"
+#include "config.h"
+#include "latency_histogram.h"
+#include "message_header.h"
+#include "sequence_tracker.h"
+#include "cpu_affinity.h"
+#include "throughput_sampler.h"
+#include "start_barrier.h"
+#include "topic_model.h"
+#include "hot_path_stats.h"
+#include "memory_stats.h"
+#include "metrics_exporter.h"
+#include "consumer_workload.h"
+#include "spsc_ring.h"
+#include "outage_tracker.h"
+#include "rate_schedule.h"
 #include "message_broker.h"
 #include "redis_broker.h"
+#include "async_redis_broker.h"
+#include "redis_streams_broker.h"
+#include "redis_cluster_broker.h"
 #include "nats_broker.h"
+#include "jetstream_broker.h"
+#include "broker_dispatch.h"
 #include <chrono>
 #include <iomanip>
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <csignal>
 #include <cstring>
 #include <fstream> // Added for file writing
 #include <cstdlib> // Added for system calls
 #include <unistd.h>
 #include <sstream>
 #include <sys/stat.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
 
-std::atomic<uint64_t> messagesReceived(0);
-std::atomic<bool> benchmarkStarted(false);
-std::atomic<bool> benchmarkEnded_Flag(false);
-std::chrono::steady_clock::time_point startTime;
-std::chrono::steady_clock::time_point endTime;
+// Per rate-step deliveries and latency for open-loop ramps, indexed by
+// MessageHeader::rateStep and allocated on first use
+struct RateStepStats {
+    uint64_t messages = 0;
+    LatencyHistogram latency;
+};
+constexpr size_t MAX_RATE_STEPS = 64;
+
+// Deliveries outside the steady-state window (warm-up or cool-down)
+struct PhaseStats {
+    LocalCounter messages;
+    LocalCounter bytes;
+    LatencyHistogram latency;
+
+    void reset() {
+        messages.reset();
+        bytes.reset();
+        latency.reset();
+    }
+};
+
+// One logical subscriber of the multiplexed mode (SUBSCRIBER_CONNECTIONS):
+// its own connection but only a delivery counter of its own. Latency, loss
+// and phases go to the SubscriberState of the event loop delivering for it.
+// A cache line each, written only by that loop's thread (and by main
+// while collection has the loop stopped).
+struct alignas(64) LogicalSubscriber {
+    LocalCounter messagesReceived;
+    bool probe = false;  // the one per loop whose deliveries feed the sequence tracker
+    bool ended = false;  // once an END has come from every publisher process
+    int endsSeen = 0;
+};
+
+// SUBSCRIBER_RETAIN: a consumer that keeps every message until a batch of
+// ARENA_BATCH_MESSAGES is handed downstream, as a reordering buffer or a
+// batching sink would. "heap" copies each payload into its own std::string,
+// "arena" into the thread's MessageArena, rewound once the batch is handed
+// on; "none" (default) keeps nothing and looks only at the views.
+enum class RetainMode { None, Heap, Arena };
+
+struct MessageRetainer {
+    RetainMode mode = RetainMode::None;
+    size_t batchMessages = 1024;
+    std::vector<std::string> heapCopies;
+    std::vector<std::string_view> arenaCopies;
+    MessageArena arena;
+    uint64_t batches = 0;
+    uint64_t checksum = 0;  // what the simulated downstream saw, so the copies are not optimized out
+
+    static RetainMode parseMode(const std::string& name) {
+        if (name == "heap") return RetainMode::Heap;
+        if (name == "arena") return RetainMode::Arena;
+        return RetainMode::None;
+    }
+
+    static const char* modeName(RetainMode mode) {
+        switch (mode) {
+        case RetainMode::Heap: return "heap";
+        case RetainMode::Arena: return "arena";
+        default: return "none";
+        }
+    }
+
+    // Called on the receiving thread, so the batch vectors are first-touched there
+    void configure(RetainMode retainMode, size_t batch) {
+        mode = retainMode;
+        batchMessages = batch > 0 ? batch : 1;
+        if (mode == RetainMode::Heap) heapCopies.reserve(batchMessages);
+        if (mode == RetainMode::Arena) arenaCopies.reserve(batchMessages);
+    }
+
+    void keep(std::string_view payload) {
+        if (mode == RetainMode::Heap) {
+            heapCopies.emplace_back(payload);
+            if (heapCopies.size() >= batchMessages) {
+                handOff(heapCopies);
+                heapCopies.clear();
+            }
+        } else if (mode == RetainMode::Arena) {
+            arenaCopies.push_back(arena.copy(payload));
+            arena.finish();
+            if (arena.due(batchMessages)) {
+                handOff(arenaCopies);
+                arenaCopies.clear();
+                arena.reset();
+            }
+        }
+    }
+
+    // Drop what the last run left behind
+    void reset() {
+        heapCopies.clear();
+        arenaCopies.clear();
+        arena.reset();
+        batches = 0;
+    }
+
+private:
+    template <typename Batch>
+    void handOff(const Batch& batch) {
+        for (const auto& payload : batch) {
+            checksum += payload.size() + static_cast<unsigned char>(payload.back());
+        }
+        batches++;
+    }
+};
+
+// Everything one subscriber thread touches on the receive path. Each thread
+// owns one instance and one broker connection, so the hot path shares no
+// cache lines or atomics with other threads; results are merged at END.
+struct alignas(64) SubscriberState {
+    int threadId = 0;
+    ThreadLocation location;
+    LocalCounter messagesReceived;
+    LocalCounter bytesReceived;
+    LocalCounter droppedMessages;  // client-library drops, refreshed from BrokerStats
+    uint64_t droppedBase = 0;      // droppedMessages when this run started (persistent mode)
+    LocalCounter disconnects;      // subscriber connections lost, refreshed from BrokerStats
+    LocalCounter reconnects;       // and restored
+    uint64_t disconnectsBase = 0;
+    uint64_t reconnectsBase = 0;
+    OutageTracker outages;         // BROKER_RECONNECT: each drop and its recovery
+    // CONSUMER_HANDOFF ring: drops and full-ring waits are counted by the
+    // receiving thread, the high-water mark by the worker
+    LocalCounter queueDrops;
+    LocalCounter queueFullWaits;
+    LocalCounter queueHighWater;
+    uint64_t queueDropsBase = 0;
+    uint64_t queueFullWaitsBase = 0;
+    std::atomic<bool> started{false};  // release-published once START is seen
+    std::atomic<bool> ended{false};    // release-published once END is seen
+    std::atomic<bool> endSeen{false};  // at least one END seen (multiplexed: not necessarily all)
+    int endsExpected = 1;              // one END per publisher process, or per ended logical subscriber
+    int endsSeen = 0;
+    int logicalEndsExpected = 1;       // multiplexed: ENDs that end one logical subscriber
+    // Collection handshake: main makes collection odd to collect a run. Each
+    // thread writing this state acknowledges that between deliveries and then
+    // leaves the state alone, so main merges (and in persistent mode resets)
+    // it quiescent, before making collection even again.
+    std::atomic<uint32_t> collection{0};
+    std::atomic<int> collectionAcks{0};
+    int writers = 1;  // the receiving thread, plus a handoff worker
+    // Set when the client library calls the handler on threads of its own
+    // (NATS async or pool, async Redis): those deliveries hold deliveryMutex,
+    // which the receiving thread takes to acknowledge, so none is in flight.
+    bool libraryDelivery = false;
+    std::mutex deliveryMutex;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point endTime;
+    MeasurementWindow window;  // from the START marker
+    std::string batchId;       // publisher's BATCH_ID from the START marker, if sent
+    bool multiTopic = false;   // sequences are numbered per topic, keyed by the channel
+
+    // Steady state: messagesReceived/bytesReceived/latency above and below.
+    // Warm-up and cool-down are kept apart so they don't skew the headline.
+    PhaseStats warmup;
+    PhaseStats cooldown;
+
+    // End-to-end latency (publisher send timestamp -> broker receive), in ns
+    LatencyHistogram latency;
+    // Per-publisher loss / duplicate / reordering detection
+    SequenceTracker sequence;
+    std::vector<std::unique_ptr<RateStepStats>> rateSteps =
+        std::vector<std::unique_ptr<RateStepStats>>(MAX_RATE_STEPS);
+    MessageRetainer retainer;
+    ConsumerWorkload workload;
+
+    // logical is the multiplexed subscriber the message was delivered to, if any
+    void onMessage(const MessageView& message, LogicalSubscriber* logical = nullptr) {
+        if (collecting()) return;
+        MessageHeader header;
+        if (decodeHeader(message.payload, header)) {
+            outages.onMessage(message.receiveTimestampNs);
+            if (started.load(std::memory_order_relaxed) && !ended.load(std::memory_order_relaxed)) {
+                uint64_t now = message.receiveTimestampNs;
+                uint64_t nanos = now > header.sendTimestampNs ? now - header.sendTimestampNs : 0;
+                switch (window.phaseOf(header.sendTimestampNs)) {
+                case MeasurementWindow::Steady:
+                    messagesReceived.add();
+                    bytesReceived.add(message.payload.size());
+                    latency.record(nanos);
+                    break;
+                case MeasurementWindow::Warmup:
+                    record(warmup, message.payload.size(), nanos);
+                    break;
+                case MeasurementWindow::Cooldown:
+                    record(cooldown, message.payload.size(), nanos);
+                    break;
+                }
+                // Logical subscribers of one loop all see the same stream,
+                // so only one of them is checked for loss
+                if (logical != nullptr) logical->messagesReceived.add();
+                if (logical == nullptr || logical->probe) {
+                    sequence.observe(SequenceTracker::streamKey(header.publisherId,
+                                                                multiTopic ? topicIndexOf(message.channel) : 0),
+                                     header.sequence);
+                }
+
+                if (header.rateStep < MAX_RATE_STEPS) {
+                    auto& step = rateSteps[header.rateStep];
+                    if (!step) step = std::make_unique<RateStepStats>();
+                    step->messages++;
+                    step->latency.record(nanos);
+                }
+                if (retainer.mode != RetainMode::None) retainer.keep(message.payload);
+                if (workload.active()) workload.run(message.payload);
+            }
+        } else if (isStartMarker(message.payload)) {
+            // The first START of a run starts it; a later one (a pattern
+            // also matching the marker channel, or the publisher restating
+            // START with the window once it has fixed the start instant)
+            // only updates the window. Main clears started once a run is written.
+            parseStartMarker(message.payload, window, &batchId);
+            if (!started.load(std::memory_order_acquire)) {
+                startTime = std::chrono::steady_clock::now();
+                started.store(true, std::memory_order_release);
+            }
+        } else if (message.payload == "END_BENCHMARK") {
+            endSeen.store(true, std::memory_order_release);
+            // A logical subscriber counts once, when the last publisher
+            // process's END reaches it
+            if (logical != nullptr) {
+                if (logical->ended || ++logical->endsSeen < logicalEndsExpected) return;
+                logical->ended = true;
+            }
+            if (!ended.load(std::memory_order_relaxed) && ++endsSeen >= endsExpected) {
+                endTime = std::chrono::steady_clock::now();
+                ended.store(true, std::memory_order_release);
+            }
+        } else if (started.load(std::memory_order_relaxed) && !ended.load(std::memory_order_relaxed)) {
+            messagesReceived.add();
+            if (logical != nullptr) logical->messagesReceived.add();
+        }
+    }
+
+    bool collecting() const {
+        return (collection.load(std::memory_order_acquire) & 1) != 0;
+    }
+
+    // Main: stop the writers for a collection; wait for stopAcknowledged()
+    void requestStop() {
+        collectionAcks.store(0, std::memory_order_relaxed);
+        collection.fetch_add(1, std::memory_order_release);
+    }
+
+    bool stopAcknowledged() const {
+        return collectionAcks.load(std::memory_order_acquire) >= writers;
+    }
+
+    // Main, once the run is merged (and reset): record again
+    void resume() {
+        collection.fetch_add(1, std::memory_order_release);
+    }
+
+    // A writer, between deliveries: acknowledges a collection once, acked
+    // holding the last one it did. True while main is collecting.
+    bool acknowledgeCollection(uint32_t& acked) {
+        uint32_t current = collection.load(std::memory_order_acquire);
+        if ((current & 1) == 0) return false;
+        if (current != acked) {
+            std::unique_lock<std::mutex> lock(deliveryMutex, std::defer_lock);
+            if (libraryDelivery) lock.lock();
+            acked = current;
+            collectionAcks.fetch_add(1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Start over for the next run of a persistent subscriber; main calls
+    // this while the writers are stopped
+    void resetForNextRun() {
+        messagesReceived.reset();
+        bytesReceived.reset();
+        droppedBase = droppedMessages.get();
+        disconnectsBase = disconnects.get();
+        reconnectsBase = reconnects.get();
+        outages.reset();
+        queueDropsBase = queueDrops.get();
+        queueFullWaitsBase = queueFullWaits.get();
+        queueHighWater.reset();
+        warmup.reset();
+        cooldown.reset();
+        latency.reset();
+        sequence.reset();
+        for (auto& step : rateSteps) step.reset();
+        retainer.reset();
+        endsSeen = 0;
+        ended.store(false, std::memory_order_relaxed);
+        endSeen.store(false, std::memory_order_relaxed);
+        started.store(false, std::memory_order_relaxed);
+    }
+
+    uint64_t runDropped() const { return since(droppedMessages, droppedBase); }
+    uint64_t runDisconnects() const { return since(disconnects, disconnectsBase); }
+    uint64_t runReconnects() const { return since(reconnects, reconnectsBase); }
+    uint64_t runQueueDrops() const { return since(queueDrops, queueDropsBase); }
+    uint64_t runQueueFullWaits() const { return since(queueFullWaits, queueFullWaitsBase); }
+
+    // A cumulative counter's growth since base
+    static uint64_t since(const LocalCounter& counter, uint64_t base) {
+        uint64_t value = counter.get();
+        return value > base ? value - base : 0;
+    }
+
+    static void record(PhaseStats& phase, size_t bytes, uint64_t nanos) {
+        phase.messages.add();
+        phase.bytes.add(bytes);
+        phase.latency.record(nanos);
+    }
+
+    // Everything delivered during the run, whatever the phase
+    uint64_t totalMessages() const {
+        return messagesReceived.get() + warmup.messages.get() + cooldown.messages.get();
+    }
+    uint64_t totalBytes() const {
+        return bytesReceived.get() + warmup.bytes.get() + cooldown.bytes.get();
+    }
+};
+
+// CONSUMER_HANDOFF=1: the receiving thread only copies each message into a
+// bounded SPSC ring of CONSUMER_QUEUE_SIZE slots, and a worker thread of its
+// own runs SubscriberState::onMessage (and the CONSUMER_WORK) on it, as an
+// application that keeps its I/O thread free would. The state keeps a single
+// writer, the worker; latency is taken when the worker picks a message up,
+// so time spent queued counts. On a full ring the receiver waits
+// (CONSUMER_QUEUE_FULL=block), which backs up into the socket or the client
+// library's queue, or drops the message and counts it (drop). START and END
+// markers always wait.
+struct HandoffSlot {
+    std::string channel;
+    std::string payload;
+    LogicalSubscriber* logical = nullptr;
+};
+
+class ConsumerHandoff {
+public:
+    // sharedProducer: more than one thread pushes (nats.c async delivery
+    // runs a thread per subscription), so pushes are serialized with a lock.
+    // The worker is placed as subscriber thread workerIndex.
+    ConsumerHandoff(SubscriberState& s, size_t capacity, bool dropFull, bool shared,
+                    const ThreadPlacement& placement, int workerIndex)
+        : state(s), ring(capacity), dropWhenFull(dropFull), sharedProducer(shared),
+          worker([this, &placement, workerIndex] {
+              placement.apply(workerIndex);
+              drain();
+          }) {}
+
+    ~ConsumerHandoff() {
+        stopping.store(true, std::memory_order_relaxed);
+        worker.join();
+    }
+
+    void push(const MessageView& message, LogicalSubscriber* logical = nullptr) {
+        std::unique_lock<std::mutex> lock(producerMutex, std::defer_lock);
+        if (sharedProducer) lock.lock();
+        auto fill = [&](HandoffSlot& slot) {
+            slot.channel.assign(message.channel);
+            slot.payload.assign(message.payload);
+            slot.logical = logical;
+        };
+        if (ring.tryPush(fill)) return;
+        bool marker = isStartMarker(message.payload) || message.payload == "END_BENCHMARK";
+        if (dropWhenFull && !marker) {
+            state.queueDrops.add();
+            return;
+        }
+        state.queueFullWaits.add();
+        while (!ring.tryPush(fill)) cpuRelax();
+    }
+
+    size_t capacity() const { return ring.capacity(); }
+
+private:
+    SubscriberState& state;
+    SpscRing<HandoffSlot> ring;
+    bool dropWhenFull;
+    bool sharedProducer;
+    std::mutex producerMutex;
+    std::atomic<bool> stopping{false};
+    std::thread worker;  // last: starts draining once everything above is built
+
+    void drain() {
+        auto consume = [this](HandoffSlot& slot) {
+            MessageView view;
+            view.channel = slot.channel;
+            view.payload = slot.payload;
+            view.receiveTimestampNs = wallClockNs();
+            state.onMessage(view, slot.logical);
+        };
+        uint64_t popped = 0;
+        unsigned idle = 0;
+        uint32_t acked = 0;
+        while (!stopping.load(std::memory_order_relaxed)) {
+            // While main collects, messages are still popped but not recorded
+            bool collecting = state.acknowledgeCollection(acked);
+            if (ring.tryPop(consume)) {
+                idle = 0;
+                // Sampled: reading the producer's index every message would
+                // bounce its cache line
+                if ((++popped & 63) == 0 && !collecting) {
+                    uint64_t depth = ring.size();
+                    if (depth > state.queueHighWater.get()) state.queueHighWater.set(depth);
+                }
+                continue;
+            }
+            if (++idle < 4096) {
+                cpuRelax();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+// Merged warm-up or cool-down totals
+struct PhaseTotals {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    std::unique_ptr<LatencyHistogram> latency = std::make_unique<LatencyHistogram>();
+
+    void add(const PhaseStats& phase) {
+        messages += phase.messages.get();
+        bytes += phase.bytes.get();
+        latency->merge(phase.latency);
+    }
+};
+
+// Process-wide view built from every thread's state once the run has ended
+struct MergedResults {
+    uint64_t messagesReceived = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t droppedMessages = 0;
+    uint64_t disconnects = 0;
+    uint64_t reconnects = 0;
+    std::vector<std::pair<int, Outage>> outages;  // (thread, outage), in thread order
+    uint64_t queueDrops = 0;       // CONSUMER_HANDOFF only
+    uint64_t queueFullWaits = 0;
+    uint64_t queueHighWater = 0;   // deepest ring of any thread
+    std::string deliveryMode;
+    std::string batchId;        // from START; empty means BATCH_ID from the environment
+    std::string topics;         // TopicModel::describe()
+    std::string subscriptions;  // SubscriptionPlan::describe()
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point endTime;
+    MeasurementWindow window;
+    PhaseTotals warmup;
+    PhaseTotals cooldown;
+    std::unique_ptr<LatencyHistogram> latency = std::make_unique<LatencyHistogram>();
+    SequenceTracker::Summary sequence;
+    std::vector<std::unique_ptr<RateStepStats>> rateSteps =
+        std::vector<std::unique_ptr<RateStepStats>>(MAX_RATE_STEPS);
+    std::vector<const SubscriberState*> threads;
+    const ThreadPlacement* placement = nullptr;
+    std::vector<ThreadLocation> locations;  // every thread, started or not
+    const ThroughputSampler* timeseries = nullptr;
+    AllocationCounts allocationsAtStart;  // when the run started
+    const LogicalSubscriber* logical = nullptr;  // multiplexed mode only
+    size_t numLogical = 0;
+    uint64_t retainedBatches = 0;
+    size_t arenaCapacity = 0;  // retain arenas, summed over threads
+    size_t arenaPeak = 0;
+    size_t arenaSlabs = 0;
+};
+
+// How evenly deliveries were spread over the logical subscribers
+struct FairnessStats {
+    uint64_t min = 0;
+    uint64_t median = 0;
+    uint64_t max = 0;
+    double mean = 0;
+
+    static FairnessStats of(const LogicalSubscriber* logical, size_t count) {
+        FairnessStats stats;
+        if (count == 0) return stats;
+        std::vector<uint64_t> received(count);
+        for (size_t i = 0; i < count; i++) received[i] = logical[i].messagesReceived.get();
+        std::sort(received.begin(), received.end());
+        stats.min = received.front();
+        stats.median = received[count / 2];
+        stats.max = received.back();
+        uint64_t total = 0;
+        for (uint64_t n : received) total += n;
+        stats.mean = static_cast<double>(total) / count;
+        return stats;
+    }
+};
 
 // Global broker type for results writing
 std::string g_brokerType;
+// NATS_DELIVERY_MODE as applied, see natsDeliveryFor()
+std::string g_natsDelivery = "async";
+// NODE_NAME, the machine in per-node reports (default: the hostname)
+std::string g_nodeName;
+// Publisher processes in the run; each sends its own END_BENCHMARK
+int g_publisherProcesses = 1;
+// SUBSCRIBER_RETAIN and its batch (ARENA_BATCH_MESSAGES), applied to every thread's state
+RetainMode g_retainMode = RetainMode::None;
+size_t g_arenaBatch = 1024;
+// CONSUMER_WORK, copied into every thread's state, and CONSUMER_HANDOFF's
+// ring size per thread (0 = work on the receiving thread) and full policy
+ConsumerWorkload g_workload;
+size_t g_handoffQueue = 0;
+bool g_handoffDropWhenFull = false;
 
 // Forward declaration
-void writeResults(const char* subscriberId);
+void writeResults(const char* subscriberId, const MergedResults& results);
 
-std::unique_ptr<MessageBroker> createBroker(const std::string& brokerType) {
-    if (brokerType == "redis") {
-        return std::make_unique<RedisBroker>(
+std::unique_ptr<MessageBroker> createBroker(const std::string& brokerType, const Config& config) {
+    if (brokerType == "redis" && config.get("REDIS_CLIENT", "sync") == "async") {
+        // Every async broker of the process shares the event loop group
+        RedisEventLoop::setSharedLoopCount(config.getInt("REDIS_ASYNC_LOOP_THREADS", 1));
+        auto broker = std::make_unique<AsyncRedisBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+        broker->setConnectionOptions(config.getInt("REDIS_ASYNC_CONNECTIONS", 1),
+                                     config.getInt("REDIS_ASYNC_MAX_INFLIGHT", 1000));
+        return broker;
+    } else if (brokerType == "redis") {
+        auto broker = std::make_unique<RedisBroker>(
             std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
             std::getenv("REDIS_PORT") ? std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379 : 6379
         );
+        broker->setRawSubscriberReader(config.get("REDIS_SUBSCRIBER_READER", "raw") != "hiredis");
+        if (config.getInt("REDIS_REPLY_ARENA", 0) != 0) broker->setReplyArena(g_arenaBatch);
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
+    } else if (brokerType == "redis-cluster") {
+        return std::make_unique<RedisClusterBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+    } else if (brokerType == "redis-streams") {
+        auto broker = std::make_unique<RedisStreamsBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+        broker->setStreamOptions(0,
+                                 config.getInt("REDIS_STREAMS_READ_COUNT", 100),
+                                 config.getInt("REDIS_STREAMS_BLOCK_MS", 100),
+                                 config.get("REDIS_STREAMS_GROUP", ""));
+        if (config.getInt("REDIS_REPLY_ARENA", 0) != 0) broker->setReplyArena(g_arenaBatch);
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
     } else if (brokerType == "nats") {
+        auto broker = std::make_unique<NatsBroker>(
+            std::getenv("NATS_URL") ? std::getenv("NATS_URL") : "nats://localhost:4222"
+        );
+        broker->setDeliveryOptions(NatsBroker::parseDeliveryMode(g_natsDelivery),
+                                   config.getInt("NATS_DELIVERY_POOL_SIZE", 1),
+                                   config.getInt("NATS_PENDING_MSGS_LIMIT", 0),
+                                   config.getInt("NATS_PENDING_BYTES_LIMIT", 0));
+        broker->setServerIndex(NatsBroker::nextServerIndex());
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
+    } else if (brokerType == "jetstream") {
+        auto broker = std::make_unique<JetStreamBroker>(
+            std::getenv("NATS_URL") ? std::getenv("NATS_URL") : "nats://localhost:4222"
+        );
+        broker->setStreamOptions(config.get("JETSTREAM_STREAM", "BENCHMARK"),
+                                 config.get("JETSTREAM_STORAGE", "file"),
+                                 config.getInt("JETSTREAM_REPLICAS", 1),
+                                 config.getInt("JETSTREAM_MAX_MSGS", 0));
+        if (config.getInt("NUM_TOPICS", 1) > 1) {
+            // One stream for the marker channel and every topic
+            broker->setStreamSubjects({ TopicModel::MARKER_CHANNEL,
+                                        std::string(TopicModel::MARKER_CHANNEL) + ".>" });
+        }
+        broker->setFetchOptions(config.getInt("JETSTREAM_FETCH_BATCH", 100),
+                                JetStreamBroker::parseAckMode(config.get("JETSTREAM_ACK_POLICY", "explicit")));
+        broker->setReconnect(config.getInt("BROKER_RECONNECT", 1) != 0,
+                             config.getInt("BROKER_RECONNECT_INTERVAL_MS", 500));
+        return broker;
+    }
+    return nullptr;
+}
+
+// Plain pub/sub connection for the readiness handshake (see start_barrier.h)
+std::unique_ptr<MessageBroker> createControlBroker(const std::string& brokerType) {
+    // Plain PUBLISH reaches every node of a Redis cluster, so the seed node will do
+    if (brokerType == "redis" || brokerType == "redis-streams" || brokerType == "redis-cluster") {
+        return std::make_unique<RedisBroker>(
+            std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost",
+            std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379
+        );
+    } else if (brokerType == "nats" || brokerType == "jetstream") {
         return std::make_unique<NatsBroker>(
             std::getenv("NATS_URL") ? std::getenv("NATS_URL") : "nats://localhost:4222"
         );
@@ -39,22 +634,347 @@ std::unique_ptr<MessageBroker> createBroker(const std::string& brokerType) {
     return nullptr;
 }
 
-void messageCallback(const std::string& message) {
-    if (message == "START_BENCHMARK") {
-        benchmarkStarted = true;
-        startTime = std::chrono::steady_clock::now();
-    } else if (message == "END_BENCHMARK") {
-        if (!benchmarkEnded_Flag) {
-            endTime = std::chrono::steady_clock::now();
-            benchmarkEnded_Flag = true;
+// Whether the client library calls message handlers on threads of its own
+// rather than from processMessages() on the receiving thread
+bool deliversOnLibraryThreads(const std::string& brokerType, const Config& config) {
+    if (brokerType == "nats") return g_natsDelivery != "sync";
+    return brokerType == "redis" && config.get("REDIS_CLIENT", "sync") == "async";
+}
+
+// How this process receives messages, recorded so runs can be compared
+std::string describeDeliveryMode(const std::string& brokerType, const Config& config) {
+    if (brokerType == "nats") return g_natsDelivery;
+    if (brokerType == "redis") return config.get("REDIS_SUBSCRIBER_READER", "raw");
+    if (brokerType == "redis-cluster") return "sharded";
+    if (brokerType == "jetstream") {
+        return "fetch batch=" + std::to_string(config.getInt("JETSTREAM_FETCH_BATCH", 100)) +
+               " ack=" + config.get("JETSTREAM_ACK_POLICY", "explicit");
+    }
+    if (brokerType == "redis-streams") {
+        return "xreadgroup count=" + std::to_string(config.getInt("REDIS_STREAMS_READ_COUNT", 100)) +
+               " block=" + std::to_string(config.getInt("REDIS_STREAMS_BLOCK_MS", 100)) + "ms";
+    }
+    return "default";
+}
+
+// Channels every subscriber thread subscribes to: the marker channel, plus
+// its topics as exact subscriptions or a single pattern
+struct SubscriptionPlan {
+    bool pattern = false;
+    bool multiTopic = false;
+    std::vector<std::string> channels;  // exact topics, or the one pattern
+
+    // SUBSCRIBE_MODE=exact|pattern, SUBSCRIBE_TOPICS=K (the K most popular
+    // topics, 0 = all), SUBSCRIBE_PATTERN (default "benchmark_channel.*")
+    static SubscriptionPlan fromConfig(const TopicModel& topics, const Config& config) {
+        SubscriptionPlan plan;
+        plan.multiTopic = topics.isMultiTopic();
+        if (!plan.multiTopic) return plan;
+        plan.pattern = (config.get("SUBSCRIBE_MODE", "exact") == "pattern");
+        if (plan.pattern) {
+            std::string pattern = config.get("SUBSCRIBE_PATTERN");
+            plan.channels.push_back(pattern.empty() ? TopicModel::defaultPattern() : pattern);
+            return plan;
         }
-    } else if (benchmarkStarted && !benchmarkEnded_Flag) {
-        messagesReceived++;
+        size_t count = static_cast<size_t>(std::max(config.getInt("SUBSCRIBE_TOPICS", 0), 0));
+        if (count == 0 || count > topics.size()) count = topics.size();
+        plan.channels.assign(topics.names.begin(), topics.names.begin() + count);
+        return plan;
     }
+
+    std::string describe() const {
+        if (!multiTopic) return TopicModel::MARKER_CHANNEL;
+        if (pattern) return "pattern " + channels.front();
+        return std::to_string(channels.size()) + " exact topic subscription(s)";
+    }
+};
+
+// NATS_DELIVERY_MODE for a plan. Every subscription of a thread delivers
+// into its one SubscriberState, which has a single writer. Async delivery
+// runs each subscription on a thread of its own, and a pool of more than
+// one thread shares them out, so with the marker plus topic or pattern
+// subscriptions several threads would record at once. Such plans poll
+// their subscriptions from the receiving thread instead (sync).
+std::string natsDeliveryFor(const Config& config, const SubscriptionPlan& plan) {
+    std::string mode = config.get("NATS_DELIVERY_MODE", "async");
+    if (!plan.multiTopic || mode == "sync") return mode;
+    if (mode == "pool" && config.getInt("NATS_DELIVERY_POOL_SIZE", 1) <= 1) return mode;
+    return "sync";
+}
+
+// Subscribe and receive, instantiated once per broker class by
+// withConcreteBroker(). RedisBroker and NatsBroker hand each message straight
+// to handler, a concrete callable; the others go through MessageHandler.
+template <typename Broker, typename Handler>
+void runSubscriber(Broker& broker, Handler& handler, const SubscriptionPlan& plan, SubscriberState& state,
+                   std::atomic<int>& readyThreads, std::atomic<int>& failedThreads) {
+    auto subscribeTo = [&](const std::string& channel, bool pattern) {
+        if constexpr (std::is_same_v<Broker, NatsBroker>) {
+            return broker.subscribeDirect(channel, handler);  // subjects take wildcards as they are
+        } else {
+            MessageHandler wrapped = handler;
+            return pattern ? broker.subscribePattern(channel, std::move(wrapped))
+                           : broker.subscribe(channel, std::move(wrapped));
+        }
+    };
+    bool subscribed = subscribeTo(TopicModel::MARKER_CHANNEL, false);
+    for (size_t i = 0; subscribed && i < plan.channels.size(); i++) {
+        subscribed = subscribeTo(plan.channels[i], plan.pattern);
+    }
+    if (!subscribed) {
+        std::cerr << "❌ Thread " << state.threadId << " subscription error" << std::endl;
+        failedThreads++;
+        return;
+    }
+    readyThreads++;
+
+    // Run continuously; the main thread collects results when END arrives
+    uint32_t acked = 0;
+    while (true) {
+        if constexpr (std::is_same_v<Broker, RedisBroker>) {
+            broker.processMessagesDirect(100, handler);
+        } else {
+            broker.processMessages(100);
+        }
+        if (state.acknowledgeCollection(acked)) continue;
+        BrokerStats stats = broker.getStats();
+        state.droppedMessages.set(stats.droppedMessages);
+        state.disconnects.set(stats.disconnects);
+        state.reconnects.set(stats.reconnects);
+        state.outages.update(stats, state.sequence.liveLost());
+    }
+}
+
+// One subscriber thread: its own connection, subscription and state.
+// The state is created here, after pinning, so its pages are first touched
+// on this thread's NUMA node; readyThreads/failedThreads publish it to main.
+void subscriberThread(std::unique_ptr<SubscriberState>& slot,
+                      int threadId,
+                      const std::string& brokerType,
+                      const Config& config,
+                      const SubscriptionPlan& plan,
+                      const ThreadPlacement& placement,
+                      int numThreads,
+                      std::atomic<int>& readyThreads,
+                      std::atomic<int>& failedThreads) {
+    ThreadLocation location = placement.apply(threadId);
+    slot = std::make_unique<SubscriberState>();
+    SubscriberState& state = *slot;
+    state.threadId = threadId;
+    state.location = location;
+    state.endsExpected = g_publisherProcesses;
+    state.retainer.configure(g_retainMode, g_arenaBatch);
+    state.workload = g_workload;
+
+    auto broker = createBroker(brokerType, config);
+    if (!broker || !broker->connect()) {
+        std::cerr << "❌ Thread " << state.threadId << " connection error" << std::endl;
+        failedThreads++;
+        return;
+    }
+
+    state.multiTopic = plan.multiTopic;
+    if (g_handoffQueue > 0) {
+        bool sharedProducer = brokerType == "nats" && g_natsDelivery != "sync";
+        state.writers = 2;  // the handoff worker records, the receiving thread refreshes stats
+        ConsumerHandoff handoff(state, g_handoffQueue, g_handoffDropWhenFull, sharedProducer,
+                                placement, numThreads + threadId);
+        auto handler = [&handoff](const MessageView& message) { handoff.push(message); };
+        withConcreteBroker(*broker, [&](auto& concrete) {
+            runSubscriber(concrete, handler, plan, state, readyThreads, failedThreads);
+        });
+        broker->disconnect();  // no deliveries into the handoff once it is gone
+        return;
+    }
+    state.libraryDelivery = deliversOnLibraryThreads(brokerType, config);
+    auto handler = [&state](const MessageView& message) {
+        std::unique_lock<std::mutex> lock(state.deliveryMutex, std::defer_lock);
+        if (state.libraryDelivery) lock.lock();
+        state.onMessage(message);
+    };
+    withConcreteBroker(*broker, [&](auto& concrete) {
+        runSubscriber(concrete, handler, plan, state, readyThreads, failedThreads);
+    });
+}
+
+// Multiplexed mode: thread threadId opens logical subscribers threadId,
+// threadId + numThreads, ... one connection each, all on event loop threadId.
+// That loop's single thread then delivers for every one of them into one
+// SubscriberState, so the receive path stays single-writer.
+void multiplexedSubscriberThread(std::unique_ptr<SubscriberState>& slot,
+                                 int threadId,
+                                 int numThreads,
+                                 const SubscriptionPlan& plan,
+                                 const ThreadPlacement& placement,
+                                 LogicalSubscriber* logical,
+                                 int numLogical,
+                                 std::atomic<int>& readyThreads,
+                                 std::atomic<int>& failedThreads) {
+    RedisEventLoop& loop = RedisEventLoop::shared(threadId);
+    // The loop thread does the receiving: pin it, and first-touch the state there
+    ThreadLocation location;
+    loop.run([&] {
+        location = placement.apply(threadId);
+        slot = std::make_unique<SubscriberState>();
+        slot->retainer.configure(g_retainMode, g_arenaBatch);
+    });
+    SubscriberState& state = *slot;
+    state.threadId = threadId;
+    state.location = location;
+    state.multiTopic = plan.multiTopic;
+    state.workload = g_workload;
+    std::unique_ptr<ConsumerHandoff> handoff;
+    if (g_handoffQueue > 0) {
+        handoff = std::make_unique<ConsumerHandoff>(state, g_handoffQueue, g_handoffDropWhenFull, false,
+                                                    placement, numThreads + threadId);
+        state.writers = 2;
+    }
+
+    std::string host = std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost";
+    int port = std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379;
+    std::vector<std::unique_ptr<AsyncRedisBroker>> brokers;
+    for (int i = threadId; i < numLogical; i += numThreads) {
+        LogicalSubscriber& subscriber = logical[i];
+        subscriber.probe = brokers.empty();
+        auto broker = std::make_unique<AsyncRedisBroker>(host, port, loop);
+        broker->setConnectionOptions(0, 1);  // subscribe only: one socket per logical subscriber
+        MessageHandler handler = [&state, &subscriber, &handoff](const MessageView& message) {
+            if (handoff) {
+                handoff->push(message, &subscriber);
+            } else {
+                state.onMessage(message, &subscriber);
+            }
+        };
+        bool subscribed = broker->connect() && broker->subscribe(TopicModel::MARKER_CHANNEL, handler);
+        for (size_t c = 0; subscribed && c < plan.channels.size(); c++) {
+            subscribed = plan.pattern ? broker->subscribePattern(plan.channels[c], handler)
+                                      : broker->subscribe(plan.channels[c], handler);
+        }
+        if (!subscribed) {
+            std::cerr << "❌ Logical subscriber " << i << " failed to connect or subscribe"
+                      << " (check ulimit -n and Redis maxclients)" << std::endl;
+            failedThreads++;
+            return;
+        }
+        brokers.push_back(std::move(broker));
+    }
+    int expected = static_cast<int>(brokers.size());
+    loop.run([&] {
+        state.endsExpected = expected;
+        state.logicalEndsExpected = g_publisherProcesses;
+    });
+    readyThreads++;
+
+    // The brokers must stay alive; delivery happens on the loop thread,
+    // which acknowledges collections between its callbacks
+    uint32_t acked = 0;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (state.collecting()) loop.run([&] { state.acknowledgeCollection(acked); });
+    }
+}
+
+MergedResults mergeResults(const std::vector<std::unique_ptr<SubscriberState>>& states) {
+    MergedResults merged;
+    bool first = true;
+    for (const auto& state : states) {
+        merged.locations.push_back(state->location);
+        if (!state->started.load(std::memory_order_acquire)) continue;
+        merged.threads.push_back(state.get());
+        merged.messagesReceived += state->messagesReceived.get();
+        merged.bytesReceived += state->bytesReceived.get();
+        merged.droppedMessages += state->runDropped();
+        merged.disconnects += state->runDisconnects();
+        merged.reconnects += state->runReconnects();
+        for (const Outage& outage : state->outages.outages()) merged.outages.emplace_back(state->threadId, outage);
+        merged.queueDrops += state->runQueueDrops();
+        merged.queueFullWaits += state->runQueueFullWaits();
+        merged.queueHighWater = std::max(merged.queueHighWater, state->queueHighWater.get());
+        if (merged.batchId.empty()) merged.batchId = state->batchId;
+        merged.latency->merge(state->latency);
+        merged.warmup.add(state->warmup);
+        merged.cooldown.add(state->cooldown);
+        merged.window = state->window;  // same START marker for every thread
+        merged.sequence.add(state->sequence.summary());
+        merged.retainedBatches += state->retainer.batches;
+        merged.arenaCapacity += state->retainer.arena.capacity();
+        merged.arenaPeak += state->retainer.arena.peak();
+        merged.arenaSlabs += state->retainer.arena.slabCount();
+        for (size_t i = 0; i < MAX_RATE_STEPS; i++) {
+            if (!state->rateSteps[i]) continue;
+            if (!merged.rateSteps[i]) merged.rateSteps[i] = std::make_unique<RateStepStats>();
+            merged.rateSteps[i]->messages += state->rateSteps[i]->messages;
+            merged.rateSteps[i]->latency.merge(state->rateSteps[i]->latency);
+        }
+
+        // Threads that never saw END are cut off at the collection time
+        auto threadEnd = state->ended.load(std::memory_order_acquire)
+            ? state->endTime : std::chrono::steady_clock::now();
+        if (first || state->startTime < merged.startTime) merged.startTime = state->startTime;
+        if (first || threadEnd > merged.endTime) merged.endTime = threadEnd;
+        first = false;
+    }
+    return merged;
+}
+
+// One scrape of METRICS_PORT while the run goes on. Reads the same relaxed
+// counters as the sampler plus the live histogram buckets; per-run values
+// start over on every START, which Prometheus treats as a counter reset.
+void writeLiveMetrics(PrometheusWriter& metrics, const std::vector<std::unique_ptr<SubscriberState>>& states) {
+    uint64_t steady = 0, warmup = 0, cooldown = 0, bytes = 0;
+    uint64_t dropped = 0, queueDrops = 0, disconnects = 0, reconnects = 0, lost = 0, duplicates = 0;
+    int active = 0;
+    auto latency = std::make_unique<LatencyHistogram>();
+    for (const auto& state : states) {
+        steady += state->messagesReceived.get();
+        warmup += state->warmup.messages.get();
+        cooldown += state->cooldown.messages.get();
+        bytes += state->totalBytes();
+        dropped += state->droppedMessages.get();
+        queueDrops += state->queueDrops.get();
+        disconnects += state->disconnects.get();
+        reconnects += state->reconnects.get();
+        lost += state->sequence.liveLost();
+        duplicates += state->sequence.liveDuplicates();
+        latency->merge(state->latency);
+        if (state->started.load(std::memory_order_acquire) && !state->ended.load(std::memory_order_acquire)) active++;
+    }
+
+    metrics.header("fanout_messages_received_total", "Benchmark messages received this run, by phase", "counter");
+    metrics.sample("fanout_messages_received_total", "phase=\"warmup\"", warmup);
+    metrics.sample("fanout_messages_received_total", "phase=\"steady\"", steady);
+    metrics.sample("fanout_messages_received_total", "phase=\"cooldown\"", cooldown);
+    metrics.header("fanout_thread_messages_received_total", "Messages received this run, per subscriber thread",
+                   "counter");
+    for (const auto& state : states) {
+        metrics.sample("fanout_thread_messages_received_total",
+                       "thread=\"" + std::to_string(state->threadId) + "\"", state->totalMessages());
+    }
+    metrics.counter("fanout_bytes_received_total", "Payload bytes received this run", bytes);
+    metrics.latencyHistogram("fanout_latency_seconds", "End-to-end latency of steady-state messages this run",
+                             *latency);
+    metrics.gauge("fanout_sequence_lost_messages", "Messages missing from the sequence this run", lost);
+    metrics.counter("fanout_sequence_duplicates_total", "Duplicate messages this run", duplicates);
+    metrics.counter("fanout_client_dropped_messages_total", "Messages dropped by the client library", dropped);
+    metrics.counter("fanout_handoff_dropped_messages_total", "Messages dropped on a full CONSUMER_HANDOFF ring",
+                    queueDrops);
+    metrics.counter("fanout_broker_disconnects_total", "Subscriber connections lost", disconnects);
+    metrics.counter("fanout_broker_reconnects_total", "Subscriber connections restored", reconnects);
+    metrics.gauge("fanout_threads_running", "Subscriber threads between START and END", active);
+    metrics.gauge("fanout_resident_memory_bytes", "Resident set size", currentRssBytes());
 }
 
 int main() {
+    // A broker that goes away mid-run must show up as a failed write the
+    // reconnect logic can handle, not as a SIGPIPE that kills the process
+    std::signal(SIGPIPE, SIG_IGN);
+    Config config;
     const char* subscriberId = std::getenv("SUBSCRIBER_ID") ? std::getenv("SUBSCRIBER_ID") : "subscriber_1";
+    int numThreads = std::max(1, config.getInt("NUM_SUBSCRIBER_THREADS", 1));
+    // SUBSCRIBER_CONNECTIONS=M > 0: M logical subscribers, one connection
+    // each, multiplexed over NUM_SUBSCRIBER_THREADS event loop threads
+    int numLogical = std::max(0, config.getInt("SUBSCRIBER_CONNECTIONS", 0));
+    bool multiplexed = numLogical > 0;
     
     // Determine broker type from environment variable
     g_brokerType = "redis";
@@ -62,53 +982,255 @@ int main() {
         g_brokerType = std::getenv("BROKER_TYPE");
     }
     std::string brokerType = g_brokerType;
+    g_nodeName = config.get("NODE_NAME");
+    g_publisherProcesses = std::max(1, config.getInt("PUBLISHER_PROCESSES", 1));
+    g_retainMode = MessageRetainer::parseMode(config.get("SUBSCRIBER_RETAIN", "none"));
+    g_arenaBatch = static_cast<size_t>(std::max(1, config.getInt("ARENA_BATCH_MESSAGES", 1024)));
+    g_workload = ConsumerWorkload::fromSettings(
+        config.get("CONSUMER_WORK", "none"),
+        static_cast<uint64_t>(std::max(0, config.getInt("CONSUMER_WORK_NS", 1000))),
+        config.getInt("CONSUMER_HASH_PASSES", 1),
+        static_cast<uint64_t>(std::max(1, config.getInt("CONSUMER_SLEEP_EVERY", 1000))),
+        static_cast<uint64_t>(std::max(0, config.getInt("CONSUMER_SLEEP_US", 1000))));
+    if (config.getInt("CONSUMER_HANDOFF", 0) != 0) {
+        g_handoffQueue = static_cast<size_t>(std::max(1, config.getInt("CONSUMER_QUEUE_SIZE", 4096)));
+    }
+    g_handoffDropWhenFull = config.get("CONSUMER_QUEUE_FULL", "block") == "drop";
+    if (multiplexed) {
+        if (brokerType != "redis") {
+            std::cerr << "❌ SUBSCRIBER_CONNECTIONS is only supported with BROKER_TYPE=redis" << std::endl;
+            return 1;
+        }
+        // Size the loop group before any async broker picks a loop from it
+        numThreads = std::min(numThreads, numLogical);
+        RedisEventLoop::setSharedLoopCount(numThreads);
+        RedisEventLoop::sharedSize();
+    }
     
-    auto broker = createBroker(brokerType);
-    if (!broker) {
+    auto testBroker = createBroker(brokerType, config);
+    if (!testBroker) {
         std::cerr << "❌ Unknown broker type: " << brokerType << std::endl;
         return 1;
     }
 
-    // Connect to broker
-    if (!broker->connect()) {
-        std::cerr << "❌ Connection error to " << broker->getName() << std::endl;
-        return 1;
+    // Optional CPU pinning / NUMA policy for the subscriber threads
+    ThreadPlacement placement = ThreadPlacement::fromConfig(config.get("SUBSCRIBER_CPUS"),
+                                                            config.get("NUMA_POLICY", "none"));
+    std::cerr << "✓ Thread placement: " << placement.describe() << std::endl;
+    if (g_retainMode != RetainMode::None) {
+        std::cerr << "✓ Retaining messages (" << MessageRetainer::modeName(g_retainMode) << "), handed on in batches of "
+                  << g_arenaBatch << std::endl;
+    }
+    if (g_workload.active() || g_handoffQueue > 0) {
+        std::cerr << "✓ Consumer work: " << g_workload.describe();
+        if (g_handoffQueue > 0) {
+            std::cerr << ", handed to a worker thread per subscriber thread through a " << g_handoffQueue
+                      << "-slot ring (" << (g_handoffDropWhenFull ? "drop" : "block") << " when full)";
+        }
+        std::cerr << std::endl;
+    }
+
+    TopicModel topics = TopicModel::fromConfig(config.getInt("NUM_TOPICS", 1),
+                                               config.get("TOPIC_DISTRIBUTION", "uniform"),
+                                               std::atof(config.get("TOPIC_ZIPF_EXPONENT", "1.0").c_str()));
+    SubscriptionPlan plan = SubscriptionPlan::fromConfig(topics, config);
+    g_natsDelivery = natsDeliveryFor(config, plan);
+    if (g_brokerType == "nats" && g_natsDelivery != config.get("NATS_DELIVERY_MODE", "async")) {
+        std::cerr << "⚠️  NATS_DELIVERY_MODE=" << config.get("NATS_DELIVERY_MODE", "async")
+                  << " would deliver " << plan.describe() << " on several threads at once; using sync" << std::endl;
+    }
+
+    // Launch subscriber threads - each creates its own connection and state
+    std::vector<std::unique_ptr<SubscriberState>> states(numThreads);
+    std::atomic<int> readyThreads{0};
+    std::atomic<int> failedThreads{0};
+    std::vector<std::thread> threads;
+    std::unique_ptr<LogicalSubscriber[]> logical;
+    if (multiplexed) {
+        logical = std::make_unique<LogicalSubscriber[]>(numLogical);
+        for (int i = 0; i < numThreads; i++) {
+            threads.emplace_back(multiplexedSubscriberThread, std::ref(states[i]), i, numThreads,
+                                 std::cref(plan), std::cref(placement), logical.get(), numLogical,
+                                 std::ref(readyThreads), std::ref(failedThreads));
+        }
+    } else {
+        for (int i = 0; i < numThreads; i++) {
+            threads.emplace_back(subscriberThread, std::ref(states[i]), i, brokerType, std::cref(config),
+                                 std::cref(plan), std::cref(placement), numThreads,
+                                 std::ref(readyThreads), std::ref(failedThreads));
+        }
     }
-    std::cerr << "✓ Connected to " << broker->getName() << std::endl;
 
-    // Subscribe to channel
-    if (!broker->subscribe("benchmark_channel", messageCallback)) {
-        std::cerr << "❌ Subscription error" << std::endl;
+    while (readyThreads + failedThreads < numThreads) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (failedThreads > 0) {
+        std::cerr << "❌ " << failedThreads << " of " << numThreads << " subscriber threads failed to start" << std::endl;
         return 1;
     }
-    std::cerr << "✓ Subscribed to benchmark_channel" << std::endl;
+    std::cerr << "✓ Connected to " << testBroker->getName() << " with " << numThreads << " subscriber thread(s)" << std::endl;
+    if (multiplexed) {
+        std::cerr << "✓ Multiplexing " << numLogical << " logical subscribers (one connection each) over "
+                  << numThreads << " event loop thread(s)" << std::endl;
+    }
+    std::cerr << "✓ Subscribed to " << plan.describe() << " (" << topics.describe() << ")" << std::endl;
     std::cerr << "✓ Subscriber ready - waiting for messages (will run until stopped)" << std::endl;
 
-    // Run continuously - process messages and write results when benchmark ends
+    // Samples the threads' counters from now on; sized for a long wait
+    // before START plus the run itself
+    int sampleIntervalMs = std::max(config.getInt("SAMPLE_INTERVAL_MS", 100), 1);
+    ThroughputSampler sampler(sampleIntervalMs,
+                              static_cast<size_t>(config.getInt("PUBLISH_DURATION_SECONDS", 60) + 300) * 1000 / sampleIntervalMs);
+    sampler.start([&states] {
+        CounterSnapshot snapshot;
+        for (const auto& state : states) {
+            snapshot.messages += state->totalMessages();
+            snapshot.bytes += state->totalBytes();
+            snapshot.dropped += state->droppedMessages.get() + state->queueDrops.get();
+        }
+        return snapshot;
+    });
+
+    // METRICS_PORT > 0: Prometheus text on http://<container>:<port>/metrics
+    // for the whole life of the process
+    MetricsExporter exporter;
+    int metricsPort = config.getInt("METRICS_PORT", 0);
+    if (metricsPort > 0) {
+        std::string labels = "broker=\"" + brokerType + "\",subscriber=\"" + subscriberId + "\"";
+        if (!g_nodeName.empty()) labels += ",node=\"" + g_nodeName + "\"";
+        if (exporter.start(metricsPort, labels, [&states](PrometheusWriter& metrics) {
+                writeLiveMetrics(metrics, states);
+            })) {
+            std::cerr << "✓ Live metrics on port " << metricsPort << " (/metrics)" << std::endl;
+        }
+    }
+
+    // Announce readiness to the publisher until START arrives; READY is
+    // repeated because the publisher may start listening after us
+    auto control = createControlBroker(brokerType);
+    std::string instanceId = controlInstanceId(subscriberId);
+    bool controlConnected = control->connect();
+    if (!controlConnected) {
+        std::cerr << "⚠️  Could not connect the control channel, the publisher will time out waiting for us" << std::endl;
+    }
+    bool announcedStarted = !controlConnected;
+    AllocationCounts allocationsAtStart = allocationCounts();
+    std::chrono::steady_clock::time_point lastReady;
+    const auto readyInterval = std::chrono::milliseconds(250);
+
+    // Run continuously - write results once every started thread has seen END,
+    // or a grace period after the first END in case another thread's was lost.
+    // SUBSCRIBER_PERSISTENT=1 keeps going afterwards: the threads are rearmed
+    // and READY is announced again, so a sweep reuses this process for its
+    // next point instead of starting a new container.
+    bool persistent = config.getInt("SUBSCRIBER_PERSISTENT", 0) != 0;
+    int runsWritten = 0;
     bool resultsWritten = false;
+    std::chrono::steady_clock::time_point firstEndSeen;
+    const auto endGracePeriod = std::chrono::seconds(2);
     
     while (true) {
-        broker->processMessages(100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(announcedStarted ? 100 : 10));
+        if (resultsWritten) continue;
+
+        int started = 0;
+        int ended = 0;
+        bool endSeen = false;
+        for (const auto& state : states) {
+            if (state->ended.load(std::memory_order_acquire)) ended++;
+            if (state->started.load(std::memory_order_acquire)) started++;
+            if (state->endSeen.load(std::memory_order_acquire)) endSeen = true;
+        }
+
+        if (!announcedStarted) {
+            if (started == numThreads) {
+                announceStarted(*control, instanceId);
+                announcedStarted = true;
+                allocationsAtStart = allocationCounts();
+                std::cerr << "✓ START received on all threads" << std::endl;
+            } else if (started == 0 && std::chrono::steady_clock::now() - lastReady >= readyInterval) {
+                announceReady(*control, instanceId, multiplexed ? numLogical : numThreads);
+                lastReady = std::chrono::steady_clock::now();
+            }
+        }
+        if (!endSeen) continue;
+        if (firstEndSeen == std::chrono::steady_clock::time_point()) {
+            firstEndSeen = std::chrono::steady_clock::now();
+        }
         
-        // Write results once when benchmark ends, but keep running
-        if (benchmarkEnded_Flag && !resultsWritten) {
-            writeResults(subscriberId);
-            resultsWritten = true;
-            std::cerr << "✓ Benchmark results written - subscriber continues running" << std::endl;
+        if (ended >= started || std::chrono::steady_clock::now() - firstEndSeen >= endGracePeriod) {
+            // A persistent subscriber keeps sampling; each run writes its own slice
+            if (!persistent) sampler.stop();
+            // Threads still short of END (the grace path) are receiving:
+            // stop every thread and wait for each to acknowledge, so the
+            // merge and writeResults read state nobody is writing
+            for (auto& state : states) state->requestStop();
+            for (auto& state : states) {
+                while (!state->stopAcknowledged()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            MergedResults merged = mergeResults(states);
+            merged.placement = &placement;
+            merged.timeseries = &sampler;
+            merged.allocationsAtStart = allocationsAtStart;
+            merged.deliveryMode = describeDeliveryMode(brokerType, config);
+            merged.topics = topics.describe();
+            merged.subscriptions = plan.describe();
+            merged.logical = logical.get();
+            merged.numLogical = static_cast<size_t>(numLogical);
+            writeResults(subscriberId, merged);
+            runsWritten++;
+            if (!persistent) {
+                resultsWritten = true;
+                std::cerr << "✓ Benchmark results written - subscriber continues running" << std::endl;
+                continue;
+            }
+
+            // Rearm: reset every state, and the logical subscribers, while
+            // the threads are still stopped; the next START cannot arrive
+            // before we announce READY again
+            for (auto& state : states) state->resetForNextRun();
+            for (int i = 0; i < numLogical; i++) {
+                logical[i].ended = false;
+                logical[i].endsSeen = 0;
+                logical[i].messagesReceived.reset();
+            }
+            for (auto& state : states) state->resume();
+            announcedStarted = !controlConnected;
+            allocationsAtStart = allocationCounts();
+            resetPeakRss();
+            firstEndSeen = {};
+            lastReady = {};
+            std::cerr << "✓ Run " << runsWritten << " results written - waiting for the next START" << std::endl;
         }
     }
     
     // This code is unreachable but kept for clarity
-    broker->disconnect();
+    for (auto& thread : threads) {
+        thread.join();
+    }
     return 0;
 }
 
-void writeResults(const char* subscriberId) {
-    // Calculate and log results
-    auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+void writeResults(const char* subscriberId, const MergedResults& results) {
+    // Calculate and log results. With a measurement window, the headline
+    // numbers cover the steady state only and its length is the duration.
+    auto receiveDuration = results.endTime - results.startTime;
+    if (results.window.enabled()) {
+        receiveDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(results.window.toNs - results.window.fromNs));
+    }
+    auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(receiveDuration);
+    auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(receiveDuration);
     double seconds = duration_us.count() / 1000000.0;
+    uint64_t messagesReceived = results.messagesReceived;
+    uint64_t bytesReceived = results.bytesReceived;
     double throughput = seconds > 0 ? messagesReceived / seconds : 0;
+    double throughputBytes = seconds > 0 ? bytesReceived / seconds : 0;
+    const LatencyHistogram& latencyHistogram = *results.latency;
+    const SequenceTracker::Summary& sequence = results.sequence;
+    const auto& rateSteps = results.rateSteps;
+    MemoryReport memory = MemoryReport::since(
+        results.allocationsAtStart, results.warmup.messages + messagesReceived + results.cooldown.messages);
 
     // Output results as JSON to stdout
     std::cout << "\n{\n";
@@ -116,7 +1238,14 @@ void writeResults(const char* subscriberId) {
     std::cout << "  \"messages_received\": " << messagesReceived << ",\n";
     std::cout << "  \"duration_us\": " << duration_us.count() << ",\n";
     std::cout << "  \"duration_ms\": " << duration_ms.count() << ",\n";
-    std::cout << "  \"throughput_msg_per_sec\": " << std::fixed << std::setprecision(2) << throughput << "\n";
+    std::cout << "  \"throughput_msg_per_sec\": " << std::fixed << std::setprecision(2) << throughput << ",\n";
+    std::cout << "  \"throughput_bytes_per_sec\": " << std::fixed << std::setprecision(2) << throughputBytes << ",\n";
+    std::cout << "  \"latency_us\": ";
+    latencyHistogram.writeSummaryJson(std::cout);
+    std::cout << ",\n";
+    std::cout << "  \"lost\": " << sequence.lost << ",\n";
+    std::cout << "  \"duplicates\": " << sequence.duplicates << ",\n";
+    std::cout << "  \"out_of_order\": " << sequence.outOfOrder << "\n";
     std::cout << "}\n" << std::endl;
     std::cout.flush();
     std::cerr.flush();
@@ -135,6 +1264,7 @@ void writeResults(const char* subscriberId) {
         }
     }
     std::string hostname = hostnameEnv ? std::string(hostnameEnv) : std::string(hostbuf);
+    std::string nodeName = g_nodeName.empty() ? hostname : g_nodeName;
 
     auto now = std::chrono::system_clock::now();
     std::time_t now_c = std::chrono::system_clock::to_time_t(now);
@@ -149,7 +1279,8 @@ void writeResults(const char* subscriberId) {
 
     // Determine batch id and directory
     const char* batchEnv = std::getenv("BATCH_ID");
-    std::string batchId = batchEnv ? std::string(batchEnv) : std::string(tsbuf);
+    std::string batchId = !results.batchId.empty() ? results.batchId
+                        : batchEnv ? std::string(batchEnv) : std::string(tsbuf);
     std::string batchDir = std::string("/data/") + batchId;
     if (stat(batchDir.c_str(), &st) != 0) {
         ::mkdir(batchDir.c_str(), 0755);
@@ -164,11 +1295,140 @@ void writeResults(const char* subscriberId) {
         out << "  \"broker_type\": \"" << g_brokerType << "\",\n";
         out << "  \"subscriber_id\": \"" << subscriberId << "\",\n";
         out << "  \"host\": \"" << hostname << "\",\n";
+        out << "  \"node\": \"" << nodeName << "\",\n";
         out << "  \"timestamp\": \"" << tsbuf << "\",\n";
+        out << "  \"publisher_processes\": " << g_publisherProcesses << ",\n";
+        out << "  \"num_subscriber_threads\": " << results.threads.size() << ",\n";
+        out << "  \"delivery_mode\": \"" << results.deliveryMode << "\",\n";
+        out << "  \"topics\": \"" << results.topics << "\",\n";
+        out << "  \"subscriptions\": \"" << results.subscriptions << "\",\n";
+        out << "  \"retain\": {\"mode\": \"" << MessageRetainer::modeName(g_retainMode)
+            << "\", \"batch_messages\": " << g_arenaBatch
+            << ", \"batches\": " << results.retainedBatches
+            << ", \"arena_capacity_bytes\": " << results.arenaCapacity
+            << ", \"arena_peak_bytes\": " << results.arenaPeak
+            << ", \"arena_slabs\": " << results.arenaSlabs << "},\n";
+        if (results.placement != nullptr) {
+            out << "  \"placement\": ";
+            results.placement->writeJson(out, results.locations);
+            out << ",\n";
+        }
         out << "  \"messages_received\": " << messagesReceived << ",\n";
+        out << "  \"bytes_received\": " << bytesReceived << ",\n";
+        out << "  \"dropped_messages\": " << results.droppedMessages << ",\n";
+        out << "  \"disconnects\": " << results.disconnects << ",\n";
+        out << "  \"reconnects\": " << results.reconnects << ",\n";
+        // Wall-clock ms like the timeseries; durations are -1 while unknown
+        out << "  \"outages\": [";
+        for (size_t i = 0; i < results.outages.size(); i++) {
+            const auto& [thread, outage] = results.outages[i];
+            auto sinceDown = [down = outage.downNs](uint64_t ns) {
+                return ns != 0 ? static_cast<int64_t>((ns - down) / 1000000) : -1;
+            };
+            out << (i ? ", " : "") << "{\"thread\": " << thread
+                << ", \"down_ms\": " << outage.downNs / 1000000
+                << ", \"up_ms\": " << outage.upNs / 1000000
+                << ", \"first_message_ms\": " << outage.firstMessageNs / 1000000
+                << ", \"reconnect_ms\": " << sinceDown(outage.upNs)
+                << ", \"time_to_first_message_ms\": " << sinceDown(outage.firstMessageNs)
+                << ", \"lost_messages\": " << outage.lostMessages << "}";
+        }
+        out << "],\n";
+        out << "  \"consumer\": {\"work\": \"" << g_workload.modeName()
+            << "\", \"work_description\": \"" << g_workload.describe()
+            << "\", \"handoff\": " << (g_handoffQueue > 0 ? "true" : "false")
+            << ", \"queue_size\": " << g_handoffQueue
+            << ", \"queue_full\": \"" << (g_handoffDropWhenFull ? "drop" : "block")
+            << "\", \"queue_drops\": " << results.queueDrops
+            << ", \"queue_full_waits\": " << results.queueFullWaits
+            << ", \"queue_high_water\": " << results.queueHighWater << "},\n";
         out << "  \"duration_us\": " << duration_us.count() << ",\n";
         out << "  \"duration_ms\": " << duration_ms.count() << ",\n";
-        out << "  \"throughput_msg_per_sec\": " << std::fixed << std::setprecision(2) << throughput << "\n";
+        out << "  \"throughput_msg_per_sec\": " << std::fixed << std::setprecision(2) << throughput << ",\n";
+        out << "  \"throughput_bytes_per_sec\": " << std::fixed << std::setprecision(2) << throughputBytes << ",\n";
+        out << "  \"latency_us\": ";
+        latencyHistogram.writeSummaryJson(out);
+        out << ",\n";
+        out << "  \"latency_histogram\": {\"unit\": \"ns\", \"sub_bucket_bits\": "
+            << LatencyHistogram::SUB_BUCKET_BITS << ", \"buckets\": ";
+        latencyHistogram.writeBucketsJson(out);
+        out << "},\n";
+        out << "  \"sequence\": {\"publishers\": " << sequence.publishers
+            << ", \"streams\": " << sequence.streams
+            << ", \"lost\": " << sequence.lost
+            << ", \"duplicates\": " << sequence.duplicates
+            << ", \"out_of_order\": " << sequence.outOfOrder
+            << ", \"too_late\": " << sequence.tooLate
+            << ", \"longest_gap\": " << sequence.longestGap << "},\n";
+        out << "  \"measurement_window\": {\"enabled\": " << (results.window.enabled() ? "true" : "false")
+            << ", \"from_ms\": " << results.window.fromNs / 1000000
+            << ", \"to_ms\": " << (results.window.enabled() ? results.window.toNs / 1000000 : 0)
+            << ", \"seconds\": " << std::fixed << std::setprecision(3) << results.window.seconds() << "},\n";
+        out << "  \"phases\": {";
+        out << "\"warmup\": {\"messages_received\": " << results.warmup.messages
+            << ", \"bytes_received\": " << results.warmup.bytes << ", \"latency_us\": ";
+        results.warmup.latency->writeSummaryJson(out);
+        out << "}, \"steady\": {\"messages_received\": " << messagesReceived
+            << ", \"bytes_received\": " << bytesReceived
+            << ", \"throughput_msg_per_sec\": " << std::fixed << std::setprecision(2) << throughput
+            << ", \"latency_us\": ";
+        latencyHistogram.writeSummaryJson(out);
+        out << "}, \"cooldown\": {\"messages_received\": " << results.cooldown.messages
+            << ", \"bytes_received\": " << results.cooldown.bytes << ", \"latency_us\": ";
+        results.cooldown.latency->writeSummaryJson(out);
+        out << "}},\n";
+        out << "  \"rate_steps\": [";
+        bool firstStep = true;
+        for (size_t i = 0; i < rateSteps.size(); i++) {
+            if (!rateSteps[i]) continue;
+            out << (firstStep ? "" : ", ") << "{\"step\": " << i
+                << ", \"messages_received\": " << rateSteps[i]->messages
+                << ", \"latency_us\": ";
+            rateSteps[i]->latency.writeSummaryJson(out);
+            out << "}";
+            firstStep = false;
+        }
+        out << "],\n";
+        if (results.numLogical > 0) {
+            FairnessStats fairness = FairnessStats::of(results.logical, results.numLogical);
+            out << "  \"fanout\": {\"logical_subscribers\": " << results.numLogical
+                << ", \"loop_threads\": " << results.locations.size()
+                << ", \"received_min\": " << fairness.min
+                << ", \"received_median\": " << fairness.median
+                << ", \"received_max\": " << fairness.max
+                << ", \"received_mean\": " << std::fixed << std::setprecision(2) << fairness.mean << "},\n";
+        }
+        out << "  \"threads\": [";
+        for (size_t i = 0; i < results.threads.size(); i++) {
+            const SubscriberState* t = results.threads[i];
+            auto threadEnd = t->ended.load(std::memory_order_acquire) ? t->endTime : results.endTime;
+            double threadSeconds = results.window.enabled()
+                ? results.window.seconds()
+                : std::chrono::duration<double>(threadEnd - t->startTime).count();
+            out << (i ? ", " : "") << "{\"thread\": " << t->threadId
+                << ", \"cpu\": " << t->location.cpu
+                << ", \"messages_received\": " << t->messagesReceived.get()
+                << ", \"dropped_messages\": " << t->runDropped()
+                << ", \"throughput_msg_per_sec\": " << std::fixed << std::setprecision(2)
+                << (threadSeconds > 0 ? t->messagesReceived.get() / threadSeconds : 0)
+                << ", \"latency_p99_us\": " << t->latency.percentile(99.0) / 1000.0 << "}";
+        }
+        out << "],\n";
+        out << "  \"hot_path\": ";
+        hotPathSnapshot().writeJson(out);
+        out << ",\n  \"memory\": ";
+        memory.writeJson(out);
+        if (results.timeseries != nullptr) {
+            // Only the intervals covering the run, in wall-clock time
+            auto toWallNs = [nowSteady = std::chrono::steady_clock::now(), nowWall = wallClockNs()](
+                                std::chrono::steady_clock::time_point t) {
+                return nowWall - static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(nowSteady - t).count());
+            };
+            out << ",\n  \"timeseries\": ";
+            results.timeseries->writeJson(out, toWallNs(results.startTime), toWallNs(results.endTime));
+        }
+        out << "\n";
         out << "}\n";
         out.flush();
         out.close();
@@ -181,9 +1441,87 @@ void writeResults(const char* subscriberId) {
     std::cout << "\n========================================" << std::endl;
     std::cout << "Subscriber Results (" << subscriberId << "):" << std::endl;
     std::cout << "========================================" << std::endl;
+    std::cout << "Subscriber Threads:     " << results.threads.size() << std::endl;
+    if (results.placement != nullptr) {
+        std::cout << "Placement:              " << results.placement->describe() << std::endl;
+    }
     std::cout << "Messages Received:      " << messagesReceived << std::endl;
+    if (results.numLogical > 0) {
+        FairnessStats fairness = FairnessStats::of(results.logical, results.numLogical);
+        std::cout << "Logical Subscribers:    " << results.numLogical << ", received min/median/max "
+                  << fairness.min << " / " << fairness.median << " / " << fairness.max << std::endl;
+    }
     std::cout << "Duration:               " << std::fixed << std::setprecision(3) << seconds << " seconds" << std::endl;
     std::cout << "Throughput:             " << std::fixed << std::setprecision(2) << throughput << " msg/sec" << std::endl;
+    std::cout << "Bandwidth:              " << std::fixed << std::setprecision(2) << throughputBytes / (1024.0 * 1024.0) << " MiB/sec" << std::endl;
+    std::cout << "Latency p50/p99/p99.9:  " << std::fixed << std::setprecision(1)
+              << latencyHistogram.percentile(50.0) / 1000.0 << " / "
+              << latencyHistogram.percentile(99.0) / 1000.0 << " / "
+              << latencyHistogram.percentile(99.9) / 1000.0 << " us" << std::endl;
+    std::cout << "Latency max:            " << std::fixed << std::setprecision(1)
+              << latencyHistogram.max() / 1000.0 << " us" << std::endl;
+    std::cout << "Client Drops:           " << results.droppedMessages << " (" << results.deliveryMode << " delivery)" << std::endl;
+    std::cout << "Disconnects:            " << results.disconnects << " (" << results.reconnects << " reconnected)"
+              << std::endl;
+    for (const auto& [thread, outage] : results.outages) {
+        std::cout << "Outage:                 thread " << thread << ", ";
+        if (outage.upNs == 0) {
+            std::cout << "not reconnected" << std::endl;
+            continue;
+        }
+        std::cout << "reconnected after " << (outage.upNs - outage.downNs) / 1000000 << " ms";
+        if (outage.firstMessageNs != 0) {
+            std::cout << ", first message after " << (outage.firstMessageNs - outage.downNs) / 1000000
+                      << " ms, " << outage.lostMessages << " lost";
+        }
+        std::cout << std::endl;
+    }
+    if (g_workload.active() || g_handoffQueue > 0) {
+        std::cout << "Consumer Work:          " << g_workload.describe();
+        if (g_handoffQueue > 0) {
+            std::cout << ", handoff queue " << g_handoffQueue << " (high water " << results.queueHighWater
+                      << ", " << results.queueDrops << " dropped, " << results.queueFullWaits << " full waits)";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Lost / Dup / Reordered: " << sequence.lost << " / " << sequence.duplicates
+              << " / " << sequence.outOfOrder << std::endl;
+    std::cout << "Longest Gap:            " << sequence.longestGap << " messages" << std::endl;
+    if (g_retainMode != RetainMode::None) {
+        std::cout << "Retained:               " << MessageRetainer::modeName(g_retainMode) << ", "
+                  << results.retainedBatches << " batches of " << g_arenaBatch << " messages";
+        if (g_retainMode == RetainMode::Arena) {
+            std::cout << " (arena " << results.arenaCapacity / 1024 << " KiB in " << results.arenaSlabs << " slabs)";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "RSS / Peak / Heap:      " << std::fixed << std::setprecision(1)
+              << memory.usage.rssBytes / (1024.0 * 1024.0) << " / " << memory.usage.peakRssBytes / (1024.0 * 1024.0)
+              << " / " << memory.usage.heapInUseBytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+    if (ALLOCATION_COUNTING) {
+        std::cout << "Allocations:            " << memory.allocations.allocations << " ("
+                  << std::setprecision(4) << memory.allocationsPerMessage() << " per message, "
+                  << std::setprecision(1) << memory.bytesPerMessage() << " bytes per message)" << std::endl;
+    }
+    if (results.window.enabled()) {
+        std::cout << "Steady-State Window:    " << std::fixed << std::setprecision(3)
+                  << results.window.seconds() << " seconds (numbers above)" << std::endl;
+        std::cout << "Warm-up:                " << results.warmup.messages << " msgs, p99 "
+                  << std::setprecision(1) << results.warmup.latency->percentile(99.0) / 1000.0 << " us" << std::endl;
+        std::cout << "Cool-down:              " << results.cooldown.messages << " msgs, p99 "
+                  << std::setprecision(1) << results.cooldown.latency->percentile(99.0) / 1000.0 << " us" << std::endl;
+    }
+    // Per-step breakdown only when the publisher actually ramped
+    bool ramped = std::any_of(rateSteps.begin() + 1, rateSteps.end(),
+                              [](const auto& step) { return step != nullptr; });
+    if (ramped) {
+        for (size_t i = 0; i < rateSteps.size(); i++) {
+            if (!rateSteps[i]) continue;
+            std::cout << "  Step " << std::setw(2) << i << ": " << rateSteps[i]->messages << " msgs, p99 "
+                      << std::fixed << std::setprecision(1) << rateSteps[i]->latency.percentile(99.0) / 1000.0
+                      << " us" << std::endl;
+        }
+    }
     std::cout << "========================================\n" << std::endl;
     std::cout.flush();
 }
@@ -0,0 +1,128 @@
+#ifndef ARENA_REPLIES_H
+#define ARENA_REPLIES_H
+
+#include "benchmark_common.h"
+#include <hiredis/hiredis.h>
+#include <cstring>
+
+// hiredis reply trees built in a per-thread MessageArena instead of one
+// malloc per element (plus one per string), for the subscriber paths that
+// still read through hiredis: REDIS_SUBSCRIBER_READER=hiredis and
+// XREADGROUP batches of Redis Streams. Enabled with REDIS_REPLY_ARENA=1.
+//
+// After install(ctx) every reply read on ctx lives in the calling thread's
+// arena, so it must be given back with release(), never freeReplyObject().
+// release() rewinds the arena once batchMessages messages have been
+// released and the reader holds no half-parsed reply. Only one installed
+// context per thread may be reading at a time (each subscriber thread owns
+// exactly one connection).
+class ArenaReplies {
+public:
+    // False if ctx is in the middle of a reply; try again later
+    static bool install(redisContext* ctx) {
+        if (ctx == nullptr || ctx->reader == nullptr || ctx->reader->ridx != -1) return false;
+        ctx->reader->fn = functions();
+        return true;
+    }
+
+    static bool installed(const redisContext* ctx) {
+        return ctx != nullptr && ctx->reader != nullptr && ctx->reader->fn == functions();
+    }
+
+    // Give back a reply read on ctx, arena or not; messages is what it carried
+    static void release(redisContext* ctx, redisReply* reply, size_t batchMessages, size_t messages = 1) {
+        if (reply == nullptr) return;
+        if (!installed(ctx)) {
+            freeReplyObject(reply);
+            return;
+        }
+        MessageArena& a = arena();
+        a.finish(messages);
+        if (a.due(batchMessages) && ctx->reader->ridx == -1) a.reset();
+    }
+
+    // This thread's reply arena
+    static MessageArena& arena() {
+        thread_local MessageArena replies(256 * 1024);
+        return replies;
+    }
+
+private:
+    static redisReply* createReply(const redisReadTask* task, int type) {
+        auto* reply = static_cast<redisReply*>(arena().allocate(sizeof(redisReply), alignof(redisReply)));
+        std::memset(reply, 0, sizeof(redisReply));
+        reply->type = type;
+        if (task->parent != nullptr) {
+            auto* parent = static_cast<redisReply*>(task->parent->obj);
+            parent->element[task->idx] = reply;
+        }
+        return reply;
+    }
+
+    static void* createString(const redisReadTask* task, char* str, size_t len) {
+        redisReply* reply = createReply(task, task->type);
+        reply->str = const_cast<char*>(arena().copy(std::string_view(str, len)).data());
+        reply->len = len;
+        return reply;
+    }
+
+    static void* createArray(const redisReadTask* task, size_t elements) {
+        redisReply* reply = createReply(task, task->type);
+        if (elements > 0) {
+            auto* children = static_cast<redisReply**>(
+                arena().allocate(elements * sizeof(redisReply*), alignof(redisReply*)));
+            std::memset(children, 0, elements * sizeof(redisReply*));
+            reply->element = children;
+        }
+        reply->elements = elements;
+        return reply;
+    }
+
+    static void* createInteger(const redisReadTask* task, long long value) {
+        redisReply* reply = createReply(task, REDIS_REPLY_INTEGER);
+        reply->integer = value;
+        return reply;
+    }
+
+    static void* createNil(const redisReadTask* task) {
+        return createReply(task, REDIS_REPLY_NIL);
+    }
+
+    // The arena owns everything; hiredis calls this on errors and teardown
+    static void freeObject(void*) {}
+
+#if defined(HIREDIS_MAJOR) && HIREDIS_MAJOR >= 1
+    static void* createDouble(const redisReadTask* task, double value, char* str, size_t len) {
+        redisReply* reply = static_cast<redisReply*>(createString(task, str, len));
+        reply->dval = value;
+        return reply;
+    }
+
+    static void* createBool(const redisReadTask* task, int value) {
+        redisReply* reply = createReply(task, REDIS_REPLY_BOOL);
+        reply->integer = value != 0;
+        return reply;
+    }
+
+    static redisReplyObjectFunctions* functions() {
+        static redisReplyObjectFunctions fn = {
+            createString, createArray, createInteger, createDouble, createNil, createBool, freeObject
+        };
+        return &fn;
+    }
+#else
+    // hiredis 0.14 passes the array size as an int
+    static void* createArrayInt(const redisReadTask* task, int elements) {
+        return createArray(task, elements > 0 ? static_cast<size_t>(elements) : 0);
+    }
+
+    static redisReplyObjectFunctions* functions() {
+        static redisReplyObjectFunctions fn = {
+            createString, createArrayInt, createInteger, createNil, freeObject
+        };
+        return &fn;
+    }
+#endif
+};
+
+#endif // ARENA_REPLIES_H
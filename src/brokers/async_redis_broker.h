@@ -0,0 +1,274 @@
+#ifndef ASYNC_REDIS_BROKER_H
+#define ASYNC_REDIS_BROKER_H
+
+#include "message_broker.h"
+#include "benchmark_common.h"
+#include "dispatch_table.h"
+#include "redis_event_loop.h"
+#include <hiredis/async.h>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Redis pub/sub over hiredis' async API (redisAsyncContext), the way
+// services usually talk to Redis. All sockets are driven by the shared
+// RedisEventLoop thread(s), so I/O concurrency no longer costs a thread per
+// connection:
+//
+// Publish:   publish() appends PUBLISH to a connection's output buffer and
+//            returns; the loop writes whatever has accumulated and counts
+//            replies off. Up to maxInFlight commands may be outstanding per
+//            connection before publish() waits. flush() waits for all replies.
+// Subscribe: SUBSCRIBE/PSUBSCRIBE on a dedicated connection; pushes are parsed
+//            and handed to the handlers on the loop thread, like NATS async
+//            delivery, so processMessages() only waits.
+//
+// A broker can spread publishes over several connections. Each channel is
+// pinned to one of them, which keeps per-channel order (and sequence checks)
+// intact; a single-channel run therefore uses one connection however many
+// are opened. With zero publish connections the broker only subscribes,
+// which is how multiplexed subscribers keep to one socket each.
+class AsyncRedisBroker final : public MessageBroker {
+private:
+    struct Connection : RedisAsyncConnection {
+        int inFlight = 0;   // commands without a reply yet
+        int waiters = 0;    // threads blocked on inFlight
+        uint64_t errors = 0;
+    };
+
+    std::string host;
+    int port;
+    RedisEventLoop& loop;
+    int numConnections = 1;
+    int maxInFlight = 1000;
+    std::vector<std::unique_ptr<Connection>> connections;
+
+    // Subscriber side; callbacks run on the loop thread under subscriber.lock
+    Connection subscriber;
+    bool subscriberOpen = false;
+    DispatchTable callbacks;         // SUBSCRIBE, keyed by channel
+    DispatchTable patternCallbacks;  // PSUBSCRIBE, keyed by pattern
+    int pendingAcks = 0;
+
+public:
+    AsyncRedisBroker(const std::string& h = "localhost", int p = 6379)
+        : host(h), port(p), loop(RedisEventLoop::next()) {}
+
+    // Pinned to eventLoop, so every callback of this broker runs on its thread
+    AsyncRedisBroker(const std::string& h, int p, RedisEventLoop& eventLoop)
+        : host(h), port(p), loop(eventLoop) {}
+
+    ~AsyncRedisBroker() override {
+        disconnect();
+    }
+
+    // Publish connections per broker (0 = subscribe only) and the in-flight
+    // window of each. Call before connect().
+    void setConnectionOptions(int connectionCount, int inFlightLimit) {
+        if (connectionCount >= 0) numConnections = connectionCount;
+        if (inFlightLimit > 0) maxInFlight = inFlightLimit;
+    }
+
+    bool connect() override {
+        for (int i = 0; i < numConnections; i++) {
+            auto connection = std::make_unique<Connection>();
+            if (!loop.connect(*connection, host, port)) {
+                disconnect();
+                return false;
+            }
+            connections.push_back(std::move(connection));
+        }
+        return true;
+    }
+
+    void disconnect() override {
+        for (auto& connection : connections) {
+            reportErrors(*connection);
+            loop.close(*connection);
+        }
+        connections.clear();
+        if (subscriberOpen) {
+            loop.close(subscriber);
+            subscriberOpen = false;
+        }
+    }
+
+    bool isConnected() const override {
+        if (connections.empty()) return numConnections == 0;
+        return connections.front()->ac != nullptr;
+    }
+
+    bool publish(const std::string& channel, const std::string& message) override {
+        if (connections.empty()) return false;
+        Connection& connection = connectionFor(channel);
+        std::unique_lock<std::mutex> lock(connection.lock);
+        if (!awaitWindow(connection, lock)) return false;
+        return sendPublish(connection, channel, message);
+    }
+
+    // The whole batch is appended under one lock and leaves in one write
+    size_t publishBatch(const std::string& channel, std::span<const std::string_view> messages) override {
+        if (connections.empty()) return 0;
+        Connection& connection = connectionFor(channel);
+        std::unique_lock<std::mutex> lock(connection.lock);
+        if (!awaitWindow(connection, lock)) return 0;
+        size_t accepted = 0;
+        for (std::string_view message : messages) {
+            if (!sendPublish(connection, channel, message)) break;
+            accepted++;
+        }
+        return accepted;
+    }
+
+    // Wait until every publish so far has been answered
+    void flush() override {
+        for (auto& connection : connections) {
+            std::unique_lock<std::mutex> lock(connection->lock);
+            connection->waiters++;
+            connection->changed.wait(lock, [&] {
+                return connection->inFlight == 0 || connection->ac == nullptr;
+            });
+            connection->waiters--;
+        }
+    }
+
+    using MessageBroker::subscribe;
+
+    bool subscribe(const std::string& channel, MessageHandler handler) override {
+        return sendSubscribe("SUBSCRIBE", channel, callbacks, std::move(handler));
+    }
+
+    bool subscribePattern(const std::string& pattern, MessageHandler handler) override {
+        return sendSubscribe("PSUBSCRIBE", pattern, patternCallbacks, std::move(handler));
+    }
+
+    void unsubscribe(const std::string& channel) override {
+        if (!subscriberOpen) return;
+        std::lock_guard<std::mutex> lock(subscriber.lock);
+        if (subscriber.ac != nullptr) {
+            const char* argv[] = { "UNSUBSCRIBE", channel.c_str() };
+            size_t argvlen[] = { 11, channel.length() };
+            redisAsyncCommandArgv(subscriber.ac, onPush, this, 2, argv, argvlen);
+        }
+        callbacks.erase(channel);
+    }
+
+    // Messages are dispatched on the event loop thread
+    void processMessages(int timeoutMs = 1000) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+    }
+
+    std::string getName() const override {
+        return "Redis";
+    }
+
+    std::string getPublishMode() const override {
+        return "async";
+    }
+
+private:
+    Connection& connectionFor(const std::string& channel) {
+        if (connections.size() == 1) return *connections.front();
+        return *connections[std::hash<std::string>{}(channel) % connections.size()];
+    }
+
+    // Block while the connection has maxInFlight commands outstanding
+    bool awaitWindow(Connection& connection, std::unique_lock<std::mutex>& lock) {
+        if (connection.inFlight >= maxInFlight) {
+            connection.waiters++;
+            connection.changed.wait(lock, [&] {
+                return connection.inFlight < maxInFlight || connection.ac == nullptr;
+            });
+            connection.waiters--;
+        }
+        return connection.ac != nullptr;
+    }
+
+    // Caller holds connection.lock
+    bool sendPublish(Connection& connection, const std::string& channel, std::string_view message) {
+        const char* argv[] = { "PUBLISH", channel.c_str(), message.data() };
+        size_t argvlen[] = { 7, channel.length(), message.length() };
+        if (connection.ac == nullptr ||
+            redisAsyncCommandArgv(connection.ac, onPublishReply, &connection, 3, argv, argvlen) != REDIS_OK) {
+            return false;
+        }
+        connection.inFlight++;
+        return true;
+    }
+
+    // Loop thread, connection.lock held
+    static void onPublishReply(redisAsyncContext*, void* r, void* privdata) {
+        auto* connection = static_cast<Connection*>(privdata);
+        auto* reply = static_cast<redisReply*>(r);
+        if (reply == nullptr || reply->type == REDIS_REPLY_ERROR) connection->errors++;
+        connection->inFlight--;
+        if (connection->waiters > 0) connection->changed.notify_all();
+    }
+
+    void reportErrors(Connection& connection) {
+        std::lock_guard<std::mutex> lock(connection.lock);
+        if (connection.errors > 0) {
+            std::cerr << "⚠️  " << connection.errors << " async PUBLISH(es) failed or went unanswered" << std::endl;
+        }
+    }
+
+    bool sendSubscribe(const char* command, const std::string& target,
+                       DispatchTable& table, MessageHandler handler) {
+        if (!subscriberOpen) {
+            if (!loop.connect(subscriber, host, port)) return false;
+            subscriberOpen = true;
+        }
+
+        std::unique_lock<std::mutex> lock(subscriber.lock);
+        if (subscriber.ac == nullptr) return false;
+        table.add(target, std::move(handler));
+        const char* argv[] = { command, target.c_str() };
+        size_t argvlen[] = { std::strlen(command), target.length() };
+        if (redisAsyncCommandArgv(subscriber.ac, onPush, this, 2, argv, argvlen) != REDIS_OK) {
+            return false;
+        }
+        pendingAcks++;
+        return subscriber.changed.wait_for(lock, std::chrono::seconds(5), [this] {
+            return pendingAcks == 0 || subscriber.ac == nullptr;
+        }) && subscriber.ac != nullptr;
+    }
+
+    // Loop thread, subscriber.lock held. hiredis calls this for the
+    // (p)subscribe acks and for every push on the subscribed channels, and
+    // frees the reply afterwards, so the views are only valid in here.
+    static void onPush(redisAsyncContext*, void* r, void* privdata) {
+        auto* broker = static_cast<AsyncRedisBroker*>(privdata);
+        auto* reply = static_cast<redisReply*>(r);
+        if (reply == nullptr || reply->type != REDIS_REPLY_ARRAY || reply->elements < 3) return;
+
+        const redisReply* kind = reply->element[0];
+        std::string_view type(kind->str, kind->len);
+        const MessageHandler* handler = nullptr;
+        MessageView view;
+        if (type == "message") {
+            view.channel = std::string_view(reply->element[1]->str, reply->element[1]->len);
+            view.payload = std::string_view(reply->element[2]->str, reply->element[2]->len);
+            handler = broker->callbacks.find(view.channel);
+        } else if (type == "pmessage" && reply->elements >= 4) {
+            view.channel = std::string_view(reply->element[2]->str, reply->element[2]->len);
+            view.payload = std::string_view(reply->element[3]->str, reply->element[3]->len);
+            handler = broker->patternCallbacks.find(
+                std::string_view(reply->element[1]->str, reply->element[1]->len));
+        } else if (type == "subscribe" || type == "psubscribe") {
+            if (broker->pendingAcks > 0) broker->pendingAcks--;
+            broker->subscriber.changed.notify_all();
+            return;
+        }
+        if (handler != nullptr) {
+            view.receiveTimestampNs = wallClockNs();
+            (*handler)(view);
+        }
+    }
+};
+
+#endif // ASYNC_REDIS_BROKER_H
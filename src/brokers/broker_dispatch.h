@@ -0,0 +1,60 @@
+#ifndef BROKER_DISPATCH_H
+#define BROKER_DISPATCH_H
+
+#include "message_broker.h"
+#include "redis_broker.h"
+#include "async_redis_broker.h"
+#include "redis_streams_broker.h"
+#include "redis_cluster_broker.h"
+#include "nats_broker.h"
+#include "jetstream_broker.h"
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+
+// Compile-time broker selection for the hot loops. createBroker() still picks
+// the backend at runtime from BROKER_TYPE; withConcreteBroker() then turns the
+// MessageBroker& into its exact class once, and fn is instantiated per class,
+// so the publish loop and the receive loop call the broker without virtual
+// dispatch and the compiler can inline across the call.
+//
+//   withConcreteBroker(*broker, [&](auto& concrete) { runPublisher(concrete, ...); });
+//
+// A broker of any other class is passed on as MessageBroker& (virtual calls).
+template <typename Fn>
+decltype(auto) withConcreteBroker(MessageBroker& broker, Fn&& fn) {
+    const std::type_info& type = typeid(broker);
+    if (type == typeid(RedisBroker)) return fn(static_cast<RedisBroker&>(broker));
+    if (type == typeid(AsyncRedisBroker)) return fn(static_cast<AsyncRedisBroker&>(broker));
+    if (type == typeid(RedisStreamsBroker)) return fn(static_cast<RedisStreamsBroker&>(broker));
+    if (type == typeid(RedisClusterBroker)) return fn(static_cast<RedisClusterBroker&>(broker));
+    if (type == typeid(NatsBroker)) return fn(static_cast<NatsBroker&>(broker));
+    if (type == typeid(JetStreamBroker)) return fn(static_cast<JetStreamBroker&>(broker));
+    return fn(broker);
+}
+
+// Statically bound publish calls. withConcreteBroker() only hands out exact
+// dynamic types, so the qualified call reaches the same override a virtual
+// call would, also for the classes that are not final.
+template <typename Broker>
+inline bool publishTo(Broker& broker, const std::string& channel, const std::string& message) {
+    if constexpr (std::is_same_v<Broker, MessageBroker>) {
+        return broker.publish(channel, message);
+    } else {
+        return broker.Broker::publish(channel, message);
+    }
+}
+
+template <typename Broker>
+inline size_t publishBatchTo(Broker& broker, const std::string& channel,
+                             std::span<const std::string_view> messages) {
+    if constexpr (std::is_same_v<Broker, MessageBroker>) {
+        return broker.publishBatch(channel, messages);
+    } else {
+        return broker.Broker::publishBatch(channel, messages);
+    }
+}
+
+#endif // BROKER_DISPATCH_H
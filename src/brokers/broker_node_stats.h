@@ -0,0 +1,294 @@
+#ifndef BROKER_NODE_STATS_H
+#define BROKER_NODE_STATS_H
+
+#include "redis_cluster_broker.h"
+#include "json_reader.h"
+#include <hiredis/hiredis.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Server-side load of every broker node over the publish window, so a
+// clustered run shows which node saturated next to the throughput it got.
+//
+// Redis: INFO at start and stop; CPU is the used_cpu_sys + used_cpu_user
+//        delta, output the total_net_output_bytes delta.
+// NATS:  GET /varz on the monitoring port (NATS_MONITOR_PORT, 8222) once a
+//        second; "cpu" is the server's own instantaneous reading, so the
+//        samples are averaged, and out_msgs / out_bytes are differenced.
+//
+// Nodes come from the broker config: REDIS_HOST, the masters of a Redis
+// cluster (CLUSTER SLOTS via the seed), or every host in NATS_URL.
+class BrokerNodeProbe {
+public:
+    struct NodeLoad {
+        std::string node;        // host:port probed
+        bool ok = false;         // both ends of the window were read
+        double cpuSeconds = 0;
+        double cpuPercent = 0;   // of one core
+        double outBytesPerSec = 0;
+        double outMsgsPerSec = -1;  // not reported by Redis
+    };
+
+    explicit BrokerNodeProbe(const std::string& brokerType) {
+        if (brokerType == "nats" || brokerType == "jetstream") {
+            nats = true;
+            int monitorPort = std::getenv("NATS_MONITOR_PORT") ? std::atoi(std::getenv("NATS_MONITOR_PORT")) : 8222;
+            std::string urls = std::getenv("NATS_URL") ? std::getenv("NATS_URL") : "nats://localhost:4222";
+            size_t begin = 0;
+            while (begin < urls.size()) {
+                size_t comma = urls.find(',', begin);
+                if (comma == std::string::npos) comma = urls.size();
+                std::string server = urls.substr(begin, comma - begin);
+                size_t scheme = server.find("://");
+                if (scheme != std::string::npos) server = server.substr(scheme + 3);
+                size_t at = server.rfind('@');
+                if (at != std::string::npos) server = server.substr(at + 1);
+                std::string host = server.substr(0, server.find(':'));
+                size_t first = host.find_first_not_of(" \t");
+                if (first != std::string::npos) addNode(host.substr(first), monitorPort);
+                begin = comma + 1;
+            }
+        } else {
+            std::string host = std::getenv("REDIS_HOST") ? std::getenv("REDIS_HOST") : "localhost";
+            int port = std::getenv("REDIS_PORT") ? std::atoi(std::getenv("REDIS_PORT")) : 6379;
+            if (brokerType == "redis-cluster") {
+                RedisClusterBroker cluster(host, port);
+                if (cluster.connect()) {
+                    for (const std::string& endpoint : cluster.masters()) {
+                        size_t colon = endpoint.rfind(':');
+                        addNode(endpoint.substr(0, colon), std::atoi(endpoint.c_str() + colon + 1));
+                    }
+                }
+            } else {
+                addNode(host, port);
+            }
+        }
+    }
+
+    ~BrokerNodeProbe() {
+        stopSampler();
+    }
+
+    BrokerNodeProbe(const BrokerNodeProbe&) = delete;
+    BrokerNodeProbe& operator=(const BrokerNodeProbe&) = delete;
+
+    void start() {
+        startTime = std::chrono::steady_clock::now();
+        for (Node& node : nodes) {
+            node.first = read(node);
+            if (node.first.ok) {
+                node.cpuPercentSum += node.first.cpuPercent;
+                node.cpuSamples++;
+            }
+        }
+        if (nats) {
+            sampler = std::thread([this] { sampleLoop(); });
+        }
+    }
+
+    void stop() {
+        stopSampler();
+        elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        for (Node& node : nodes) node.last = read(node);
+    }
+
+    std::vector<NodeLoad> results() const {
+        std::vector<NodeLoad> loads;
+        for (const Node& node : nodes) {
+            NodeLoad load;
+            load.node = node.host + ":" + std::to_string(node.port);
+            load.ok = node.first.ok && node.last.ok && elapsedSec > 0;
+            if (load.ok) {
+                load.outBytesPerSec = (node.last.outBytes - node.first.outBytes) / elapsedSec;
+                if (nats) {
+                    load.outMsgsPerSec = (node.last.outMsgs - node.first.outMsgs) / elapsedSec;
+                    load.cpuPercent = node.cpuSamples > 0 ? node.cpuPercentSum / node.cpuSamples : 0;
+                    load.cpuSeconds = load.cpuPercent / 100.0 * elapsedSec;
+                } else {
+                    load.cpuSeconds = node.last.cpuSeconds - node.first.cpuSeconds;
+                    load.cpuPercent = load.cpuSeconds / elapsedSec * 100.0;
+                }
+            }
+            loads.push_back(load);
+        }
+        return loads;
+    }
+
+    // [{"node": "redis-cluster-1:6379", "ok": true, "cpu_seconds": ..., ...}]
+    void writeJson(std::ostream& out) const {
+        out << "[";
+        bool first = true;
+        for (const NodeLoad& load : results()) {
+            out << (first ? "" : ",") << "\n      {\"node\": \"" << load.node << "\", \"ok\": "
+                << (load.ok ? "true" : "false") << std::fixed << std::setprecision(3)
+                << ", \"cpu_seconds\": " << load.cpuSeconds
+                << ", \"cpu_percent\": " << std::setprecision(1) << load.cpuPercent
+                << ", \"out_bytes_per_sec\": " << load.outBytesPerSec
+                << ", \"out_msgs_per_sec\": " << load.outMsgsPerSec << "}";
+            first = false;
+        }
+        out << (first ? "]" : "\n    ]");
+    }
+
+private:
+    struct Reading {
+        bool ok = false;
+        double cpuSeconds = 0;
+        double outBytes = 0;
+        double outMsgs = 0;
+        double cpuPercent = 0;
+    };
+
+    struct Node {
+        std::string host;
+        int port = 0;
+        Reading first;
+        Reading last;
+        double cpuPercentSum = 0;
+        int cpuSamples = 0;
+    };
+
+    bool nats = false;
+    std::vector<Node> nodes;
+    std::chrono::steady_clock::time_point startTime;
+    double elapsedSec = 0;
+
+    std::thread sampler;
+    std::mutex sampleMutex;
+    std::condition_variable sampleWake;
+    bool stopping = false;
+
+    void addNode(const std::string& host, int port) {
+        Node node;
+        node.host = host;
+        node.port = port;
+        nodes.push_back(node);
+    }
+
+    void stopSampler() {
+        if (!sampler.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(sampleMutex);
+            stopping = true;
+        }
+        sampleWake.notify_all();
+        sampler.join();
+    }
+
+    void sampleLoop() {
+        std::unique_lock<std::mutex> lock(sampleMutex);
+        while (!sampleWake.wait_for(lock, std::chrono::seconds(1), [this] { return stopping; })) {
+            lock.unlock();
+            for (Node& node : nodes) {
+                Reading reading = read(node);
+                if (reading.ok) {
+                    node.cpuPercentSum += reading.cpuPercent;
+                    node.cpuSamples++;
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    Reading read(const Node& node) const {
+        return nats ? readVarz(node) : readInfo(node);
+    }
+
+    static Reading readInfo(const Node& node) {
+        Reading reading;
+        struct timeval timeout = { 2, 0 };
+        redisContext* ctx = redisConnectWithTimeout(node.host.c_str(), node.port, timeout);
+        if (ctx == nullptr || ctx->err) {
+            if (ctx != nullptr) redisFree(ctx);
+            return reading;
+        }
+        redisSetTimeout(ctx, timeout);
+        redisReply* reply = (redisReply*)redisCommand(ctx, "INFO");
+        if (reply != nullptr && reply->type == REDIS_REPLY_STRING) {
+            std::string_view info(reply->str, reply->len);
+            reading.cpuSeconds = infoField(info, "used_cpu_sys") + infoField(info, "used_cpu_user");
+            reading.outBytes = infoField(info, "total_net_output_bytes");
+            reading.ok = info.find("used_cpu_sys:") != std::string_view::npos;
+        }
+        if (reply != nullptr) freeReplyObject(reply);
+        redisFree(ctx);
+        return reading;
+    }
+
+    // "name:value\r\n" line of an INFO reply, 0 if absent
+    static double infoField(std::string_view info, std::string_view name) {
+        size_t pos = 0;
+        while ((pos = info.find(name, pos)) != std::string_view::npos) {
+            bool lineStart = pos == 0 || info[pos - 1] == '\n';
+            size_t colon = pos + name.size();
+            if (lineStart && colon < info.size() && info[colon] == ':') {
+                return std::strtod(std::string(info.substr(colon + 1, 32)).c_str(), nullptr);
+            }
+            pos = colon;
+        }
+        return 0;
+    }
+
+    static Reading readVarz(const Node& node) {
+        Reading reading;
+        std::string body = httpGet(node.host, node.port, "/varz");
+        JsonDocument doc;
+        if (body.empty() || !doc.parse(body)) return reading;
+        reading.cpuPercent = doc.number("cpu");
+        reading.outBytes = static_cast<double>(doc.u64("out_bytes"));
+        reading.outMsgs = static_cast<double>(doc.u64("out_msgs"));
+        reading.ok = doc.at("out_msgs") != JsonDocument::NONE;
+        return reading;
+    }
+
+    // Minimal HTTP/1.0 GET; returns the body, or "" on any failure
+    static std::string httpGet(const std::string& host, int port, const char* path) {
+        struct addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* addrs = nullptr;
+        if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addrs) != 0) return "";
+
+        int fd = -1;
+        for (struct addrinfo* a = addrs; a != nullptr && fd < 0; a = a->ai_next) {
+            fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd < 0) continue;
+            struct timeval timeout = { 2, 0 };
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            if (::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        freeaddrinfo(addrs);
+        if (fd < 0) return "";
+
+        std::string request = std::string("GET ") + path + " HTTP/1.0\r\nHost: " + host + "\r\n\r\n";
+        std::string response;
+        if (send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size())) {
+            char buffer[16384];
+            ssize_t n;
+            while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) response.append(buffer, static_cast<size_t>(n));
+        }
+        close(fd);
+
+        size_t headerEnd = response.find("\r\n\r\n");
+        if (response.compare(0, 12, "HTTP/1.0 200") != 0 && response.compare(0, 12, "HTTP/1.1 200") != 0) return "";
+        return headerEnd == std::string::npos ? "" : response.substr(headerEnd + 4);
+    }
+};
+
+#endif // BROKER_NODE_STATS_H
@@ -0,0 +1,391 @@
+#ifndef JETSTREAM_BROKER_H
+#define JETSTREAM_BROKER_H
+
+#include "nats_broker.h"
+#include "dispatch_table.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+// NATS JetStream, the NATS side of the durability comparison.
+//
+// Publish:   js_PublishAsync with a bounded window of un-acked publishes
+//            (maxPending); flush() waits for the window to drain.
+// Subscribe: one pull consumer per broker instance (so every subscriber
+//            thread sees every message, like core NATS fan-out), drained
+//            with natsSubscription_Fetch in batches of fetchBatch. Every
+//            subscribe() adds its subject to that consumer's filters, so
+//            many topics still cost one consumer and one Fetch per batch.
+//
+// The stream is created on first use with the channel as its only subject,
+// or updated if it already exists.
+enum class JetStreamAckMode { Explicit, All, None };
+
+class JetStreamBroker final : public NatsBroker {
+private:
+    jsCtx* js = nullptr;
+    std::string streamName = "BENCHMARK";
+    jsStorageType storage = js_FileStorage;
+    int replicas = 1;
+    int64_t maxMsgs = -1;        // -1 = unlimited
+    int64_t maxPending = 4000;   // un-acked async publishes before js_PublishAsync stalls
+    int fetchBatch = 100;
+    JetStreamAckMode ackMode = JetStreamAckMode::Explicit;
+    std::string consumerName;
+    natsSubscription* pullSub = nullptr;  // bound to consumerName once it exists
+    std::vector<std::string> filterSubjects;  // the consumer's filters, one per subscribe()
+    DispatchTable exactHandlers;
+    std::vector<std::pair<std::string, MessageHandler>> patternHandlers;  // wildcard subjects
+    std::vector<std::string> streamSubjects;  // empty = the channel itself
+    std::string streamSubject;   // subject the stream was last ensured for
+    std::atomic<uint64_t> publishErrors{0};
+
+    static void publishErrorHandler(jsCtx*, jsPubAckErr* pae, void* closure) {
+        auto* self = static_cast<JetStreamBroker*>(closure);
+        if (self->publishErrors.fetch_add(1, std::memory_order_relaxed) == 0) {
+            std::cerr << "JetStream publish error: "
+                      << (pae->ErrText ? pae->ErrText : natsStatus_GetText(pae->Err)) << std::endl;
+        }
+    }
+
+    bool ensureStream(const std::string& subject) {
+        if (subject == streamSubject) return true;
+
+        // With explicit subjects (multi-topic runs) the stream is ensured once
+        // for all of them, not per channel
+        std::vector<const char*> subjects;
+        if (streamSubjects.empty()) {
+            subjects.push_back(subject.c_str());
+        } else {
+            if (!streamSubject.empty()) return true;
+            for (const auto& s : streamSubjects) subjects.push_back(s.c_str());
+        }
+        jsStreamConfig cfg;
+        jsStreamConfig_Init(&cfg);
+        cfg.Name = streamName.c_str();
+        cfg.Subjects = subjects.data();
+        cfg.SubjectsLen = static_cast<int>(subjects.size());
+        cfg.Storage = storage;
+        cfg.Replicas = replicas;
+        cfg.MaxMsgs = maxMsgs;
+
+        jsStreamInfo* info = nullptr;
+        jsErrCode jerr{};
+        natsStatus status = js_AddStream(&info, js, &cfg, nullptr, &jerr);
+        if (status != NATS_OK) {
+            // Already there (e.g. created by another subscriber): bring its config in line
+            status = js_UpdateStream(&info, js, &cfg, nullptr, &jerr);
+        }
+        if (info != nullptr) {
+            jsStreamInfo_Destroy(info);
+        }
+        if (status != NATS_OK) {
+            std::cerr << "JetStream: could not create stream " << streamName << ": "
+                      << natsStatus_GetText(status) << " (" << jerr << ")" << std::endl;
+            return false;
+        }
+        streamSubject = subject;
+        return true;
+    }
+
+public:
+    JetStreamBroker(const std::string& u = "nats://localhost:4222")
+        : NatsBroker(u) {
+        static std::atomic<int> instances{0};
+        const char* hostname = std::getenv("HOSTNAME");
+        consumerName = std::string(hostname ? hostname : "local") + "-" +
+                       std::to_string(getpid()) + "-" + std::to_string(instances++);
+    }
+
+    ~JetStreamBroker() override {
+        disconnect();
+    }
+
+    // Must be called before connect(). Zero/empty arguments keep the defaults.
+    void setStreamOptions(const std::string& name, const std::string& storageType, int replicaCount,
+                          int64_t maxMessages) {
+        if (!name.empty()) streamName = name;
+        storage = (storageType == "memory") ? js_MemoryStorage : js_FileStorage;
+        if (replicaCount > 0) replicas = replicaCount;
+        if (maxMessages > 0) maxMsgs = maxMessages;
+    }
+
+    // Subjects the stream captures, e.g. "benchmark_channel" and
+    // "benchmark_channel.>" when publishing over many topics. By default the
+    // stream covers just the channel in use.
+    void setStreamSubjects(std::vector<std::string> subjects) {
+        streamSubjects = std::move(subjects);
+    }
+
+    void setPublishWindow(int maxPendingPublishes) {
+        if (maxPendingPublishes > 0) maxPending = maxPendingPublishes;
+    }
+
+    void setFetchOptions(int batch, JetStreamAckMode mode) {
+        if (batch > 0) fetchBatch = batch;
+        ackMode = mode;
+    }
+
+    static JetStreamAckMode parseAckMode(const std::string& mode) {
+        if (mode == "all") return JetStreamAckMode::All;
+        if (mode == "none") return JetStreamAckMode::None;
+        return JetStreamAckMode::Explicit;
+    }
+
+    bool connect() override {
+        if (!NatsBroker::connect()) return false;
+
+        jsOptions opts;
+        jsOptions_Init(&opts);
+        opts.PublishAsync.MaxPending = maxPending;
+        opts.PublishAsync.ErrHandler = publishErrorHandler;
+        opts.PublishAsync.ErrHandlerClosure = this;
+        return natsConnection_JetStream(&js, conn, &opts) == NATS_OK;
+    }
+
+    void disconnect() override {
+        if (js != nullptr) {
+            flush();
+            if (publishErrors.load(std::memory_order_relaxed) > 0) {
+                std::cerr << "JetStream: " << publishErrors.load(std::memory_order_relaxed)
+                          << " publishes were not acknowledged" << std::endl;
+            }
+            if (pullSub != nullptr) {
+                // The consumer was created by us, not the library, so it
+                // outlives the subscription unless deleted
+                natsSubscription_Unsubscribe(pullSub);
+                natsSubscription_Destroy(pullSub);
+                pullSub = nullptr;
+                js_DeleteConsumer(js, streamName.c_str(), consumerName.c_str(), nullptr, nullptr);
+            }
+            filterSubjects.clear();
+            exactHandlers.clear();
+            patternHandlers.clear();
+            jsCtx_Destroy(js);
+            js = nullptr;
+        }
+        NatsBroker::disconnect();
+    }
+
+    bool publish(const std::string& channel, const std::string& message) override {
+        if (js == nullptr || !ensureStream(channel)) return false;
+        // Blocks (up to the stall wait) once maxPending publishes are un-acked
+        return js_PublishAsync(js, channel.c_str(), message.data(),
+                               static_cast<int>(message.length()), nullptr) == NATS_OK;
+    }
+
+    size_t publishBatch(const std::string& channel, std::span<const std::string_view> messages) override {
+        if (js == nullptr || !ensureStream(channel)) return 0;
+        size_t accepted = 0;
+        for (std::string_view message : messages) {
+            if (js_PublishAsync(js, channel.c_str(), message.data(),
+                                static_cast<int>(message.length()), nullptr) != NATS_OK) break;
+            accepted++;
+        }
+        return accepted;
+    }
+
+    void flush() override {
+        if (js == nullptr) return;
+        jsPubOptions opts;
+        std::memset(&opts, 0, sizeof(opts));
+        opts.MaxWait = 10000;
+        if (js_PublishAsyncComplete(js, &opts) != NATS_OK) {
+            std::cerr << "JetStream: timed out waiting for publish acks" << std::endl;
+        }
+    }
+
+    using MessageBroker::subscribe;
+
+    bool subscribe(const std::string& channel, MessageHandler callback) override {
+        if (js == nullptr || !ensureStream(channel)) return false;
+
+        filterSubjects.push_back(channel);
+        if (!ensureConsumer()) {
+            filterSubjects.pop_back();
+            return false;
+        }
+        if (isWildcard(channel)) {
+            patternHandlers.emplace_back(channel, std::move(callback));
+        } else {
+            exactHandlers.add(channel, std::move(callback));
+        }
+        return true;
+    }
+
+    // The pull consumer's filter subject may be a wildcard, as long as the
+    // stream covers it (see setStreamSubjects)
+    bool subscribePattern(const std::string& pattern, MessageHandler callback) override {
+        return subscribe(pattern, std::move(callback));
+    }
+
+    void unsubscribe(const std::string& channel) override {
+        auto it = std::find(filterSubjects.begin(), filterSubjects.end(), channel);
+        if (it == filterSubjects.end()) return;
+        filterSubjects.erase(it);
+        exactHandlers.erase(channel);
+        patternHandlers.erase(std::remove_if(patternHandlers.begin(), patternHandlers.end(),
+                                             [&](const auto& entry) { return entry.first == channel; }),
+                              patternHandlers.end());
+        // A consumer needs at least one filter to stay narrower than the stream
+        if (filterSubjects.empty() && pullSub != nullptr) {
+            natsSubscription_Unsubscribe(pullSub);
+            natsSubscription_Destroy(pullSub);
+            pullSub = nullptr;
+            js_DeleteConsumer(js, streamName.c_str(), consumerName.c_str(), nullptr, nullptr);
+        } else {
+            ensureConsumer();
+        }
+    }
+
+    void processMessages(int timeoutMs = 1000) override {
+        if (js == nullptr) return;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (pullSub != nullptr) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return;
+
+            natsMsgList list = { nullptr, 0 };
+            jsErrCode jerr{};
+            natsStatus status = natsSubscription_Fetch(&list, pullSub, fetchBatch, remaining, &jerr);
+            if (status == NATS_OK) {
+                dispatchBatch(list);
+            } else if (status != NATS_TIMEOUT) {
+                nats_Sleep(1);
+            }
+            natsMsgList_Destroy(&list);
+        }
+    }
+
+    BrokerStats getStats() const override {
+        BrokerStats stats = NatsBroker::getStats();
+        int64_t dropped = 0;
+        if (pullSub != nullptr && natsSubscription_GetDropped(pullSub, &dropped) == NATS_OK && dropped > 0) {
+            stats.droppedMessages += static_cast<uint64_t>(dropped);
+        }
+        return stats;
+    }
+
+    std::string getName() const override {
+        return "JetStream";
+    }
+
+    std::string getPublishMode() const override {
+        return "async window=" + std::to_string(maxPending);
+    }
+
+private:
+    // Create the consumer on the first subscribe(), and widen its filters on
+    // later ones. It is updated in place, so it keeps its position and
+    // START, once published, cannot fall between two consumers.
+    bool ensureConsumer() {
+        jsConsumerConfig cfg;
+        jsConsumerConfig_Init(&cfg);
+        cfg.Durable = consumerName.c_str();
+        cfg.DeliverPolicy = js_DeliverNew;
+        cfg.AckPolicy = (ackMode == JetStreamAckMode::All) ? js_AckAll
+                      : (ackMode == JetStreamAckMode::None) ? js_AckNone
+                      : js_AckExplicit;
+        // Left behind by a subscriber that died: the server removes it
+        cfg.InactiveThreshold = 5LL * 60 * 1000000000;
+        std::vector<const char*> filters;
+        for (const auto& subject : filterSubjects) filters.push_back(subject.c_str());
+        if (filters.size() == 1) {
+            cfg.FilterSubject = filters.front();
+        } else {
+            cfg.FilterSubjects = filters.data();
+            cfg.FilterSubjectsLen = static_cast<int>(filters.size());
+        }
+
+        jsConsumerInfo* info = nullptr;
+        jsErrCode jerr{};
+        natsStatus status = pullSub == nullptr
+            ? js_AddConsumer(&info, js, streamName.c_str(), &cfg, nullptr, &jerr)
+            : js_UpdateConsumer(&info, js, streamName.c_str(), &cfg, nullptr, &jerr);
+        if (info != nullptr) {
+            jsConsumerInfo_Destroy(info);
+        }
+        if (status != NATS_OK) {
+            std::cerr << "JetStream: could not set up consumer " << consumerName << ": "
+                      << natsStatus_GetText(status) << " (" << jerr << ")" << std::endl;
+            return false;
+        }
+        if (pullSub != nullptr) return true;
+
+        // Bind to the consumer; its filters decide the subjects
+        jsSubOptions so;
+        jsSubOptions_Init(&so);
+        so.Stream = streamName.c_str();
+        so.Consumer = consumerName.c_str();
+        status = js_PullSubscribe(&pullSub, js, nullptr, consumerName.c_str(), nullptr, &so, &jerr);
+        if (status != NATS_OK) {
+            std::cerr << "JetStream: pull subscribe failed: " << natsStatus_GetText(status)
+                      << " (" << jerr << ")" << std::endl;
+            pullSub = nullptr;
+            js_DeleteConsumer(js, streamName.c_str(), consumerName.c_str(), nullptr, nullptr);
+            return false;
+        }
+        return true;
+    }
+
+    static bool isWildcard(const std::string& subject) {
+        return subject.find_first_of("*>") != std::string::npos;
+    }
+
+    // NATS subject matching: '*' is one token, a trailing '>' one or more
+    static bool subjectMatches(std::string_view pattern, std::string_view subject) {
+        while (true) {
+            size_t patternDot = pattern.find('.');
+            size_t subjectDot = subject.find('.');
+            std::string_view token = pattern.substr(0, patternDot);
+            if (token == ">") return !subject.empty();
+            if (subject.empty()) return false;
+            if (token != "*" && token != subject.substr(0, subjectDot)) return false;
+            if (patternDot == std::string_view::npos || subjectDot == std::string_view::npos) {
+                return patternDot == subjectDot;
+            }
+            pattern.remove_prefix(patternDot + 1);
+            subject.remove_prefix(subjectDot + 1);
+        }
+    }
+
+    // The handler for a delivered subject: the exact subscription, else the
+    // first pattern that matches it
+    const MessageHandler* handlerFor(std::string_view subject) {
+        if (const MessageHandler* handler = exactHandlers.find(subject)) return handler;
+        for (const auto& entry : patternHandlers) {
+            if (subjectMatches(entry.first, subject)) return &entry.second;
+        }
+        return nullptr;
+    }
+
+    void dispatchBatch(const natsMsgList& list) {
+        // One timestamp per fetched batch: that is when it was handed to us
+        uint64_t receivedAt = wallClockNs();
+        for (int i = 0; i < list.Count; i++) {
+            natsMsg* msg = list.Msgs[i];
+            MessageView view;
+            view.channel = natsMsg_GetSubject(msg);
+            view.payload = std::string_view(natsMsg_GetData(msg), natsMsg_GetDataLength(msg));
+            view.receiveTimestampNs = receivedAt;
+
+            if (const MessageHandler* handler = handlerFor(view.channel)) (*handler)(view);
+            if (ackMode == JetStreamAckMode::Explicit) {
+                natsMsg_Ack(msg, nullptr);
+            }
+        }
+        // AckAll: acknowledging the last message covers the whole batch
+        if (ackMode == JetStreamAckMode::All && list.Count > 0) {
+            natsMsg_Ack(list.Msgs[list.Count - 1], nullptr);
+        }
+    }
+};
+
+#endif // JETSTREAM_BROKER_H
@@ -2,27 +2,147 @@
 #define NATS_BROKER_H
 
 #include "message_broker.h"
+#include "benchmark_common.h"
+#include "hot_path_stats.h"
 #include <nats.h>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
 #include <map>
+#include <memory>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// How subscriptions get their messages from nats.c:
+//   Async - library default, one delivery thread per subscription
+//   Pool  - shared delivery thread pool (nats_SetMessageDeliveryPoolSize)
+//   Sync  - natsSubscription_NextMsg polled from processMessages()
+// Async and Pool may call handlers of different subscriptions from
+// different threads at once. A caller whose subscriptions share one
+// single-writer handler must use Sync, or Pool with a single thread.
+enum class NatsDeliveryMode { Async, Pool, Sync };
 
 class NatsBroker : public MessageBroker {
-private:
+protected:
     natsConnection* conn = nullptr;
     std::string url;
-    std::map<std::string, natsSubscription*> subscriptions;
-    std::map<std::string, std::function<void(const std::string&)>> callbacks;
+    size_t serverIndex = 0;
+    // One entry per subscription, handed to nats.c as the callback closure,
+    // so delivery goes straight to the handler without a subject lookup
+    // (wildcard subscriptions could not be found by subject anyway)
+    struct Subscription {
+        natsSubscription* sub = nullptr;
+        MessageHandler handler;
+    };
+    std::map<std::string, std::unique_ptr<Subscription>> subscriptions;
+    
+    NatsDeliveryMode deliveryMode = NatsDeliveryMode::Async;
+    int deliveryPoolSize = 1;
+    int pendingMsgsLimit = 0;   // 0 = library default, -1 = unlimited
+    int pendingBytesLimit = 0;
+    // nats.c reconnects on its own and resubscribes every subscription;
+    // reconnectEnabled=false turns that off, maxReconnects < 0 never gives up
+    bool reconnectEnabled = true;
+    int reconnectWaitMs = 500;
+    int maxReconnects = -1;
+    // Bumped from nats.c's callback thread, e.g. when the server cuts off
+    // a slow consumer or goes away
+    std::atomic<uint64_t> disconnects{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<uint64_t> lastDisconnectNs{0};
+    std::atomic<uint64_t> lastReconnectNs{0};
+
+    static void onDisconnected(natsConnection*, void* closure) {
+        auto* broker = static_cast<NatsBroker*>(closure);
+        broker->lastDisconnectNs.store(wallClockNs(), std::memory_order_relaxed);
+        broker->disconnects.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void onReconnected(natsConnection*, void* closure) {
+        auto* broker = static_cast<NatsBroker*>(closure);
+        broker->lastReconnectNs.store(wallClockNs(), std::memory_order_relaxed);
+        broker->reconnects.fetch_add(1, std::memory_order_relaxed);
+        std::cerr << "NATS reconnected after "
+                  << (broker->lastReconnectNs.load(std::memory_order_relaxed) -
+                      broker->lastDisconnectNs.load(std::memory_order_relaxed)) / 1000000 << " ms" << std::endl;
+    }
+
+    // Views into the natsMsg; valid until natsMsg_Destroy
+    static MessageView viewOf(natsMsg* msg) {
+        MessageView view;
+        view.channel = natsMsg_GetSubject(msg);
+        view.payload = std::string_view(natsMsg_GetData(msg), natsMsg_GetDataLength(msg));
+        view.receiveTimestampNs = wallClockNs();
+        return view;
+    }
+
+    static void dispatch(const Subscription& subscription, natsMsg* msg) {
+        PhaseTimer timer(HotPhase::Dispatch);
+        subscription.handler(viewOf(msg));
+        natsMsg_Destroy(msg);
+    }
 
     static void messageHandler(natsConnection* nc, natsSubscription* sub,
                               natsMsg* msg, void* closure) {
-        NatsBroker* broker = static_cast<NatsBroker*>(closure);
-        std::string channel(natsMsg_GetSubject(msg));
-        std::string message(natsMsg_GetData(msg), natsMsg_GetDataLength(msg));
+        dispatch(*static_cast<const Subscription*>(closure), msg);
+    }
+
+    // Trampoline per handler type: the closure is the handler itself
+    template <typename Handler>
+    static void deliverTo(natsConnection*, natsSubscription*, natsMsg* msg, void* closure) {
+        PhaseTimer timer(HotPhase::Dispatch);
+        (*static_cast<Handler*>(closure))(viewOf(msg));
+        natsMsg_Destroy(msg);
+    }
+
+    // Shared by subscribe() and subscribeDirect(); callback/closure are used
+    // unless delivery is Sync
+    bool createSubscription(const std::string& channel, std::unique_ptr<Subscription> subscription,
+                            natsMsgHandler callback, void* closure) {
+        if (!isConnected()) return false;
+        
+        // Replacing a subscription: drop the old one before its closure goes away
+        unsubscribe(channel);
         
-        auto it = broker->callbacks.find(channel);
-        if (it != broker->callbacks.end()) {
-            it->second(message);
+        natsSubscription* sub = nullptr;
+        natsStatus status = (deliveryMode == NatsDeliveryMode::Sync)
+            ? natsConnection_SubscribeSync(&sub, conn, channel.c_str())
+            : natsConnection_Subscribe(&sub, conn, channel.c_str(), callback, closure);
+        
+        if (status != NATS_OK) {
+            return false;
         }
-        natsMsg_Destroy(msg);
+        
+        if (pendingMsgsLimit != 0 || pendingBytesLimit != 0) {
+            // nats.c defaults: 65536 messages, 64 MB
+            int msgs = pendingMsgsLimit != 0 ? pendingMsgsLimit : 65536;
+            int bytes = pendingBytesLimit != 0 ? pendingBytesLimit : 64 * 1024 * 1024;
+            if (natsSubscription_SetPendingLimits(sub, msgs, bytes) != NATS_OK) {
+                std::cerr << "Warning: Failed to set NATS pending limits" << std::endl;
+            }
+        }
+        
+        subscription->sub = sub;
+        subscriptions[channel] = std::move(subscription);
+        return true;
+    }
+
+    // url split on commas, blanks trimmed
+    std::vector<std::string> serverList() const {
+        std::vector<std::string> servers;
+        size_t begin = 0;
+        while (begin <= url.size()) {
+            size_t comma = url.find(',', begin);
+            if (comma == std::string::npos) comma = url.size();
+            std::string server = url.substr(begin, comma - begin);
+            size_t first = server.find_first_not_of(" \t");
+            size_t last = server.find_last_not_of(" \t");
+            if (first != std::string::npos) servers.push_back(server.substr(first, last - first + 1));
+            begin = comma + 1;
+        }
+        return servers;
     }
 
 public:
@@ -33,19 +153,87 @@ public:
         disconnect();
     }
     
+    // Must be called before connect(). Pending limits apply to every
+    // subscription created afterwards; nats.c drops (and counts) messages
+    // beyond them instead of buffering without bound.
+    void setDeliveryOptions(NatsDeliveryMode mode, int poolSize, int pendingMsgs, int pendingBytes) {
+        deliveryMode = mode;
+        deliveryPoolSize = poolSize > 0 ? poolSize : 1;
+        pendingMsgsLimit = pendingMsgs;
+        pendingBytesLimit = pendingBytes;
+    }
+    
+    // With a comma-separated NATS_URL (a cluster), connect to server
+    // index % count first and fail over in list order, so clients given
+    // consecutive indexes spread evenly over the nodes instead of wherever
+    // nats.c's random pick lands. Must be called before connect().
+    void setServerIndex(size_t index) {
+        serverIndex = index;
+    }
+
+    // Must be called before connect()
+    void setReconnect(bool enabled, int waitMs, int maxAttempts = -1) {
+        reconnectEnabled = enabled;
+        if (waitMs > 0) reconnectWaitMs = waitMs;
+        maxReconnects = maxAttempts;
+    }
+
+    // Consecutive indexes for the brokers this process creates, offset by
+    // a hash of the host name so that processes spread as well as threads
+    static size_t nextServerIndex() {
+        static std::atomic<size_t> next{ std::hash<std::string>{}(
+            std::getenv("HOSTNAME") ? std::getenv("HOSTNAME") : "local") };
+        return next++;
+    }
+
+    static NatsDeliveryMode parseDeliveryMode(const std::string& mode) {
+        if (mode == "pool") return NatsDeliveryMode::Pool;
+        if (mode == "sync") return NatsDeliveryMode::Sync;
+        return NatsDeliveryMode::Async;
+    }
+    
     bool connect() override {
-        natsStatus status = natsConnection_ConnectTo(&conn, url.c_str());
+        natsOptions* opts = nullptr;
+        if (natsOptions_Create(&opts) != NATS_OK) return false;
+        std::vector<std::string> servers = serverList();
+        natsStatus status;
+        if (servers.size() > 1) {
+            std::vector<const char*> ordered;
+            for (size_t i = 0; i < servers.size(); i++) {
+                ordered.push_back(servers[(serverIndex + i) % servers.size()].c_str());
+            }
+            status = natsOptions_SetServers(opts, ordered.data(), static_cast<int>(ordered.size()));
+            if (status == NATS_OK) status = natsOptions_SetNoRandomize(opts, true);
+        } else {
+            status = natsOptions_SetURL(opts, url.c_str());
+        }
+        
+        if (status == NATS_OK) status = natsOptions_SetDisconnectedCB(opts, onDisconnected, this);
+        if (status == NATS_OK) status = natsOptions_SetReconnectedCB(opts, onReconnected, this);
+        if (status == NATS_OK) status = natsOptions_SetAllowReconnect(opts, reconnectEnabled);
+        if (status == NATS_OK) status = natsOptions_SetMaxReconnect(opts, maxReconnects);
+        if (status == NATS_OK) status = natsOptions_SetReconnectWait(opts, reconnectWaitMs);
+        if (status == NATS_OK && deliveryMode == NatsDeliveryMode::Pool) {
+            // Process-wide setting; every connection using the pool shares it
+            status = nats_SetMessageDeliveryPoolSize(deliveryPoolSize);
+            if (status == NATS_OK) {
+                status = natsOptions_UseGlobalMessageDelivery(opts, true);
+            }
+        }
+        if (status == NATS_OK) {
+            status = natsConnection_Connect(&conn, opts);
+        }
+        natsOptions_Destroy(opts);
         return status == NATS_OK;
     }
     
     void disconnect() override {
-        for (auto& sub : subscriptions) {
-            if (sub.second != nullptr) {
-                natsSubscription_Destroy(sub.second);
+        for (auto& entry : subscriptions) {
+            if (entry.second->sub != nullptr) {
+                natsSubscription_Destroy(entry.second->sub);
             }
         }
         subscriptions.clear();
-        callbacks.clear();
         
         if (conn != nullptr) {
             natsConnection_Close(conn);
@@ -60,54 +248,127 @@ public:
     
     bool publish(const std::string& channel, const std::string& message) override {
         if (!isConnected()) return false;
+        PhaseTimer timer(HotPhase::Format);
         natsStatus status = natsConnection_Publish(conn, channel.c_str(),
                                                    message.c_str(), message.length());
         return status == NATS_OK;
     }
     
+    // Back-to-back publishes into nats.c's write buffer; its flusher thread
+    // sends them, so there is nothing to wait for per batch
+    size_t publishBatch(const std::string& channel, std::span<const std::string_view> messages) override {
+        if (!isConnected()) return 0;
+        PhaseTimer timer(HotPhase::Format);
+        size_t accepted = 0;
+        for (std::string_view message : messages) {
+            if (natsConnection_Publish(conn, channel.c_str(), message.data(),
+                                       static_cast<int>(message.length())) != NATS_OK) break;
+            accepted++;
+        }
+        return accepted;
+    }
+    
     void flush() override {
         if (isConnected()) {
+            PhaseTimer timer(HotPhase::Write);
             natsConnection_Flush(conn);
         }
     }
     
-    bool subscribe(const std::string& channel,
-                  std::function<void(const std::string&)> callback) override {
-        if (!isConnected()) return false;
-        
-        natsSubscription* sub = nullptr;
-        natsStatus status = natsConnection_Subscribe(&sub, conn, channel.c_str(),
-                                                     messageHandler, this);
-        
-        if (status != NATS_OK) {
-            return false;
+    using MessageBroker::subscribe;
+    
+    bool subscribe(const std::string& channel, MessageHandler callback) override {
+        auto subscription = std::make_unique<Subscription>();
+        subscription->handler = std::move(callback);
+        void* closure = subscription.get();
+        return createSubscription(channel, std::move(subscription), messageHandler, closure);
+    }
+    
+    // Subscribe with a concrete callable instead of a MessageHandler: nats.c
+    // calls deliverTo<Handler> directly, so there is no std::function hop per
+    // message. handler must outlive the subscription. Sync delivery has no
+    // callback and goes through subscribe().
+    template <typename Handler>
+    bool subscribeDirect(const std::string& channel, Handler& handler) {
+        if (deliveryMode == NatsDeliveryMode::Sync) {
+            return subscribe(channel, MessageHandler([&handler](const MessageView& message) { handler(message); }));
         }
-        
-        subscriptions[channel] = sub;
-        callbacks[channel] = callback;
-        return true;
+        return createSubscription(channel, std::make_unique<Subscription>(), deliverTo<Handler>, &handler);
+    }
+    
+    // NATS subjects take wildcards natively ("a.*", "a.>")
+    bool subscribePattern(const std::string& pattern, MessageHandler callback) override {
+        return subscribe(pattern, std::move(callback));
     }
     
     void unsubscribe(const std::string& channel) override {
         auto it = subscriptions.find(channel);
         if (it != subscriptions.end()) {
-            natsSubscription_Unsubscribe(it->second);
-            natsSubscription_Destroy(it->second);
+            natsSubscription_Unsubscribe(it->second->sub);
+            natsSubscription_Destroy(it->second->sub);
             subscriptions.erase(it);
         }
-        callbacks.erase(channel);
     }
     
     void processMessages(int timeoutMs = 1000) override {
         if (!isConnected()) return;
-        // NATS handles message delivery asynchronously via callbacks
-        // Just sleep briefly to allow message processing
-        nats_Sleep(timeoutMs);
+        
+        if (deliveryMode != NatsDeliveryMode::Sync) {
+            // NATS handles message delivery asynchronously via callbacks
+            // Just sleep briefly to allow message processing
+            nats_Sleep(timeoutMs);
+            return;
+        }
+        
+        // Sync mode: pull from our own loop. With one subscription block on it;
+        // with several, round-robin with short waits so none starves.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!subscriptions.empty()) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return;
+            int64_t wait = subscriptions.size() == 1 ? remaining : 1;
+            
+            for (auto& entry : subscriptions) {
+                natsMsg* msg = nullptr;
+                Subscription& subscription = *entry.second;
+                natsStatus status = natsSubscription_NextMsg(&msg, subscription.sub, wait);
+                while (status == NATS_OK) {
+                    dispatch(subscription, msg);
+                    if (std::chrono::steady_clock::now() >= deadline) return;
+                    // Drain whatever is already queued with a minimal wait
+                    status = natsSubscription_NextMsg(&msg, subscription.sub, 1);
+                }
+                if (status != NATS_TIMEOUT && status != NATS_SLOW_CONSUMER) {
+                    nats_Sleep(1);
+                }
+            }
+        }
+    }
+    
+    BrokerStats getStats() const override {
+        BrokerStats stats;
+        for (const auto& entry : subscriptions) {
+            int64_t dropped = 0;
+            if (natsSubscription_GetDropped(entry.second->sub, &dropped) == NATS_OK && dropped > 0) {
+                stats.droppedMessages += static_cast<uint64_t>(dropped);
+            }
+        }
+        stats.disconnects = disconnects.load(std::memory_order_relaxed);
+        stats.reconnects = reconnects.load(std::memory_order_relaxed);
+        stats.lastDisconnectNs = lastDisconnectNs.load(std::memory_order_relaxed);
+        stats.lastReconnectNs = lastReconnectNs.load(std::memory_order_relaxed);
+        return stats;
     }
     
     std::string getName() const override {
         return "NATS";
     }
+    
+    std::string getPublishMode() const override {
+        // nats.c buffers publishes and flushes them from its own flusher thread
+        return "buffered";
+    }
 };
 
 #endif // NATS_BROKER_H
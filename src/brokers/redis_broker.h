@@ -2,25 +2,56 @@
 #define REDIS_BROKER_H
 
 #include "message_broker.h"
+#include "benchmark_common.h"
+#include "resp_reader.h"
+#include "arena_replies.h"
+#include "dispatch_table.h"
+#include "hot_path_stats.h"
 #include <hiredis/hiredis.h>
+#include <hiredis/sds.h>
+#include <cerrno>
 #include <cstring>
-#include <map>
 #include <chrono>
 #include <iostream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 
 class RedisBroker : public MessageBroker {
-private:
+protected:
     redisContext* ctx = nullptr;
     redisContext* subCtx = nullptr;
     std::string host;
     int port;
-    std::map<std::string, std::function<void(const std::string&)>> callbacks;
+    DispatchTable callbacks;         // SUBSCRIBE, keyed by channel
+    DispatchTable patternCallbacks;  // PSUBSCRIBE, keyed by pattern
     int pipelineCount = 0;
-    const int BATCH_SIZE = 1000;  // Balanced for throughput and responsiveness
+    int pipelineSize = 0;  // 0 = synchronous PUBLISH, >0 = drain replies every N commands
+    std::chrono::microseconds pipelineFlushInterval{0};  // 0 = no time-based drain
+    std::chrono::steady_clock::time_point pipelineFirstPending;
     bool timeoutConfigured = false;  // Per-instance timeout tracking
+    
+    // Subscriber side: the raw reader parses pushes straight off the socket;
+    // the hiredis path (redisGetReply per message) is kept for comparison
+    bool useRawReader = true;
+    bool subscriberFailed = false;
+    uint64_t subscriberDisconnects = 0;  // times the subscriber connection was lost
+    uint64_t subscriberReconnects = 0;
+    uint64_t lastDisconnectNs = 0;
+    uint64_t lastReconnectNs = 0;
+    // Lost connections are reopened every reconnectInterval when enabled;
+    // the subscriber replays its subscriptions on the new one
+    bool reconnectEnabled = false;
+    std::chrono::milliseconds reconnectInterval{500};
+    std::chrono::steady_clock::time_point nextSubscriberAttempt;
+    std::chrono::steady_clock::time_point nextPublisherAttempt;
+    RespPushReader pushReader;
+    // > 0: hiredis replies on subCtx are built in the receiving thread's
+    // arena (arena_replies.h), rewound every replyArenaBatch messages
+    size_t replyArenaBatch = 0;
 
 public:
     RedisBroker(const std::string& h = "localhost", int p = 6379)
@@ -72,20 +103,72 @@ public:
         return ctx != nullptr && ctx->err == 0;
     }
     
+    // Switch publish() to pipelined mode: commands are appended to the output
+    // buffer and replies are drained once maxPending commands are queued or
+    // flushIntervalUs has elapsed since the oldest undrained command.
+    void setPipelining(int maxPending, int flushIntervalUs) {
+        pipelineSize = maxPending > 0 ? maxPending : 0;
+        pipelineFlushInterval = std::chrono::microseconds(flushIntervalUs > 0 ? flushIntervalUs : 0);
+    }
+    
+    bool isPipelined() const {
+        return pipelineSize > 0;
+    }
+    
+    // Select the subscriber read path; must be called before subscribe()
+    void setRawSubscriberReader(bool raw) {
+        useRawReader = raw;
+    }
+    
+    // Reopen lost connections instead of giving up on them
+    void setReconnect(bool enabled, int intervalMs) {
+        reconnectEnabled = enabled;
+        if (intervalMs > 0) reconnectInterval = std::chrono::milliseconds(intervalMs);
+    }
+    
+    // Build subscriber replies in an arena (hiredis reader and Streams
+    // paths; the raw reader has no reply objects). 0 keeps malloc.
+    void setReplyArena(size_t batchMessages) {
+        replyArenaBatch = batchMessages;
+    }
+    
     bool publish(const std::string& channel, const std::string& message) override {
-        if (!isConnected()) return false;
+        if (!isConnected() && !reconnectPublisher()) return false;
+        const char* argv[MAX_PUBLISH_ARGS];
+        size_t argvlen[MAX_PUBLISH_ARGS];
+        int argc = formatPublish(channel, message, argv, argvlen);
+        return sendCommand(argc, argv, argvlen);
+    }
+    
+    // All commands are appended to the output buffer and written in one go
+    // when their replies are drained, whatever the publish mode
+    size_t publishBatch(const std::string& channel, std::span<const std::string_view> messages) override {
+        if (!isConnected() && !reconnectPublisher()) return 0;
         
-        // Use synchronous publish with TCP_NODELAY for reliable delivery
-        // TCP_NODELAY ensures low latency despite synchronous calls
-        redisReply* reply = (redisReply*)redisCommand(ctx, "PUBLISH %s %b", 
-                                                       channel.c_str(), 
-                                                       message.c_str(), 
-                                                       message.length());
-        bool success = (reply != nullptr);
-        if (reply != nullptr) {
-            freeReplyObject(reply);
+        const char* argv[MAX_PUBLISH_ARGS];
+        size_t argvlen[MAX_PUBLISH_ARGS];
+        size_t accepted = 0;
+        {
+            PhaseTimer timer(HotPhase::Format);
+            for (std::string_view message : messages) {
+                int argc = formatPublish(channel, message, argv, argvlen);
+                if (redisAppendCommandArgv(ctx, argc, argv, argvlen) != REDIS_OK) break;
+                accepted++;
+            }
         }
-        return success;
+        
+        if (pipelineCount == 0 && accepted > 0) {
+            pipelineFirstPending = std::chrono::steady_clock::now();
+        }
+        pipelineCount += static_cast<int>(accepted);
+        
+        // Sync mode: one round trip per batch. Pipelined: the usual size/interval rule.
+        if (!isPipelined() || pipelineCount >= pipelineSize ||
+            (pipelineFlushInterval.count() > 0 &&
+             std::chrono::steady_clock::now() - pipelineFirstPending >= pipelineFlushInterval)) {
+            flush();
+        }
+        return accepted;
     }
     
     void flush() override {
@@ -94,10 +177,11 @@ public:
         int count = pipelineCount;
         pipelineCount = 0;  // Reset immediately to avoid issues
         
-        // Read all pending replies - this triggers sending buffered commands
+        // Send the buffered commands, then read all pending replies
+        bool written = writeOutput();
         for (int i = 0; i < count; i++) {
             redisReply* reply = nullptr;
-            int status = redisGetReply(ctx, (void**)&reply);
+            int status = written ? readReply(&reply) : REDIS_ERR;
             
             if (status != REDIS_OK) {
                 if (ctx->err) {
@@ -120,61 +204,51 @@ public:
         }
     }
     
-    bool subscribe(const std::string& channel,
-                  std::function<void(const std::string&)> callback) override {
-        if (subCtx == nullptr) {
-            subCtx = redisConnect(host.c_str(), port);
-            if (subCtx == nullptr || subCtx->err) {
-                return false;
-            }
-            
-            // CRITICAL: Enable TCP_NODELAY on subscription connection too
-            int fd = subCtx->fd;
-            int yes = 1;
-            if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) < 0) {
-                std::cerr << "Warning: Failed to set TCP_NODELAY on Redis subscription" << std::endl;
-            }
-            
-            // Increase socket buffer sizes
-            int sndbuf = 1024 * 1024;  // 1MB
-            int rcvbuf = 1024 * 1024;  // 1MB
-            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
-            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
-        }
-        
-        callbacks[channel] = callback;
-        
-        // Send SUBSCRIBE command (async)
-        if (redisAppendCommand(subCtx, "SUBSCRIBE %s", channel.c_str()) != REDIS_OK) {
+    using MessageBroker::subscribe;
+    
+    bool subscribe(const std::string& channel, MessageHandler callback) override {
+        if (!connectSubscriberContext()) {
             return false;
         }
-        
-        // Read subscription confirmation immediately
-        redisReply* reply = nullptr;
-        if (redisGetReply(subCtx, (void**)&reply) != REDIS_OK || reply == nullptr) {
+        callbacks.add(channel, std::move(callback));
+        return sendSubscribe("SUBSCRIBE", "subscribe", channel);
+    }
+    
+    // PSUBSCRIBE: pmessage pushes are dispatched by the pattern they matched
+    bool subscribePattern(const std::string& pattern, MessageHandler callback) override {
+        if (!connectSubscriberContext()) {
             return false;
         }
-        
-        // Verify subscription was successful
-        bool success = (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3 &&
-                       strcmp(reply->element[0]->str, "subscribe") == 0);
-        freeReplyObject(reply);
-        
-        return success;
+        patternCallbacks.add(pattern, std::move(callback));
+        return sendSubscribe("PSUBSCRIBE", "psubscribe", pattern);
     }
     
     void unsubscribe(const std::string& channel) override {
         if (subCtx != nullptr) {
-            redisReply* reply = (redisReply*)redisCommand(subCtx, "UNSUBSCRIBE %s", channel.c_str());
-            if (reply != nullptr) {
-                freeReplyObject(reply);
+            if (useRawReader) {
+                // The ack arrives through pushReader and is ignored there
+                if (redisAppendCommand(subCtx, "UNSUBSCRIBE %s", channel.c_str()) == REDIS_OK) {
+                    writeSubscriberCommands();
+                }
+            } else {
+                redisReply* reply = (redisReply*)redisCommand(subCtx, "UNSUBSCRIBE %s", channel.c_str());
+                ArenaReplies::release(subCtx, reply, replyArenaBatch);
             }
         }
         callbacks.erase(channel);
     }
     
     void processMessages(int timeoutMs = 1000) override {
-        if (subCtx == nullptr) return;
+        if (subCtx == nullptr && !subscriberFailed) return;
+        
+        if (useRawReader) {
+            processRawMessages(timeoutMs, [this](const RespPushReader::Push& push, uint64_t receivedAt) {
+                dispatchPush(push, receivedAt);
+            });
+            return;
+        }
+        
+        if (subscriberFailed && !recoverSubscriber(timeoutMs)) return;
         
         // Configure timeout once per instance (not static!)
         if (!timeoutConfigured) {
@@ -186,6 +260,7 @@ public:
                 timeoutConfigured = true;
             }
         }
+        installReplyArena();
         
         // Process multiple messages per call for better throughput
         auto endTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
@@ -197,20 +272,31 @@ public:
             if (status == REDIS_OK && reply != nullptr) {
                 // Successfully received a message
                 if (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3) {
-                    if (strcmp(reply->element[0]->str, "message") == 0) {
-                        std::string channel = reply->element[1]->str;
-                        std::string message = reply->element[2]->str;
-                        
-                        auto it = callbacks.find(channel);
-                        if (it != callbacks.end()) {
-                            it->second(message);
-                        }
+                    // Views into the reply tree; valid until freeReplyObject
+                    const char* kind = reply->element[0]->str;
+                    const MessageHandler* handler = nullptr;
+                    MessageView view;
+                    if (strcmp(kind, "message") == 0) {
+                        view.channel = std::string_view(reply->element[1]->str, reply->element[1]->len);
+                        view.payload = std::string_view(reply->element[2]->str, reply->element[2]->len);
+                        handler = callbacks.find(view.channel);
+                    } else if (strcmp(kind, "pmessage") == 0 && reply->elements >= 4) {
+                        view.channel = std::string_view(reply->element[2]->str, reply->element[2]->len);
+                        view.payload = std::string_view(reply->element[3]->str, reply->element[3]->len);
+                        handler = patternCallbacks.find(
+                            std::string_view(reply->element[1]->str, reply->element[1]->len));
+                    }
+                    if (handler != nullptr) {
+                        PhaseTimer timer(HotPhase::Dispatch);
+                        view.receiveTimestampNs = wallClockNs();
+                        (*handler)(view);
                     }
                 }
-                freeReplyObject(reply);
+                ArenaReplies::release(subCtx, reply, replyArenaBatch);
             } else if (status == REDIS_ERR) {
-                // Check if it's just a timeout (EAGAIN/EWOULDBLOCK) which is normal
-                if (subCtx->err == REDIS_ERR_IO) {
+                // Check if it's just a timeout (EAGAIN/EWOULDBLOCK) which is normal.
+                // Any other I/O error (ECONNRESET, ETIMEDOUT...) lost the connection.
+                if (subCtx->err == REDIS_ERR_IO && (errno == EAGAIN || errno == EWOULDBLOCK)) {
                     // Clear the error - timeout is not a fatal error for pub/sub
                     subCtx->err = 0;
                     memset(subCtx->errstr, 0, sizeof(subCtx->errstr));
@@ -218,6 +304,7 @@ public:
                 } else if (subCtx->err != 0) {
                     // Actual error - log it
                     std::cerr << "Redis subscriber error: " << subCtx->errstr << std::endl;
+                    if (subCtx->err == REDIS_ERR_EOF || subCtx->err == REDIS_ERR_IO) subscriberLost();
                     break;
                 }
             } else {
@@ -227,9 +314,359 @@ public:
         }
     }
     
+    // processMessages() for a connection whose subscriptions all share one
+    // handler: pushes go straight to handler, a concrete callable, with no
+    // channel lookup or std::function call. Falls back to processMessages()
+    // on the hiredis reader.
+    template <typename Handler>
+    void processMessagesDirect(int timeoutMs, Handler& handler) {
+        if (subCtx == nullptr && !subscriberFailed) return;
+        if (!useRawReader) {
+            processMessages(timeoutMs);
+            return;
+        }
+        processRawMessages(timeoutMs, [&handler](const RespPushReader::Push& push, uint64_t receivedAt) {
+            if (push.kind != "message" && push.kind != "pmessage") return;
+            MessageView view;
+            view.channel = push.channel;
+            view.payload = push.payload;
+            view.receiveTimestampNs = receivedAt;
+            handler(view);
+        });
+    }
+    
+    BrokerStats getStats() const override {
+        BrokerStats stats;
+        stats.disconnects = subscriberDisconnects;
+        stats.reconnects = subscriberReconnects;
+        stats.lastDisconnectNs = lastDisconnectNs;
+        stats.lastReconnectNs = lastReconnectNs;
+        return stats;
+    }
+    
     std::string getName() const override {
         return "Redis";
     }
+    
+    std::string getPublishMode() const override {
+        return isPipelined() ? "pipelined" : "sync";
+    }
+
+protected:
+    static constexpr int MAX_PUBLISH_ARGS = 8;
+    
+    // Build the argv for publishing one message; returns argc. Subclasses
+    // override this to publish with a different command (e.g. XADD).
+    virtual int formatPublish(const std::string& channel, std::string_view message,
+                              const char** argv, size_t* argvlen) const {
+        argv[0] = "PUBLISH";
+        argv[1] = channel.c_str();
+        argv[2] = message.data();
+        argvlen[0] = 7;
+        argvlen[1] = channel.length();
+        argvlen[2] = message.length();
+        return 3;
+    }
+    
+    // Send one command on the publish connection: a full round trip in sync
+    // mode, or appended to the output buffer and drained in batches when
+    // pipelined. argv elements are binary-safe (lengths are explicit).
+    bool sendCommand(int argc, const char** argv, const size_t* argvlen) {
+        if (!isConnected()) return false;
+        
+        if (!appendCommand(argc, argv, argvlen)) return false;
+        
+        if (isPipelined()) {
+            
+            if (pipelineCount++ == 0) {
+                pipelineFirstPending = std::chrono::steady_clock::now();
+            }
+            
+            if (pipelineCount >= pipelineSize ||
+                (pipelineFlushInterval.count() > 0 &&
+                 std::chrono::steady_clock::now() - pipelineFirstPending >= pipelineFlushInterval)) {
+                flush();
+            }
+            return true;
+        }
+        
+        // Use synchronous commands with TCP_NODELAY for reliable delivery
+        // TCP_NODELAY ensures low latency despite synchronous calls.
+        // Same as redisCommandArgv(), split so each step can be timed.
+        redisReply* reply = nullptr;
+        if (!writeOutput() || readReply(&reply) != REDIS_OK) {
+            return false;
+        }
+        bool success = (reply != nullptr && reply->type != REDIS_REPLY_ERROR);
+        if (reply != nullptr) {
+            freeReplyObject(reply);
+        }
+        return success;
+    }
+    
+    bool appendCommand(int argc, const char** argv, const size_t* argvlen) {
+        PhaseTimer timer(HotPhase::Format);
+        return redisAppendCommandArgv(ctx, argc, argv, argvlen) == REDIS_OK;
+    }
+    
+    // Write the whole output buffer of the (blocking) publish connection,
+    // as redisGetReply() would before reading
+    bool writeOutput() {
+        PhaseTimer timer(HotPhase::Write);
+        int done = 0;
+        while (!done) {
+            size_t pending = sdslen(ctx->obuf);
+            if (redisBufferWrite(ctx, &done) != REDIS_OK) return false;
+            countWriteSyscall(pending - sdslen(ctx->obuf));
+        }
+        return true;
+    }
+    
+    // Next reply on the publish connection, reading from the socket as needed
+    int readReply(redisReply** reply) {
+        PhaseTimer timer(HotPhase::ReadReply);
+        void* next = nullptr;
+        if (redisGetReplyFromReader(ctx, &next) != REDIS_OK) return REDIS_ERR;
+        while (next == nullptr) {
+            size_t buffered = ctx->reader->len;
+            if (redisBufferRead(ctx) != REDIS_OK) return REDIS_ERR;
+            countReadSyscall(ctx->reader->len - buffered);
+            if (redisGetReplyFromReader(ctx, &next) != REDIS_OK) return REDIS_ERR;
+        }
+        *reply = static_cast<redisReply*>(next);
+        return REDIS_OK;
+    }
+    
+    // Send (P)SUBSCRIBE on the subscriber connection and wait for its ack
+    bool sendSubscribe(const char* command, const char* ackKind, const std::string& target) {
+        const char* argv[] = { command, target.c_str() };
+        size_t argvlen[] = { std::strlen(command), target.length() };
+        if (redisAppendCommandArgv(subCtx, 2, argv, argvlen) != REDIS_OK) {
+            return false;
+        }
+        
+        if (useRawReader) {
+            // From here on the socket belongs to pushReader; hiredis only formats commands
+            int flags = fcntl(subCtx->fd, F_GETFL, 0);
+            fcntl(subCtx->fd, F_SETFL, flags | O_NONBLOCK);
+            return writeSubscriberCommands() && awaitSubscribeAck(ackKind, target);
+        }
+        
+        // Read subscription confirmation immediately
+        redisReply* reply = nullptr;
+        if (redisGetReply(subCtx, (void**)&reply) != REDIS_OK || reply == nullptr) {
+            return false;
+        }
+        
+        // Verify subscription was successful
+        bool success = (reply->type == REDIS_REPLY_ARRAY && reply->elements >= 3 &&
+                       strcmp(reply->element[0]->str, ackKind) == 0);
+        ArenaReplies::release(subCtx, reply, replyArenaBatch);
+        
+        return success;
+    }
+    
+    void subscriberLost() {
+        subscriberDisconnects++;
+        subscriberFailed = true;
+        lastDisconnectNs = wallClockNs();
+        nextSubscriberAttempt = std::chrono::steady_clock::now();  // first retry right away
+    }
+    
+    // Called instead of reading while the subscriber connection is down:
+    // true once it is back with every subscription restored, otherwise
+    // waits out timeoutMs (or the retry interval, if shorter)
+    bool recoverSubscriber(int timeoutMs) {
+        auto now = std::chrono::steady_clock::now();
+        if (reconnectEnabled && now >= nextSubscriberAttempt) {
+            nextSubscriberAttempt = now + reconnectInterval;
+            if (reconnectSubscriber()) return true;
+        }
+        auto wait = std::chrono::milliseconds(timeoutMs);
+        if (reconnectEnabled && reconnectInterval < wait) wait = reconnectInterval;
+        std::this_thread::sleep_for(wait);
+        return false;
+    }
+    
+    bool reconnectSubscriber() {
+        if (subCtx != nullptr) redisFree(subCtx);
+        subCtx = nullptr;
+        pushReader.reset();
+        timeoutConfigured = false;
+        if (!connectSubscriberContext() || !restoreSubscriptions()) {
+            if (subCtx != nullptr) redisFree(subCtx);
+            subCtx = nullptr;
+            return false;
+        }
+        subscriberFailed = false;
+        subscriberReconnects++;
+        lastReconnectNs = wallClockNs();
+        std::cerr << "Redis subscriber reconnected after "
+                  << (lastReconnectNs - lastDisconnectNs) / 1000000 << " ms" << std::endl;
+        return true;
+    }
+    
+    // Replay every subscription on a fresh subCtx
+    virtual bool restoreSubscriptions() {
+        bool restored = true;
+        callbacks.forEachKey([&](const std::string& channel) {
+            restored = restored && sendSubscribe("SUBSCRIBE", "subscribe", channel);
+        });
+        patternCallbacks.forEachKey([&](const std::string& pattern) {
+            restored = restored && sendSubscribe("PSUBSCRIBE", "psubscribe", pattern);
+        });
+        return restored;
+    }
+    
+    // Reopen the publish connection, at most once per reconnectInterval.
+    // Commands pipelined on the old one are lost with it.
+    bool reconnectPublisher() {
+        if (!reconnectEnabled) return false;
+        auto now = std::chrono::steady_clock::now();
+        if (now < nextPublisherAttempt) return false;
+        nextPublisherAttempt = now + reconnectInterval;
+        if (ctx != nullptr) redisFree(ctx);
+        ctx = nullptr;
+        pipelineCount = 0;
+        if (!connect()) return false;
+        std::cerr << "Redis publisher reconnected" << std::endl;
+        return true;
+    }
+    
+    // Switch subCtx to arena replies from the thread that reads them, once
+    // no reply is half parsed
+    void installReplyArena() {
+        if (replyArenaBatch > 0 && !ArenaReplies::installed(subCtx)) {
+            ArenaReplies::install(subCtx);
+        }
+    }
+    
+    // Open the dedicated subscriber connection on first use
+    bool connectSubscriberContext() {
+        if (subCtx != nullptr) return true;
+        
+        subCtx = redisConnect(host.c_str(), port);
+        if (subCtx == nullptr || subCtx->err) {
+            return false;
+        }
+        
+        // CRITICAL: Enable TCP_NODELAY on subscription connection too
+        int fd = subCtx->fd;
+        int yes = 1;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) < 0) {
+            std::cerr << "Warning: Failed to set TCP_NODELAY on Redis subscription" << std::endl;
+        }
+        
+        // Increase socket buffer sizes
+        int sndbuf = 1024 * 1024;  // 1MB
+        int rcvbuf = 1024 * 1024;  // 1MB
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        return true;
+    }
+    
+    // Push hiredis' formatted output buffer onto the (non-blocking) socket
+    bool writeSubscriberCommands() {
+        int done = 0;
+        while (!done) {
+            if (redisBufferWrite(subCtx, &done) != REDIS_OK) {
+                std::cerr << "Redis subscriber write error: " << subCtx->errstr << std::endl;
+                return false;
+            }
+            if (!done) {
+                struct pollfd pfd = { subCtx->fd, POLLOUT, 0 };
+                if (poll(&pfd, 1, 5000) <= 0) return false;
+            }
+        }
+        return true;
+    }
+    
+    void dispatchPush(const RespPushReader::Push& push, uint64_t receiveTimestampNs) {
+        const MessageHandler* handler = nullptr;
+        if (push.kind == "message") {
+            handler = callbacks.find(push.channel);
+        } else if (push.kind == "pmessage") {
+            handler = patternCallbacks.find(push.pattern);
+        }
+        if (handler != nullptr) {
+            MessageView view;
+            view.channel = push.channel;
+            view.payload = push.payload;
+            view.receiveTimestampNs = receiveTimestampNs;
+            (*handler)(view);
+        }
+    }
+    
+    // Wait for the (P)SUBSCRIBE confirmation, dispatching anything that arrives first
+    bool awaitSubscribeAck(std::string_view ackKind, const std::string& channel) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        bool acked = false;
+        while (!acked) {
+            uint64_t now = wallClockNs();
+            pushReader.drain([&](const RespPushReader::Push& push) {
+                if (push.kind == ackKind && push.channel == channel) {
+                    acked = true;
+                } else {
+                    dispatchPush(push, now);
+                }
+            });
+            if (acked) break;
+            
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return false;
+            struct pollfd pfd = { subCtx->fd, POLLIN, 0 };
+            if (poll(&pfd, 1, static_cast<int>(remaining)) <= 0) return false;
+            ssize_t n = pushReader.readFrom(subCtx->fd);
+            if (n == 0 || n == -2) return false;
+        }
+        return true;
+    }
+    
+    // Read and dispatch pushes until timeoutMs passes without running dry,
+    // blocking in poll() instead of cycling through socket timeouts
+    template <typename Dispatch>
+    void processRawMessages(int timeoutMs, Dispatch&& dispatch) {
+        if (subscriberFailed && !recoverSubscriber(timeoutMs)) return;
+        
+        int fd = subCtx->fd;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;) {
+            ssize_t n;
+            {
+                PhaseTimer timer(HotPhase::Read);
+                n = pushReader.readFrom(fd);
+                countReadSyscall(n > 0 ? static_cast<size_t>(n) : 0);
+            }
+            if (n > 0) {
+                // One timestamp per read() batch: that is when the bytes left the kernel
+                uint64_t receivedAt = wallClockNs();
+                PhaseTimer timer(HotPhase::Dispatch);
+                pushReader.drain([&](const RespPushReader::Push& push) {
+                    dispatch(push, receivedAt);
+                });
+                if (pushReader.hasProtocolError()) {
+                    std::cerr << "Redis subscriber protocol error, dropping the connection" << std::endl;
+                    subscriberLost();
+                    return;
+                }
+                if (std::chrono::steady_clock::now() >= deadline) return;
+                continue;
+            }
+            if (n == 0 || n == -2) {
+                std::cerr << "Redis subscriber connection " << (n == 0 ? "closed" : "error: ")
+                          << (n == 0 ? "" : std::strerror(errno)) << std::endl;
+                subscriberLost();
+                return;
+            }
+            
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return;
+            struct pollfd pfd = { fd, POLLIN, 0 };
+            if (poll(&pfd, 1, static_cast<int>(remaining)) <= 0) return;
+        }
+    }
 };
 
 #endif // REDIS_BROKER_H
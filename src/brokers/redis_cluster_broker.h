@@ -0,0 +1,408 @@
+#ifndef REDIS_CLUSTER_BROKER_H
+#define REDIS_CLUSTER_BROKER_H
+
+#include "message_broker.h"
+#include "benchmark_common.h"
+#include "resp_reader.h"
+#include "dispatch_table.h"
+#include "hot_path_stats.h"
+#include <hiredis/hiredis.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// Redis Cluster sharded pub/sub (Redis 7). SPUBLISH and SSUBSCRIBE go to the
+// master owning the channel's hash slot, so a message only travels within
+// the shard that holds its channel, where plain PUBLISH is broadcast to every
+// node over the cluster bus. Spreading the load therefore takes several
+// topics (NUM_TOPICS): one channel lives on one shard.
+//
+// Publish:   one blocking connection per master, opened on first use;
+//            publishBatch() pipelines a batch (always one channel, so one
+//            node) and reads its replies, like sync RedisBroker.
+// Subscribe: one connection per master holding subscribed channels, read
+//            by RespPushReader; processMessages() polls all of them.
+//
+// The slot map comes from CLUSTER SLOTS on the seed node and is reloaded
+// when a node answers MOVED.
+class RedisClusterBroker final : public MessageBroker {
+public:
+    static constexpr int SLOTS = 16384;
+
+    struct Node {
+        std::string host;
+        int port = 0;
+        redisContext* pub = nullptr;
+        redisContext* sub = nullptr;
+        RespPushReader reader;
+        bool subFailed = false;
+    };
+
+    RedisClusterBroker(const std::string& h = "localhost", int p = 6379)
+        : seedHost(h), seedPort(p), slotOwner(SLOTS, -1) {}
+
+    ~RedisClusterBroker() override {
+        disconnect();
+    }
+
+    bool connect() override {
+        return loadSlots(seedHost, seedPort);
+    }
+
+    void disconnect() override {
+        for (auto& node : nodes) {
+            if (node->pub != nullptr) redisFree(node->pub);
+            if (node->sub != nullptr) redisFree(node->sub);
+            node->pub = nullptr;
+            node->sub = nullptr;
+        }
+    }
+
+    bool isConnected() const override {
+        return !nodes.empty();
+    }
+
+    bool publish(const std::string& channel, const std::string& message) override {
+        std::string_view view = message;
+        return publishBatch(channel, std::span<const std::string_view>(&view, 1)) == 1;
+    }
+
+    size_t publishBatch(const std::string& channel, std::span<const std::string_view> messages) override {
+        Node* node = publisherFor(channel);
+        if (node == nullptr) return 0;
+
+        {
+            PhaseTimer timer(HotPhase::Format);
+            for (std::string_view message : messages) {
+                const char* argv[] = { "SPUBLISH", channel.c_str(), message.data() };
+                size_t argvlen[] = { 8, channel.length(), message.length() };
+                redisAppendCommandArgv(node->pub, 3, argv, argvlen);
+            }
+        }
+        PhaseTimer timer(HotPhase::ReadReply);
+        size_t accepted = 0;
+        bool moved = false;
+        for (size_t i = 0; i < messages.size(); i++) {
+            redisReply* reply = nullptr;
+            if (redisGetReply(node->pub, (void**)&reply) != REDIS_OK || reply == nullptr) {
+                std::cerr << "Redis cluster publish error on " << node->host << ":" << node->port
+                          << ": " << node->pub->errstr << std::endl;
+                // The context is unusable now; the next publish reconnects
+                redisFree(node->pub);
+                node->pub = nullptr;
+                return accepted;
+            }
+            if (reply->type == REDIS_REPLY_ERROR) {
+                if (std::strncmp(reply->str, "MOVED", 5) == 0) moved = true;
+            } else {
+                accepted++;
+            }
+            freeReplyObject(reply);
+        }
+        if (moved) {
+            // Resharded under us: later publishes follow the new owner
+            loadSlots(node->host, node->port);
+        }
+        return accepted;
+    }
+
+    // Replies are read with every batch, nothing is left pending
+    void flush() override {}
+
+    using MessageBroker::subscribe;
+
+    bool subscribe(const std::string& channel, MessageHandler handler) override {
+        Node* node = subscriberFor(channel);
+        if (node == nullptr) return false;
+        callbacks.add(channel, std::move(handler));
+
+        const char* argv[] = { "SSUBSCRIBE", channel.c_str() };
+        size_t argvlen[] = { 10, channel.length() };
+        if (redisAppendCommandArgv(node->sub, 2, argv, argvlen) != REDIS_OK) return false;
+        return writeCommands(*node) && awaitAck(*node, "ssubscribe", channel);
+    }
+
+    void unsubscribe(const std::string& channel) override {
+        int owner = slotOwner[slotOf(channel)];
+        if (owner >= 0 && nodes[owner]->sub != nullptr) {
+            Node& node = *nodes[owner];
+            const char* argv[] = { "SUNSUBSCRIBE", channel.c_str() };
+            size_t argvlen[] = { 12, channel.length() };
+            // The ack arrives through the reader and is ignored there
+            if (redisAppendCommandArgv(node.sub, 2, argv, argvlen) == REDIS_OK) writeCommands(node);
+        }
+        callbacks.erase(channel);
+    }
+
+    // Read and dispatch from every subscribed node until timeoutMs passes
+    // without running dry, blocking in poll() when none has data
+    void processMessages(int timeoutMs = 1000) override {
+        std::vector<Node*> readers;
+        for (auto& node : nodes) {
+            if (node->sub != nullptr && !node->subFailed) readers.push_back(node.get());
+        }
+        if (readers.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
+            return;
+        }
+
+        std::vector<struct pollfd> fds(readers.size());
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;) {
+            bool readAny = false;
+            for (Node* node : readers) {
+                if (node->subFailed) continue;
+                ssize_t n;
+                {
+                    PhaseTimer timer(HotPhase::Read);
+                    n = node->reader.readFrom(node->sub->fd);
+                    countReadSyscall(n > 0 ? static_cast<size_t>(n) : 0);
+                }
+                if (n > 0) {
+                    readAny = true;
+                    dispatchBuffered(*node, wallClockNs());
+                } else if (n == 0 || n == -2) {
+                    std::cerr << "Redis cluster subscriber connection to " << node->host << ":" << node->port
+                              << (n == 0 ? " closed" : " failed") << std::endl;
+                    node->subFailed = true;
+                    subscriberDisconnects++;
+                }
+            }
+            if (readAny) {
+                if (std::chrono::steady_clock::now() >= deadline) return;
+                continue;
+            }
+
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return;
+            for (size_t i = 0; i < readers.size(); i++) {
+                fds[i] = { readers[i]->subFailed ? -1 : readers[i]->sub->fd, POLLIN, 0 };
+            }
+            if (poll(fds.data(), fds.size(), static_cast<int>(remaining)) <= 0) return;
+        }
+    }
+
+    BrokerStats getStats() const override {
+        BrokerStats stats;
+        stats.disconnects = subscriberDisconnects;
+        return stats;
+    }
+
+    std::string getName() const override {
+        return "Redis Cluster";
+    }
+
+    // "host:port" of every master in the slot map
+    std::vector<std::string> masters() const {
+        std::vector<std::string> endpoints;
+        for (const auto& node : nodes) endpoints.push_back(node->host + ":" + std::to_string(node->port));
+        return endpoints;
+    }
+
+    // CRC16 (XMODEM) of the key, or of its {hash tag}, modulo 16384
+    static uint16_t slotOf(std::string_view key) {
+        size_t open = key.find('{');
+        if (open != std::string_view::npos) {
+            size_t close = key.find('}', open + 1);
+            if (close != std::string_view::npos && close > open + 1) {
+                key = key.substr(open + 1, close - open - 1);
+            }
+        }
+        uint16_t crc = 0;
+        for (unsigned char c : key) {
+            crc ^= static_cast<uint16_t>(c) << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+            }
+        }
+        return crc % SLOTS;
+    }
+
+private:
+    std::string seedHost;
+    int seedPort;
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::vector<int> slotOwner;                          // slot -> index into nodes
+    std::unordered_map<std::string, Node*> routeCache;   // channel -> owning node
+    DispatchTable callbacks;
+    uint64_t subscriberDisconnects = 0;  // node subscriber connections lost
+
+    // Rebuild the slot map from CLUSTER SLOTS on host:port. Contexts of
+    // nodes that stay in the map are kept.
+    bool loadSlots(const std::string& host, int port) {
+        struct timeval timeout = { 5, 0 };
+        redisContext* ctx = redisConnectWithTimeout(host.c_str(), port, timeout);
+        if (ctx == nullptr || ctx->err) {
+            std::cerr << "Redis cluster: cannot reach " << host << ":" << port << std::endl;
+            if (ctx != nullptr) redisFree(ctx);
+            return false;
+        }
+        redisReply* reply = (redisReply*)redisCommand(ctx, "CLUSTER SLOTS");
+        bool ok = reply != nullptr && reply->type == REDIS_REPLY_ARRAY && reply->elements > 0;
+        if (!ok) {
+            std::cerr << "Redis cluster: CLUSTER SLOTS failed on " << host << ":" << port
+                      << (reply != nullptr && reply->type == REDIS_REPLY_ERROR ? std::string(": ") + reply->str : "")
+                      << std::endl;
+        }
+        for (size_t i = 0; ok && i < reply->elements; i++) {
+            // [start, end, [host, port, id], replicas...]
+            const redisReply* range = reply->element[i];
+            if (range->type != REDIS_REPLY_ARRAY || range->elements < 3) continue;
+            const redisReply* master = range->element[2];
+            if (master->type != REDIS_REPLY_ARRAY || master->elements < 2) continue;
+            // An empty host means "the node you asked"
+            std::string nodeHost = master->element[0]->len > 0 ? master->element[0]->str : host;
+            int index = nodeIndex(nodeHost, static_cast<int>(master->element[1]->integer));
+            for (long long slot = range->element[0]->integer; slot <= range->element[1]->integer && slot < SLOTS; slot++) {
+                slotOwner[slot] = index;
+            }
+        }
+        if (reply != nullptr) freeReplyObject(reply);
+        redisFree(ctx);
+        routeCache.clear();
+        return ok;
+    }
+
+    int nodeIndex(const std::string& host, int port) {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            if (nodes[i]->host == host && nodes[i]->port == port) return static_cast<int>(i);
+        }
+        auto node = std::make_unique<Node>();
+        node->host = host;
+        node->port = port;
+        nodes.push_back(std::move(node));
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    Node* ownerOf(const std::string& channel) {
+        auto cached = routeCache.find(channel);
+        if (cached != routeCache.end()) return cached->second;
+        int owner = slotOwner[slotOf(channel)];
+        Node* node = owner >= 0 ? nodes[owner].get() : nullptr;
+        if (node == nullptr) {
+            std::cerr << "Redis cluster: no node serves the slot of " << channel << std::endl;
+        }
+        routeCache.emplace(channel, node);
+        return node;
+    }
+
+    static redisContext* openContext(const Node& node) {
+        struct timeval timeout = { 5, 0 };
+        redisContext* ctx = redisConnectWithTimeout(node.host.c_str(), node.port, timeout);
+        if (ctx == nullptr || ctx->err) {
+            std::cerr << "Redis cluster: cannot connect to " << node.host << ":" << node.port << std::endl;
+            if (ctx != nullptr) redisFree(ctx);
+            return nullptr;
+        }
+        // Same socket setup as RedisBroker
+        int yes = 1;
+        setsockopt(ctx->fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        int bufferSize = 1024 * 1024;  // 1MB
+        setsockopt(ctx->fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+        setsockopt(ctx->fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+        return ctx;
+    }
+
+    Node* publisherFor(const std::string& channel) {
+        Node* node = ownerOf(channel);
+        if (node != nullptr && node->pub == nullptr) {
+            node->pub = openContext(*node);
+            if (node->pub == nullptr) return nullptr;
+            struct timeval timeout = { 5, 0 };
+            redisSetTimeout(node->pub, timeout);
+        }
+        return node;
+    }
+
+    Node* subscriberFor(const std::string& channel) {
+        Node* node = ownerOf(channel);
+        if (node != nullptr && node->sub == nullptr) {
+            node->sub = openContext(*node);
+            if (node->sub == nullptr) return nullptr;
+            // From here on the socket belongs to the reader; hiredis only formats commands
+            int flags = fcntl(node->sub->fd, F_GETFL, 0);
+            fcntl(node->sub->fd, F_SETFL, flags | O_NONBLOCK);
+        }
+        return node;
+    }
+
+    bool writeCommands(Node& node) {
+        int done = 0;
+        while (!done) {
+            if (redisBufferWrite(node.sub, &done) != REDIS_OK) {
+                std::cerr << "Redis cluster subscriber write error: " << node.sub->errstr << std::endl;
+                return false;
+            }
+            if (!done) {
+                struct pollfd pfd = { node.sub->fd, POLLOUT, 0 };
+                if (poll(&pfd, 1, 5000) <= 0) return false;
+            }
+        }
+        return true;
+    }
+
+    void dispatchBuffered(Node& node, uint64_t receivedAt) {
+        PhaseTimer timer(HotPhase::Dispatch);
+        node.reader.drain([&](const RespPushReader::Push& push) {
+            if (push.kind != "smessage") return;
+            if (const MessageHandler* handler = callbacks.find(push.channel)) {
+                MessageView view;
+                view.channel = push.channel;
+                view.payload = push.payload;
+                view.receiveTimestampNs = receivedAt;
+                (*handler)(view);
+            }
+        });
+        if (node.reader.hasProtocolError()) {
+            std::cerr << "Redis cluster subscriber protocol error, stopping reader" << std::endl;
+            node.subFailed = true;
+        }
+    }
+
+    // Wait for the SSUBSCRIBE confirmation, dispatching anything that arrives first
+    bool awaitAck(Node& node, std::string_view ackKind, const std::string& channel) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        for (;;) {
+            bool acked = false;
+            uint64_t now = wallClockNs();
+            node.reader.drain([&](const RespPushReader::Push& push) {
+                if (push.kind == ackKind && push.channel == channel) {
+                    acked = true;
+                } else if (push.kind == "smessage") {
+                    if (const MessageHandler* handler = callbacks.find(push.channel)) {
+                        MessageView view;
+                        view.channel = push.channel;
+                        view.payload = push.payload;
+                        view.receiveTimestampNs = now;
+                        (*handler)(view);
+                    }
+                }
+            });
+            if (acked) return true;
+
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return false;
+            struct pollfd pfd = { node.sub->fd, POLLIN, 0 };
+            if (poll(&pfd, 1, static_cast<int>(remaining)) <= 0) return false;
+            ssize_t n = node.reader.readFrom(node.sub->fd);
+            if (n == 0 || n == -2) return false;
+        }
+    }
+};
+
+#endif // REDIS_CLUSTER_BROKER_H
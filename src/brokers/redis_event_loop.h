@@ -0,0 +1,299 @@
+#ifndef REDIS_EVENT_LOOP_H
+#define REDIS_EVENT_LOOP_H
+
+#include <hiredis/hiredis.h>
+#include <hiredis/async.h>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+class RedisEventLoop;
+
+// One hiredis async connection driven by a RedisEventLoop. Everything that
+// touches ac - issuing commands, reply callbacks, the adapter hooks - runs
+// with lock held, so application threads and the loop thread can share it.
+struct RedisAsyncConnection {
+    redisAsyncContext* ac = nullptr;  // nullptr once hiredis has let go of it
+    std::mutex lock;
+    std::condition_variable changed;  // connected, replies drained, disconnected
+    bool connected = false;
+
+    // Owned by the loop
+    RedisEventLoop* loop = nullptr;
+    int fd = -1;
+    uint32_t events = 0;
+};
+
+// epoll adapter for hiredis' async API: one thread waits on every attached
+// connection and calls redisAsyncHandleRead/Write as sockets become ready.
+// Commands issued from other threads land in hiredis' output buffer and ask
+// for EPOLLOUT through addWrite, so writes of many commands coalesce on the
+// loop thread, and replies and pushes are parsed as they arrive.
+//
+// Connections are spread round-robin over a process-wide group of loops
+// (REDIS_ASYNC_LOOP_THREADS, default 1).
+class RedisEventLoop {
+public:
+    RedisEventLoop() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        struct epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;  // nullptr marks the wake-up eventfd
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+        thread = std::thread([this] { loop(); });
+    }
+
+    ~RedisEventLoop() {
+        stopping = true;
+        wake();
+        if (thread.joinable()) thread.join();
+        ::close(wakeFd);
+        ::close(epollFd);
+    }
+
+    RedisEventLoop(const RedisEventLoop&) = delete;
+    RedisEventLoop& operator=(const RedisEventLoop&) = delete;
+
+    // Size of the shared group; only takes effect before its first use
+    static void setSharedLoopCount(int count) {
+        sharedLoopCount() = count > 0 ? count : 1;
+    }
+
+    // Next loop of the shared group, round-robin
+    static RedisEventLoop& next() {
+        static std::atomic<size_t> cursor{0};
+        return shared(cursor.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    // A specific loop of the shared group (index modulo its size), for
+    // callers that need to know which thread their callbacks run on
+    static RedisEventLoop& shared(size_t index) {
+        const std::vector<RedisEventLoop*>& loops = sharedGroup();
+        return *loops[index % loops.size()];
+    }
+
+    static size_t sharedSize() {
+        return sharedGroup().size();
+    }
+
+    // Open conn on this loop and wait until it is connected
+    bool connect(RedisAsyncConnection& conn, const std::string& host, int port,
+                 std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+        redisAsyncContext* ac = redisAsyncConnect(host.c_str(), port);
+        if (ac == nullptr) return false;
+        if (ac->err) {
+            std::cerr << "Redis async connect error: " << ac->errstr << std::endl;
+            redisAsyncFree(ac);
+            return false;
+        }
+        tuneSocket(ac->c.fd);
+
+        std::unique_lock<std::mutex> lock(conn.lock);
+        conn.ac = ac;
+        conn.loop = this;
+        conn.fd = ac->c.fd;
+        conn.events = 0;
+        conn.connected = false;
+        ac->data = &conn;
+        ac->ev.data = &conn;
+        ac->ev.addRead = addRead;
+        ac->ev.delRead = delRead;
+        ac->ev.addWrite = addWrite;
+        ac->ev.delWrite = delWrite;
+        ac->ev.cleanup = cleanup;
+
+        struct epoll_event ev = {};
+        ev.events = 0;
+        ev.data.ptr = &conn;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, conn.fd, &ev);
+
+        // Setting the connect callback asks for the first write event,
+        // which is how hiredis detects the finished non-blocking connect
+        redisAsyncSetConnectCallback(ac, onConnect);
+        redisAsyncSetDisconnectCallback(ac, onDisconnect);
+
+        bool ok = conn.changed.wait_for(lock, timeout, [&conn] {
+            return conn.connected || conn.ac == nullptr;
+        }) && conn.connected;
+        lock.unlock();
+        if (!ok) close(conn);
+        return ok;
+    }
+
+    // Free the context on the loop thread, so no event for it is in flight.
+    // Pending reply callbacks run with a nullptr reply.
+    void close(RedisAsyncConnection& conn) {
+        run([&conn] {
+            std::lock_guard<std::mutex> lock(conn.lock);
+            if (conn.ac != nullptr) redisAsyncFree(conn.ac);
+            conn.ac = nullptr;
+            conn.connected = false;
+            conn.changed.notify_all();
+        });
+    }
+
+    // Run task on the loop thread, after the current batch of events, and wait for it
+    void run(std::function<void()> task) {
+        if (std::this_thread::get_id() == thread.get_id()) {
+            task();
+            return;
+        }
+        std::promise<void> done;
+        std::future<void> finished = done.get_future();
+        {
+            std::lock_guard<std::mutex> lock(tasksMutex);
+            tasks.push_back([&task, &done] {
+                task();
+                done.set_value();
+            });
+        }
+        wake();
+        finished.wait();
+    }
+
+private:
+    static int& sharedLoopCount() {
+        static int count = 1;
+        return count;
+    }
+
+    static const std::vector<RedisEventLoop*>& sharedGroup() {
+        // Deliberately leaked: subscriber threads never return, so the loops
+        // must outlive static destruction at exit
+        static std::vector<RedisEventLoop*>* loops = [] {
+            auto* group = new std::vector<RedisEventLoop*>();
+            for (int i = 0; i < sharedLoopCount(); i++) group->push_back(new RedisEventLoop());
+            return group;
+        }();
+        return *loops;
+    }
+
+    static void tuneSocket(int fd) {
+        // Same socket setup as the blocking RedisBroker
+        int yes = 1;
+        if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes)) < 0) {
+            std::cerr << "Warning: Failed to set TCP_NODELAY on Redis async connection" << std::endl;
+        }
+        int bufferSize = 1024 * 1024;  // 1MB
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+    }
+
+    // Adapter hooks; hiredis calls them with conn.lock held
+    static void addRead(void* data) { update(data, EPOLLIN, 0); }
+    static void delRead(void* data) { update(data, 0, EPOLLIN); }
+    static void addWrite(void* data) { update(data, EPOLLOUT, 0); }
+    static void delWrite(void* data) { update(data, 0, EPOLLOUT); }
+
+    static void update(void* data, uint32_t add, uint32_t remove) {
+        auto* conn = static_cast<RedisAsyncConnection*>(data);
+        uint32_t events = (conn->events | add) & ~remove;
+        if (events == conn->events) return;  // the common case on the publish path
+        conn->events = events;
+        struct epoll_event ev = {};
+        ev.events = events;
+        ev.data.ptr = conn;
+        epoll_ctl(conn->loop->epollFd, EPOLL_CTL_MOD, conn->fd, &ev);
+    }
+
+    static void cleanup(void* data) {
+        auto* conn = static_cast<RedisAsyncConnection*>(data);
+        epoll_ctl(conn->loop->epollFd, EPOLL_CTL_DEL, conn->fd, nullptr);
+        conn->events = 0;
+        conn->ac = nullptr;  // hiredis frees the context after this
+        conn->connected = false;
+        conn->changed.notify_all();
+    }
+
+    static void onConnect(const redisAsyncContext* ac, int status) {
+        auto* conn = static_cast<RedisAsyncConnection*>(ac->data);
+        if (status != REDIS_OK) {
+            std::cerr << "Redis async connect error: " << ac->errstr << std::endl;
+        }
+        conn->connected = (status == REDIS_OK);
+        conn->changed.notify_all();
+    }
+
+    static void onDisconnect(const redisAsyncContext* ac, int status) {
+        auto* conn = static_cast<RedisAsyncConnection*>(ac->data);
+        if (status != REDIS_OK) {
+            std::cerr << "Redis async connection lost: " << ac->errstr << std::endl;
+        }
+        conn->connected = false;
+        conn->changed.notify_all();
+    }
+
+    void wake() {
+        uint64_t one = 1;
+        ssize_t written = ::write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+
+    void loop() {
+        struct epoll_event events[128];
+        while (!stopping) {
+            int n = epoll_wait(epollFd, events, 128, -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Redis event loop error: " << std::strerror(errno) << std::endl;
+                return;
+            }
+            for (int i = 0; i < n; i++) {
+                if (events[i].data.ptr == nullptr) {
+                    uint64_t value;
+                    ssize_t drained = ::read(wakeFd, &value, sizeof(value));
+                    (void)drained;
+                    continue;
+                }
+                auto* conn = static_cast<RedisAsyncConnection*>(events[i].data.ptr);
+                std::lock_guard<std::mutex> lock(conn->lock);
+                if (conn->ac == nullptr) continue;
+                if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                    redisAsyncHandleRead(conn->ac);
+                }
+                if (conn->ac != nullptr && (events[i].events & EPOLLOUT)) {
+                    redisAsyncHandleWrite(conn->ac);
+                }
+            }
+            // Only now, with no event of this batch left to handle, may a
+            // task tear a connection down
+            runTasks();
+        }
+    }
+
+    void runTasks() {
+        std::vector<std::function<void()>> pending;
+        {
+            std::lock_guard<std::mutex> lock(tasksMutex);
+            pending.swap(tasks);
+        }
+        for (auto& task : pending) task();
+    }
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::atomic<bool> stopping{false};
+    std::mutex tasksMutex;
+    std::vector<std::function<void()>> tasks;
+    std::thread thread;
+};
+
+#endif // REDIS_EVENT_LOOP_H
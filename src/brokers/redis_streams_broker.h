@@ -0,0 +1,280 @@
+#ifndef REDIS_STREAMS_BROKER_H
+#define REDIS_STREAMS_BROKER_H
+
+#include "redis_broker.h"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Redis Streams with consumer groups, for comparing durable fan-out with
+// plain pub/sub under the same harness.
+//
+// Publish:   XADD <stream> [MAXLEN ~ N] * d <payload>
+// Subscribe: every broker instance gets its own consumer group, so each
+//            subscriber (thread) sees every entry, exactly like pub/sub fan-out.
+//            XREADGROUP ... COUNT n BLOCK ms fetches batches; the XACK for a
+//            batch is appended to the output buffer and rides along with the
+//            next XREADGROUP, so acking costs no extra round trip.
+//
+// The channel name is used as the stream key. Publishing reuses the Redis
+// pipelining settings (REDIS_PUBLISH_MODE=pipelined).
+class RedisStreamsBroker final : public RedisBroker {
+private:
+    std::string maxLen;          // empty = no trimming
+    int readCount = 100;
+    int blockMs = 100;
+    std::string group;
+    std::string consumer;
+    std::vector<std::string> streams;
+    int pendingAcks = 0;         // XACK replies still to be read on subCtx
+
+    // Reused argument vectors, so the read loop does not allocate per batch
+    std::vector<const char*> argv;
+    std::vector<size_t> argvlen;
+
+public:
+    RedisStreamsBroker(const std::string& h = "localhost", int p = 6379)
+        : RedisBroker(h, p) {
+        static std::atomic<int> instances{0};
+        const char* hostname = std::getenv("HOSTNAME");
+        consumer = std::string(hostname ? hostname : "local") + "-" +
+                   std::to_string(getpid()) + "-" + std::to_string(instances++);
+        group = "fanout-" + consumer;
+    }
+
+    // maxLength 0 disables trimming, other zero/empty arguments keep the
+    // defaults. groupPrefix replaces the "fanout" prefix of the per-instance
+    // consumer group name.
+    void setStreamOptions(int maxLength, int count, int blockMillis, const std::string& groupPrefix) {
+        maxLen = maxLength > 0 ? std::to_string(maxLength) : "";
+        if (count > 0) readCount = count;
+        if (blockMillis > 0) blockMs = blockMillis;  // never BLOCK 0, that waits forever
+        if (!groupPrefix.empty()) {
+            group = groupPrefix + "-" + consumer;
+        }
+    }
+
+    using MessageBroker::subscribe;
+
+    bool subscribe(const std::string& channel, MessageHandler callback) override {
+        if (!connectSubscriberContext()) {
+            return false;
+        }
+
+        // Start the group at the current end of the stream. A leftover group
+        // from an earlier run is moved forward instead of replaying its backlog.
+        redisReply* reply = (redisReply*)redisCommand(subCtx, "XGROUP CREATE %s %s $ MKSTREAM",
+                                                      channel.c_str(), group.c_str());
+        if (reply == nullptr) {
+            return false;
+        }
+        bool exists = (reply->type == REDIS_REPLY_ERROR && std::strncmp(reply->str, "BUSYGROUP", 9) == 0);
+        bool success = (reply->type != REDIS_REPLY_ERROR);
+        ArenaReplies::release(subCtx, reply, replyArenaBatch, 0);
+
+        if (exists) {
+            reply = (redisReply*)redisCommand(subCtx, "XGROUP SETID %s %s $", channel.c_str(), group.c_str());
+            success = (reply != nullptr && reply->type != REDIS_REPLY_ERROR);
+            if (reply != nullptr) {
+                ArenaReplies::release(subCtx, reply, replyArenaBatch, 0);
+            }
+        }
+        if (!success) {
+            std::cerr << "Redis Streams: could not create consumer group " << group
+                      << " on " << channel << std::endl;
+            return false;
+        }
+
+        callbacks.add(channel, std::move(callback));
+        if (std::find(streams.begin(), streams.end(), channel) == streams.end()) {
+            streams.push_back(channel);
+        }
+        return true;
+    }
+
+    // Consumer groups read named streams; there is no pattern equivalent
+    bool subscribePattern(const std::string& pattern, MessageHandler) override {
+        std::cerr << "Redis Streams: pattern subscriptions are not supported (" << pattern << ")" << std::endl;
+        return false;
+    }
+
+    void unsubscribe(const std::string& channel) override {
+        streams.erase(std::remove(streams.begin(), streams.end(), channel), streams.end());
+        callbacks.erase(channel);
+    }
+
+    void processMessages(int timeoutMs = 1000) override {
+        if ((subCtx == nullptr && !subscriberFailed) || streams.empty()) return;
+
+        if (subscriberFailed && !recoverSubscriber(timeoutMs)) return;
+
+        installReplyArena();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        for (;;) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) return;
+
+            if (!readBatch(static_cast<int>(std::min<long long>(remaining, blockMs)))) {
+                subscriberLost();
+                return;
+            }
+        }
+    }
+
+    std::string getName() const override {
+        return "Redis Streams";
+    }
+
+protected:
+    // After a reconnect: an existing group stays where it was, so entries
+    // added during the outage are still delivered; a Redis that came back
+    // without its data gets a fresh group at the end of the stream
+    bool restoreSubscriptions() override {
+        pendingAcks = 0;
+        for (const auto& stream : streams) {
+            redisReply* reply = (redisReply*)redisCommand(subCtx, "XGROUP CREATE %s %s $ MKSTREAM",
+                                                          stream.c_str(), group.c_str());
+            if (reply == nullptr) return false;
+            bool ok = reply->type != REDIS_REPLY_ERROR || std::strncmp(reply->str, "BUSYGROUP", 9) == 0;
+            ArenaReplies::release(subCtx, reply, replyArenaBatch, 0);
+            if (!ok) return false;
+        }
+        return true;
+    }
+
+    int formatPublish(const std::string& channel, std::string_view message,
+                      const char** args, size_t* lens) const override {
+        int argc = 0;
+        auto push = [&](const char* s, size_t len) {
+            args[argc] = s;
+            lens[argc++] = len;
+        };
+        push("XADD", 4);
+        push(channel.c_str(), channel.length());
+        if (!maxLen.empty()) {
+            push("MAXLEN", 6);
+            push("~", 1);
+            push(maxLen.c_str(), maxLen.length());
+        }
+        push("*", 1);
+        push("d", 1);
+        push(message.data(), message.length());
+        return argc;
+    }
+
+private:
+    // One XREADGROUP round trip. Returns false on a connection error.
+    bool readBatch(int block) {
+        std::string countArg = std::to_string(readCount);
+        std::string blockArg = std::to_string(block);
+
+        argv.clear();
+        argvlen.clear();
+        auto push = [&](const char* s, size_t len) {
+            argv.push_back(s);
+            argvlen.push_back(len);
+        };
+        push("XREADGROUP", 10);
+        push("GROUP", 5);
+        push(group.c_str(), group.length());
+        push(consumer.c_str(), consumer.length());
+        push("COUNT", 5);
+        push(countArg.c_str(), countArg.length());
+        push("BLOCK", 5);
+        push(blockArg.c_str(), blockArg.length());
+        push("STREAMS", 7);
+        for (const auto& s : streams) push(s.c_str(), s.length());
+        for (size_t i = 0; i < streams.size(); i++) push(">", 1);
+
+        if (redisAppendCommandArgv(subCtx, static_cast<int>(argv.size()), argv.data(), argvlen.data()) != REDIS_OK) {
+            return false;
+        }
+
+        // Replies come back in order: first the XACKs appended after the
+        // previous batch, then this XREADGROUP
+        for (; pendingAcks > 0; pendingAcks--) {
+            redisReply* ack = nullptr;
+            if (redisGetReply(subCtx, (void**)&ack) != REDIS_OK) {
+                std::cerr << "Redis Streams ack error: " << subCtx->errstr << std::endl;
+                return false;
+            }
+            ArenaReplies::release(subCtx, ack, replyArenaBatch, 0);
+        }
+
+        redisReply* reply = nullptr;
+        if (redisGetReply(subCtx, (void**)&reply) != REDIS_OK || reply == nullptr) {
+            std::cerr << "Redis Streams read error: " << subCtx->errstr << std::endl;
+            return false;
+        }
+
+        size_t entries = 0;
+        if (reply->type == REDIS_REPLY_ARRAY) {
+            uint64_t receivedAt = wallClockNs();
+            for (size_t s = 0; s < reply->elements; s++) {
+                entries += dispatchStream(reply->element[s], receivedAt);
+            }
+        } else if (reply->type == REDIS_REPLY_ERROR) {
+            std::cerr << "Redis Streams XREADGROUP error: " << reply->str << std::endl;
+        }
+        // REDIS_REPLY_NIL: BLOCK expired with nothing new
+
+        ArenaReplies::release(subCtx, reply, replyArenaBatch, entries);
+        return true;
+    }
+
+    // [stream, [[id, [field, value, ...]], ...]]; returns the entries read
+    size_t dispatchStream(const redisReply* stream, uint64_t receivedAt) {
+        if (stream->type != REDIS_REPLY_ARRAY || stream->elements < 2) return 0;
+        const redisReply* name = stream->element[0];
+        const redisReply* entries = stream->element[1];
+        if (entries->type != REDIS_REPLY_ARRAY || entries->elements == 0) return 0;
+
+        std::string_view channel(name->str, name->len);
+        const MessageHandler* handler = callbacks.find(channel);
+
+        argv.clear();
+        argvlen.clear();
+        argv.push_back("XACK");
+        argvlen.push_back(4);
+        argv.push_back(name->str);
+        argvlen.push_back(name->len);
+        argv.push_back(group.c_str());
+        argvlen.push_back(group.length());
+
+        for (size_t e = 0; e < entries->elements; e++) {
+            const redisReply* entry = entries->element[e];
+            if (entry->type != REDIS_REPLY_ARRAY || entry->elements < 2) continue;
+            const redisReply* id = entry->element[0];
+            const redisReply* fields = entry->element[1];
+            argv.push_back(id->str);
+            argvlen.push_back(id->len);
+
+            // Fields are nil if the entry was trimmed before we read it
+            if (handler == nullptr || fields->type != REDIS_REPLY_ARRAY) continue;
+            for (size_t f = 0; f + 1 < fields->elements; f += 2) {
+                const redisReply* key = fields->element[f];
+                if (key->len == 1 && key->str[0] == 'd') {
+                    const redisReply* value = fields->element[f + 1];
+                    MessageView view;
+                    view.channel = channel;
+                    view.payload = std::string_view(value->str, value->len);
+                    view.receiveTimestampNs = receivedAt;
+                    (*handler)(view);
+                    break;
+                }
+            }
+        }
+
+        // Formatted into the output buffer now, while the ids are still alive
+        if (argv.size() > 3 &&
+            redisAppendCommandArgv(subCtx, static_cast<int>(argv.size()), argv.data(), argvlen.data()) == REDIS_OK) {
+            pendingAcks++;
+        }
+        return entries->elements;
+    }
+};
+
+#endif // REDIS_STREAMS_BROKER_H
@@ -0,0 +1,177 @@
+#ifndef RESP_READER_H
+#define RESP_READER_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+
+// Allocation-free reader for Redis pub/sub push frames.
+// Bytes are read straight from the socket into one reusable buffer and
+// parsed in place; each complete frame is handed to the caller as views
+// into that buffer, so there is no redisReply tree per message and payloads
+// with embedded NULs survive intact.
+//
+// Understands the frames a subscribed RESP2 connection can receive:
+//   *3 $message  <channel> <payload>
+//   *3 $smessage <channel> <payload>
+//   *4 $pmessage <pattern> <channel> <payload>
+//   *3 $subscribe / $unsubscribe / ... <channel> :<count>
+class RespPushReader {
+public:
+    struct Push {
+        std::string_view kind;
+        std::string_view pattern;
+        std::string_view channel;
+        std::string_view payload;  // for (un)subscribe acks: the subscription count
+    };
+
+    explicit RespPushReader(size_t initialCapacity = 1024 * 1024)
+        : buffer(initialCapacity) {}
+
+    // Read whatever the socket has into the free tail of the buffer.
+    // Returns bytes read, 0 on EOF, -1 if the read would block, -2 on error.
+    ssize_t readFrom(int fd) {
+        makeRoom();
+        ssize_t n = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (n > 0) {
+            end += static_cast<size_t>(n);
+            return n;
+        }
+        if (n == 0) return 0;
+        return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? -1 : -2;
+    }
+
+    // Parse and dispatch every complete frame currently buffered.
+    // onPush(const Push&) is called for each; returns the number dispatched.
+    template <typename OnPush>
+    size_t drain(OnPush&& onPush) {
+        size_t dispatched = 0;
+        while (start < end) {
+            Push push;
+            size_t consumed = parseFrame(buffer.data() + start, buffer.data() + end, push);
+            if (consumed == 0) break;  // incomplete frame, wait for more bytes
+            if (consumed == PROTOCOL_ERROR) {
+                error = true;
+                start = end;
+                break;
+            }
+            start += consumed;
+            if (!push.kind.empty()) {
+                onPush(push);
+                dispatched++;
+            }
+        }
+        if (start == end) start = end = 0;
+        return dispatched;
+    }
+
+    // Forget everything buffered, for a fresh connection
+    void reset() {
+        start = end = 0;
+        error = false;
+    }
+
+    bool hasProtocolError() const { return error; }
+    size_t buffered() const { return end - start; }
+
+private:
+    static constexpr size_t PROTOCOL_ERROR = SIZE_MAX;
+
+    // Ensure there is free space after `end`: compact first, then grow when a
+    // single frame is larger than the whole buffer
+    void makeRoom() {
+        if (end < buffer.size()) return;
+        if (start > 0) {
+            std::memmove(buffer.data(), buffer.data() + start, end - start);
+            end -= start;
+            start = 0;
+        } else {
+            buffer.resize(buffer.size() * 2);
+        }
+    }
+
+    // Parse "<int>\r\n" starting at p; returns the position after CRLF or
+    // nullptr if the line is not complete yet
+    static const char* parseInt(const char* p, const char* end, int64_t& value) {
+        const char* cr = static_cast<const char*>(std::memchr(p, '\r', end - p));
+        if (cr == nullptr || cr + 1 >= end) return nullptr;
+        bool negative = (p < cr && *p == '-');
+        int64_t v = 0;
+        for (const char* d = negative ? p + 1 : p; d < cr; d++) {
+            v = v * 10 + (*d - '0');
+        }
+        value = negative ? -v : v;
+        return cr + 2;
+    }
+
+    // Parse one top-level value. Returns bytes consumed, 0 if incomplete,
+    // PROTOCOL_ERROR on garbage. Non-push values leave push.kind empty.
+    static size_t parseFrame(const char* p, const char* end, Push& push) {
+        const char type = *p;
+        if (type == '+' || type == '-' || type == ':') {
+            int64_t ignored;
+            const char* next = (type == ':') ? parseInt(p + 1, end, ignored)
+                                             : lineEnd(p + 1, end);
+            return next ? static_cast<size_t>(next - p) : 0;
+        }
+        if (type != '*') return PROTOCOL_ERROR;
+
+        int64_t count = 0;
+        const char* cur = parseInt(p + 1, end, count);
+        if (cur == nullptr) return 0;
+        if (count < 0 || count > 4) return PROTOCOL_ERROR;
+
+        std::string_view items[4];
+        for (int64_t i = 0; i < count; i++) {
+            if (cur >= end) return 0;
+            if (*cur == '$') {
+                int64_t len = 0;
+                const char* data = parseInt(cur + 1, end, len);
+                if (data == nullptr) return 0;
+                if (len < 0) {
+                    cur = data;
+                    continue;
+                }
+                if (end - data < len + 2) return 0;
+                items[i] = std::string_view(data, static_cast<size_t>(len));
+                cur = data + len + 2;
+            } else if (*cur == ':') {
+                const char* next = lineEnd(cur + 1, end);
+                if (next == nullptr) return 0;
+                items[i] = std::string_view(cur + 1, static_cast<size_t>(next - cur - 3));
+                cur = next;
+            } else {
+                return PROTOCOL_ERROR;
+            }
+        }
+
+        push.kind = items[0];
+        if (count == 4) {
+            push.pattern = items[1];
+            push.channel = items[2];
+            push.payload = items[3];
+        } else if (count == 3) {
+            push.channel = items[1];
+            push.payload = items[2];
+        } else {
+            push.kind = {};  // e.g. a PONG array, nothing to dispatch
+        }
+        return static_cast<size_t>(cur - p);
+    }
+
+    static const char* lineEnd(const char* p, const char* end) {
+        const char* cr = static_cast<const char*>(std::memchr(p, '\r', end - p));
+        if (cr == nullptr || cr + 1 >= end) return nullptr;
+        return cr + 2;
+    }
+
+    std::vector<char> buffer;
+    size_t start = 0;
+    size_t end = 0;
+    bool error = false;
+};
+
+#endif // RESP_READER_H
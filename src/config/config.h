@@ -6,6 +6,7 @@
 #include <string>
 #include <map>
 #include <iostream>
+#include <cstdlib>
 
 class Config {
 private:
@@ -59,7 +60,12 @@ public:
         loadFromFile(".env");
     }
 
+    // Process environment (e.g. docker-compose `environment:`) takes
+    // precedence over the .env file, so per-service overrides work
     std::string get(const std::string& key, const std::string& defaultValue = "") const {
+        if (const char* env = std::getenv(key.c_str())) {
+            if (*env != '\0') return env;
+        }
         auto it = values.find(key);
         if (it != values.end()) {
             return it->second;
@@ -68,10 +74,10 @@ public:
     }
 
     int getInt(const std::string& key, int defaultValue = 0) const {
-        auto it = values.find(key);
-        if (it != values.end()) {
+        std::string value = get(key);
+        if (!value.empty()) {
             try {
-                return std::stoi(it->second);
+                return std::stoi(value);
             } catch (...) {
                 return defaultValue;
             }
@@ -80,7 +86,7 @@ public:
     }
 
     bool has(const std::string& key) const {
-        return values.find(key) != values.end();
+        return !get(key).empty();
     }
 
     void print() const {
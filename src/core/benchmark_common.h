@@ -7,7 +7,21 @@
 #include <iomanip>
 #include <mutex>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string_view>
+#include <vector>
 
+// Wall-clock nanoseconds (CLOCK_REALTIME). Used for timestamps embedded in
+// payloads, since steady_clock epochs are not comparable across processes.
+inline uint64_t wallClockNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
 
 // Thread-safe message counter
 class MessageCounter {
@@ -28,6 +42,117 @@ private:
     std::atomic<uint64_t> counter{0};
 };
 
+// Counter owned by a single writer thread that other threads may read at any
+// time. Skips the locked read-modify-write that MessageCounter::increment()
+// pays, so it is safe to bump once per message on the receive path.
+class LocalCounter {
+public:
+    void add(uint64_t n = 1) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    
+    // Overwrite with an externally maintained total (e.g. a library counter)
+    void set(uint64_t n) {
+        value.store(n, std::memory_order_relaxed);
+    }
+    
+    uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+    
+    void reset() {
+        value.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value{0};
+};
+
+// Bump allocator for message-scoped storage, owned by one thread. Memory
+// comes from a list of slabs that reset() rewinds but keeps, so once the
+// slabs cover a batch the steady state allocates nothing; a request larger
+// than the slab size gets a slab of its own. Users mark messages they are
+// done with via finish() and rewind once due(N) says a batch of N has
+// finished and nothing from the arena is still referenced.
+class MessageArena {
+public:
+    explicit MessageArena(size_t slabBytes = 64 * 1024) : slabBytes(slabBytes) {}
+
+    MessageArena(const MessageArena&) = delete;
+    MessageArena& operator=(const MessageArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        size_t offset = (slabUsed + alignment - 1) & ~(alignment - 1);
+        if (current >= slabs.size() || offset + bytes > slabs[current].size) {
+            nextSlab(bytes + alignment);
+            offset = 0;
+        }
+        slabUsed = offset + bytes;
+        size_t inUse = used();
+        if (inUse > peakBytes) peakBytes = inUse;
+        return slabs[current].data.get() + offset;
+    }
+
+    // NUL-terminated copy of bytes; the view excludes the terminator
+    std::string_view copy(std::string_view bytes) {
+        char* data = static_cast<char*>(allocate(bytes.size() + 1, 1));
+        std::memcpy(data, bytes.data(), bytes.size());
+        data[bytes.size()] = '\0';
+        return std::string_view(data, bytes.size());
+    }
+
+    void finish(size_t messages = 1) { finished += messages; }
+    bool due(size_t batchMessages) const { return finished >= batchMessages; }
+
+    // Everything allocated so far becomes invalid
+    void reset() {
+        current = 0;
+        slabUsed = 0;
+        earlierSlabsBytes = 0;
+        finished = 0;
+        resetCount++;
+    }
+
+    size_t used() const { return earlierSlabsBytes + slabUsed; }
+    size_t peak() const { return peakBytes; }
+    size_t slabCount() const { return slabs.size(); }
+    uint64_t resets() const { return resetCount; }
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Slab& slab : slabs) total += slab.size;
+        return total;
+    }
+
+private:
+    struct Slab {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    // Move on to the next slab that fits minBytes, adding one if needed
+    void nextSlab(size_t minBytes) {
+        if (current < slabs.size()) {
+            earlierSlabsBytes += slabUsed;
+            current++;
+        }
+        slabUsed = 0;
+        if (current < slabs.size() && slabs[current].size >= minBytes) return;
+        Slab slab;
+        slab.size = minBytes > slabBytes ? minBytes : slabBytes;
+        slab.data.reset(new char[slab.size]);
+        slabs.insert(slabs.begin() + static_cast<std::ptrdiff_t>(current), std::move(slab));
+    }
+
+    size_t slabBytes;
+    std::vector<Slab> slabs;
+    size_t current = 0;            // slab being filled
+    size_t slabUsed = 0;           // bytes used in it
+    size_t earlierSlabsBytes = 0;  // bytes used in the slabs before it
+    size_t peakBytes = 0;
+    size_t finished = 0;           // messages finished since the last reset
+    uint64_t resetCount = 0;
+};
+
 // Synchronization barrier for coordinating multiple threads
 class Barrier {
 public:
@@ -0,0 +1,98 @@
+#ifndef CONSUMER_WORKLOAD_H
+#define CONSUMER_WORKLOAD_H
+
+#include "rate_schedule.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Simulated application work per benchmark message, to see how each broker
+// copes with consumers slower than the publishers (CONSUMER_WORK):
+//   none   nothing beyond recording the message (default)
+//   spin   busy-wait CONSUMER_WORK_NS nanoseconds, a fixed CPU cost
+//   hash   CONSUMER_HASH_PASSES passes of FNV-1a over the payload, a cost
+//          that grows with the message size as parsing would
+//   sleep  sleep CONSUMER_SLEEP_US every CONSUMER_SLEEP_EVERY messages, a
+//          consumer that stalls now and then (a GC pause, a slow write)
+// One instance per receiving thread; not thread-safe.
+class ConsumerWorkload {
+public:
+    enum class Kind { None, Spin, Hash, Sleep };
+
+    Kind kind = Kind::None;
+    uint64_t spinNs = 1000;
+    int hashPasses = 1;
+    uint64_t sleepEvery = 1000;
+    uint64_t sleepUs = 1000;
+
+    static ConsumerWorkload fromSettings(const std::string& mode, uint64_t spinNs, int hashPasses,
+                                         uint64_t sleepEvery, uint64_t sleepUs) {
+        ConsumerWorkload workload;
+        if (mode == "spin") workload.kind = Kind::Spin;
+        if (mode == "hash") workload.kind = Kind::Hash;
+        if (mode == "sleep") workload.kind = Kind::Sleep;
+        workload.spinNs = spinNs;
+        workload.hashPasses = hashPasses > 0 ? hashPasses : 1;
+        workload.sleepEvery = sleepEvery > 0 ? sleepEvery : 1;
+        workload.sleepUs = sleepUs;
+        return workload;
+    }
+
+    bool active() const { return kind != Kind::None; }
+
+    void run(std::string_view payload) {
+        switch (kind) {
+        case Kind::None:
+            break;
+        case Kind::Spin: {
+            auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(spinNs);
+            while (std::chrono::steady_clock::now() < until) cpuRelax();
+            break;
+        }
+        case Kind::Hash:
+            for (int pass = 0; pass < hashPasses; pass++) sink = fnv1a(payload, sink);
+            break;
+        case Kind::Sleep:
+            if (++messages % sleepEvery == 0) std::this_thread::sleep_for(std::chrono::microseconds(sleepUs));
+            break;
+        }
+    }
+
+    const char* modeName() const {
+        switch (kind) {
+        case Kind::Spin: return "spin";
+        case Kind::Hash: return "hash";
+        case Kind::Sleep: return "sleep";
+        default: return "none";
+        }
+    }
+
+    std::string describe() const {
+        switch (kind) {
+        case Kind::Spin: return "spin " + std::to_string(spinNs) + "ns";
+        case Kind::Hash: return "hash x" + std::to_string(hashPasses);
+        case Kind::Sleep:
+            return "sleep " + std::to_string(sleepUs) + "us every " + std::to_string(sleepEvery);
+        default: return "none";
+        }
+    }
+
+    // Hash results, kept so the kernel is not optimized away
+    uint64_t sink = 0;
+
+private:
+    uint64_t messages = 0;
+
+    static uint64_t fnv1a(std::string_view data, uint64_t seed) {
+        uint64_t hash = 14695981039346656037ull ^ seed;
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+#endif // CONSUMER_WORKLOAD_H
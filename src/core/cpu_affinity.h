@@ -0,0 +1,191 @@
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// Parse a Linux cpulist ("2-5,8,10-11") into CPU ids. Invalid items are skipped.
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (item.empty()) continue;
+        int first = -1, last = -1;
+        size_t dash = item.find('-');
+        try {
+            first = std::stoi(item.substr(0, dash));
+            last = (dash == std::string::npos) ? first : std::stoi(item.substr(dash + 1));
+        } catch (...) {
+            continue;
+        }
+        for (int cpu = first; cpu >= 0 && cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// NUMA layout read from sysfs, so no libnuma is needed at build or run time.
+// Single-node (or non-NUMA) hosts report one node holding every CPU.
+struct NumaTopology {
+    struct Node {
+        int id = 0;
+        std::string cpuList;
+        std::vector<int> cpus;
+    };
+    std::vector<Node> nodes;
+
+    static NumaTopology detect() {
+        NumaTopology topology;
+        for (int id = 0; id < 64; id++) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+            if (!file.is_open()) continue;
+            Node node;
+            node.id = id;
+            std::getline(file, node.cpuList);
+            node.cpus = parseCpuList(node.cpuList);
+            topology.nodes.push_back(std::move(node));
+        }
+        return topology;
+    }
+
+    // Node owning the CPU, or -1 if unknown
+    int nodeOf(int cpu) const {
+        for (const auto& node : nodes) {
+            for (int c : node.cpus) {
+                if (c == cpu) return node.id;
+            }
+        }
+        return -1;
+    }
+};
+
+// Where one thread ended up after ThreadPlacement::apply()
+struct ThreadLocation {
+    int thread = 0;
+    int requestedCpu = -1;  // -1 = not pinned
+    int cpu = -1;           // sched_getcpu() right after placement
+    int node = -1;
+};
+
+// Pins benchmark threads to CPUs and applies a NUMA memory policy.
+//
+//   PUBLISHER_CPUS=2-5      thread i runs on the i-th listed CPU (wrapping around)
+//   SUBSCRIBER_CPUS=6,7
+//   NUMA_POLICY=none        leave the kernel default (first touch)
+//             =preferred    prefer memory on the pinned CPU's node
+//             =bind         only allocate from the pinned CPU's node
+//             =interleave   spread pages over all nodes
+//
+// apply() must run on the thread being placed, before it allocates its
+// per-thread buffers, so that first-touch pages land on the right node.
+// Setting a memory policy inside a container needs CAP_SYS_NICE.
+class ThreadPlacement {
+public:
+    std::vector<int> cpus;
+    std::string cpuList;
+    std::string numaPolicy = "none";
+    NumaTopology topology;
+
+    static ThreadPlacement fromConfig(const std::string& cpuList, const std::string& numaPolicy) {
+        ThreadPlacement placement;
+        placement.cpuList = cpuList;
+        placement.cpus = parseCpuList(cpuList);
+        placement.numaPolicy = numaPolicy.empty() ? "none" : numaPolicy;
+        placement.topology = NumaTopology::detect();
+        if (!cpuList.empty() && placement.cpus.empty()) {
+            std::cerr << "Warning: Could not parse CPU list '" << cpuList << "', threads stay unpinned" << std::endl;
+        }
+        return placement;
+    }
+
+    bool isPinned() const { return !cpus.empty(); }
+
+    ThreadLocation apply(int threadIndex) const {
+        ThreadLocation location;
+        location.thread = threadIndex;
+        if (isPinned()) {
+            location.requestedCpu = cpus[static_cast<size_t>(threadIndex) % cpus.size()];
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(location.requestedCpu, &set);
+            int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            if (rc != 0) {
+                std::cerr << "Warning: Failed to pin thread " << threadIndex << " to CPU "
+                          << location.requestedCpu << ": " << std::strerror(rc) << std::endl;
+            }
+        }
+        location.cpu = sched_getcpu();
+        location.node = topology.nodeOf(location.cpu);
+        applyMemoryPolicy(threadIndex, location.node);
+        return location;
+    }
+
+    // {"cpu_list": ..., "numa_policy": ..., "online_cpus": N, "numa_nodes": [...], "threads": [...]}
+    void writeJson(std::ostream& out, const std::vector<ThreadLocation>& threads) const {
+        out << "{\"cpu_list\": \"" << cpuList << "\", \"numa_policy\": \"" << numaPolicy
+            << "\", \"online_cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ", \"numa_nodes\": [";
+        for (size_t i = 0; i < topology.nodes.size(); i++) {
+            out << (i ? ", " : "") << "{\"node\": " << topology.nodes[i].id
+                << ", \"cpus\": \"" << topology.nodes[i].cpuList << "\"}";
+        }
+        out << "], \"threads\": [";
+        for (size_t i = 0; i < threads.size(); i++) {
+            const ThreadLocation& t = threads[i];
+            out << (i ? ", " : "") << "{\"thread\": " << t.thread << ", \"requested_cpu\": " << t.requestedCpu
+                << ", \"cpu\": " << t.cpu << ", \"node\": " << t.node << "}";
+        }
+        out << "]}";
+    }
+
+    std::string describe() const {
+        std::ostringstream out;
+        out << (isPinned() ? "pinned to CPUs " + cpuList : std::string("unpinned"))
+            << ", NUMA policy " << numaPolicy << " (" << topology.nodes.size() << " node(s))";
+        return out.str();
+    }
+
+private:
+    // Values from <linux/mempolicy.h>
+    static constexpr int MPOL_PREFERRED_MODE = 1;
+    static constexpr int MPOL_BIND_MODE = 2;
+    static constexpr int MPOL_INTERLEAVE_MODE = 3;
+
+    void applyMemoryPolicy(int threadIndex, int node) const {
+        if (numaPolicy == "none") return;
+
+        unsigned long mask = 0;
+        int mode = 0;
+        if (numaPolicy == "interleave") {
+            mode = MPOL_INTERLEAVE_MODE;
+            for (const auto& n : topology.nodes) mask |= 1ul << n.id;
+        } else if (numaPolicy == "preferred" || numaPolicy == "bind") {
+            if (node < 0) return;
+            mode = (numaPolicy == "bind") ? MPOL_BIND_MODE : MPOL_PREFERRED_MODE;
+            mask = 1ul << node;
+        } else {
+            std::cerr << "Warning: Unknown NUMA_POLICY '" << numaPolicy << "', ignoring" << std::endl;
+            return;
+        }
+        if (mask == 0) return;
+
+        if (syscall(SYS_set_mempolicy, mode, &mask, sizeof(mask) * 8) != 0) {
+            std::cerr << "Warning: set_mempolicy failed for thread " << threadIndex << ": "
+                      << std::strerror(errno) << (errno == EPERM ? " (container needs CAP_SYS_NICE)" : "")
+                      << std::endl;
+        }
+    }
+};
+
+#endif // CPU_AFFINITY_H
@@ -0,0 +1,65 @@
+#ifndef DISPATCH_TABLE_H
+#define DISPATCH_TABLE_H
+
+#include "message_broker.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Channel -> handler lookup for brokers that only learn the channel from
+// the wire (Redis pushes, stream replies). A hash table keyed by the channel
+// text with heterogeneous lookup, so a string_view into the receive buffer
+// is looked up without building a std::string. The last hit is cached, which
+// turns the common single-channel (or bursty) case into one memcmp.
+class DispatchTable {
+public:
+    void add(const std::string& key, MessageHandler handler) {
+        handlers[key] = std::move(handler);
+        lastKey = {};
+        lastHandler = nullptr;
+    }
+
+    void erase(const std::string& key) {
+        handlers.erase(key);
+        lastKey = {};
+        lastHandler = nullptr;
+    }
+
+    // nullptr if nobody is subscribed to key
+    const MessageHandler* find(std::string_view key) {
+        if (lastHandler != nullptr && key == lastKey) return lastHandler;
+        auto it = handlers.find(key);
+        if (it == handlers.end()) return nullptr;
+        // Node-based map: the key and handler stay put until erased
+        lastKey = it->first;
+        lastHandler = &it->second;
+        return lastHandler;
+    }
+
+    // fn(const std::string& key) for every key, e.g. to resubscribe
+    template <typename Fn>
+    void forEachKey(Fn&& fn) const {
+        for (const auto& entry : handlers) fn(entry.first);
+    }
+
+    bool empty() const { return handlers.empty(); }
+    size_t size() const { return handlers.size(); }
+    void clear() {
+        handlers.clear();
+        lastKey = {};
+        lastHandler = nullptr;
+    }
+
+private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+    };
+
+    std::unordered_map<std::string, MessageHandler, Hash, std::equal_to<>> handlers;
+    std::string_view lastKey;
+    const MessageHandler* lastHandler = nullptr;
+};
+
+#endif // DISPATCH_TABLE_H
@@ -0,0 +1,194 @@
+#ifndef HOT_PATH_STATS_H
+#define HOT_PATH_STATS_H
+
+#include "benchmark_common.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#if defined(FANOUT_INSTRUMENT) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+// Client-side cost breakdown of the broker hot paths, compiled in only with
+// -DFANOUT_INSTRUMENT. Without it PhaseTimer and the count* functions are
+// empty and the compiler removes them, so normal builds measure nothing and
+// pay nothing.
+//
+// Phases (cycles and calls per phase):
+//   format      building the command / message in the client's buffer
+//   write       pushing the output buffer to the socket (or nats.c flush)
+//   read_reply  waiting for and parsing replies to our own commands
+//   read        subscriber socket reads
+//   dispatch    parsing pushes and running the message handlers
+// plus write/read syscall counts and bytes, where the broker code issues
+// the syscalls itself (RedisBroker; nats.c writes from its own thread).
+//
+// Counters are thread-local; threads register on first use, and their
+// totals are folded into a process-wide sum when they exit.
+enum class HotPhase { Format, Write, ReadReply, Read, Dispatch };
+constexpr size_t HOT_PHASE_COUNT = 5;
+
+// Process-wide totals at one instant
+struct HotPathTotals {
+    bool enabled = false;
+    uint64_t cycles[HOT_PHASE_COUNT] = {};
+    uint64_t calls[HOT_PHASE_COUNT] = {};
+    uint64_t writeSyscalls = 0;
+    uint64_t writeBytes = 0;
+    uint64_t readSyscalls = 0;
+    uint64_t readBytes = 0;
+    double cyclesPerNs = 0;  // measured over the process lifetime
+
+    // {"enabled": true, "cycles_per_ns": 2.9, "phases": {"format": {"calls":
+    //  ..., "cycles": ..., "cycles_per_call": ...}, ...}, "syscalls": {...}}
+    void writeJson(std::ostream& out) const {
+        static const char* names[HOT_PHASE_COUNT] = { "format", "write", "read_reply", "read", "dispatch" };
+        out << "{\"enabled\": " << (enabled ? "true" : "false");
+        if (!enabled) {
+            out << "}";
+            return;
+        }
+        out << std::fixed << std::setprecision(3) << ", \"cycles_per_ns\": " << cyclesPerNs << ", \"phases\": {";
+        for (size_t i = 0; i < HOT_PHASE_COUNT; i++) {
+            out << (i ? ", " : "") << "\"" << names[i] << "\": {\"calls\": " << calls[i]
+                << ", \"cycles\": " << cycles[i] << ", \"cycles_per_call\": " << std::setprecision(1)
+                << (calls[i] ? static_cast<double>(cycles[i]) / calls[i] : 0.0) << "}";
+        }
+        out << "}, \"syscalls\": {\"write\": {\"calls\": " << writeSyscalls << ", \"bytes\": " << writeBytes
+            << ", \"bytes_per_call\": " << std::setprecision(1)
+            << (writeSyscalls ? static_cast<double>(writeBytes) / writeSyscalls : 0.0)
+            << "}, \"read\": {\"calls\": " << readSyscalls << ", \"bytes\": " << readBytes
+            << ", \"bytes_per_call\": "
+            << (readSyscalls ? static_cast<double>(readBytes) / readSyscalls : 0.0) << "}}}";
+    }
+};
+
+#ifdef FANOUT_INSTRUMENT
+
+inline uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// One thread's counters. Written by that thread only, read by whoever takes a snapshot.
+struct HotPathCounters {
+    LocalCounter cycles[HOT_PHASE_COUNT];
+    LocalCounter calls[HOT_PHASE_COUNT];
+    LocalCounter writeSyscalls;
+    LocalCounter writeBytes;
+    LocalCounter readSyscalls;
+    LocalCounter readBytes;
+
+    void addTo(HotPathTotals& totals) const {
+        for (size_t i = 0; i < HOT_PHASE_COUNT; i++) {
+            totals.cycles[i] += cycles[i].get();
+            totals.calls[i] += calls[i].get();
+        }
+        totals.writeSyscalls += writeSyscalls.get();
+        totals.writeBytes += writeBytes.get();
+        totals.readSyscalls += readSyscalls.get();
+        totals.readBytes += readBytes.get();
+    }
+};
+
+class HotPathStats {
+public:
+    static HotPathCounters& local() {
+        thread_local Registration registration;
+        return registration.counters;
+    }
+
+    static HotPathTotals snapshot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        HotPathTotals totals = r.retired;
+        for (const HotPathCounters* counters : r.live) counters->addTo(totals);
+        totals.enabled = true;
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - r.startTime).count();
+        totals.cyclesPerNs = elapsed > 0 ? static_cast<double>(readCycles() - r.startCycles) / elapsed : 0;
+        return totals;
+    }
+
+private:
+    struct Registry {
+        std::mutex mtx;
+        std::vector<const HotPathCounters*> live;
+        HotPathTotals retired;
+        uint64_t startCycles = readCycles();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    };
+
+    // Leaked on purpose: threads may still exit during static destruction
+    static Registry& registry() {
+        static Registry* r = new Registry();
+        return *r;
+    }
+
+    struct Registration {
+        HotPathCounters counters;
+        Registration() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            r.live.push_back(&counters);
+        }
+        ~Registration() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            counters.addTo(r.retired);
+            std::erase(r.live, &counters);
+        }
+    };
+};
+
+// Adds the cycles spent in its scope to phase
+class PhaseTimer {
+public:
+    explicit PhaseTimer(HotPhase p) : phase(static_cast<size_t>(p)), start(readCycles()) {}
+    ~PhaseTimer() {
+        HotPathCounters& counters = HotPathStats::local();
+        counters.cycles[phase].add(readCycles() - start);
+        counters.calls[phase].add();
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    size_t phase;
+    uint64_t start;
+};
+
+inline void countWriteSyscall(size_t bytes) {
+    HotPathCounters& counters = HotPathStats::local();
+    counters.writeSyscalls.add();
+    counters.writeBytes.add(bytes);
+}
+
+inline void countReadSyscall(size_t bytes) {
+    HotPathCounters& counters = HotPathStats::local();
+    counters.readSyscalls.add();
+    counters.readBytes.add(bytes);
+}
+
+inline HotPathTotals hotPathSnapshot() { return HotPathStats::snapshot(); }
+
+#else
+
+class PhaseTimer {
+public:
+    explicit PhaseTimer(HotPhase) {}
+};
+
+inline void countWriteSyscall(size_t) {}
+inline void countReadSyscall(size_t) {}
+inline HotPathTotals hotPathSnapshot() { return {}; }
+
+#endif // FANOUT_INSTRUMENT
+
+#endif // HOT_PATH_STATS_H
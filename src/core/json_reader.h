@@ -0,0 +1,206 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Single-pass JSON parser for the benchmark's own result files.
+// The whole document is tokenized once into a flat node array whose keys
+// and values are views into the source text, so parsing does one
+// allocation per document (the node array) and lookups never copy.
+// Strings are returned raw: escape sequences are not decoded, which is fine
+// for the ASCII keys and ids the harness writes.
+class JsonDocument {
+public:
+    enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        Type type = Type::Null;
+        uint32_t firstChild = NONE;
+        uint32_t nextSibling = NONE;
+        std::string_view key;   // member name when the parent is an object
+        std::string_view text;  // number/string/bool literal
+    };
+
+    // Returns false on malformed input; error() gives the byte offset.
+    // The text must outlive the document.
+    bool parse(std::string_view text) {
+        src = text;
+        pos = 0;
+        nodes.clear();
+        nodes.reserve(text.size() / 8 + 16);
+        errorOffset = SIZE_MAX;
+        skipSpace();
+        if (parseValue() == NONE) return false;
+        skipSpace();
+        if (pos != src.size()) return fail();
+        return true;
+    }
+
+    size_t error() const { return errorOffset; }
+    uint32_t root() const { return nodes.empty() ? NONE : 0; }
+    const Node& node(uint32_t index) const { return nodes[index]; }
+
+    // Member of an object, or NONE
+    uint32_t get(uint32_t object, std::string_view key) const {
+        if (object == NONE || nodes[object].type != Type::Object) return NONE;
+        for (uint32_t c = nodes[object].firstChild; c != NONE; c = nodes[c].nextSibling) {
+            if (nodes[c].key == key) return c;
+        }
+        return NONE;
+    }
+
+    // Dotted path from the root, e.g. "latency_us.p99"
+    uint32_t at(std::string_view path) const {
+        uint32_t current = root();
+        while (current != NONE && !path.empty()) {
+            size_t dot = path.find('.');
+            current = get(current, path.substr(0, dot));
+            path = (dot == std::string_view::npos) ? std::string_view() : path.substr(dot + 1);
+        }
+        return current;
+    }
+
+    uint32_t firstChild(uint32_t index) const { return index == NONE ? NONE : nodes[index].firstChild; }
+    uint32_t next(uint32_t index) const { return nodes[index].nextSibling; }
+
+    // Numbers are parsed straight from the view. A literal that is not
+    // wholly a number of the type (a fraction or negative value read as
+    // u64, one out of range) gives fallback.
+    uint64_t u64(uint32_t index, uint64_t fallback = 0) const {
+        return parseNumber(index, fallback);
+    }
+
+    double number(uint32_t index, double fallback = 0) const {
+        return parseNumber(index, fallback);
+    }
+
+    std::string_view str(uint32_t index, std::string_view fallback = {}) const {
+        if (index == NONE || nodes[index].type == Type::Array || nodes[index].type == Type::Object) return fallback;
+        return nodes[index].text;
+    }
+
+    // Convenience for path lookups
+    uint64_t u64(std::string_view path, uint64_t fallback = 0) const { return u64(at(path), fallback); }
+    double number(std::string_view path, double fallback = 0) const { return number(at(path), fallback); }
+    std::string_view str(std::string_view path, std::string_view fallback = {}) const { return str(at(path), fallback); }
+
+private:
+    template <typename Value>
+    Value parseNumber(uint32_t index, Value fallback) const {
+        if (index == NONE || nodes[index].type != Type::Number) return fallback;
+        std::string_view text = nodes[index].text;
+        const char* last = text.data() + text.size();
+        Value value{};
+        auto [end, ec] = std::from_chars(text.data(), last, value);
+        return ec == std::errc() && end == last ? value : fallback;
+    }
+
+    uint32_t fail() {
+        if (errorOffset == SIZE_MAX) errorOffset = pos;
+        return NONE;
+    }
+
+    void skipSpace() {
+        while (pos < src.size() && (src[pos] == ' ' || src[pos] == '\n' || src[pos] == '\r' || src[pos] == '\t')) {
+            pos++;
+        }
+    }
+
+    uint32_t addNode(Type type) {
+        nodes.push_back(Node{type, NONE, NONE, {}, {}});
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    // Parse the string starting at the opening quote; returns its contents
+    bool parseString(std::string_view& out) {
+        size_t start = ++pos;
+        while (pos < src.size() && src[pos] != '"') {
+            pos += (src[pos] == '\\') ? 2 : 1;
+        }
+        if (pos >= src.size()) return false;
+        out = src.substr(start, pos - start);
+        pos++;
+        return true;
+    }
+
+    uint32_t parseValue() {
+        if (pos >= src.size()) return fail();
+        char c = src[pos];
+        if (c == '{' || c == '[') return parseContainer(c == '{');
+        if (c == '"') {
+            uint32_t n = addNode(Type::String);
+            std::string_view text;
+            if (!parseString(text)) return fail();
+            nodes[n].text = text;
+            return n;
+        }
+        size_t start = pos;
+        while (pos < src.size() && src[pos] != ',' && src[pos] != '}' && src[pos] != ']' &&
+               src[pos] != ' ' && src[pos] != '\n' && src[pos] != '\r' && src[pos] != '\t') {
+            pos++;
+        }
+        std::string_view text = src.substr(start, pos - start);
+        Type type;
+        if (text == "true" || text == "false") type = Type::Bool;
+        else if (text == "null") type = Type::Null;
+        else if (!text.empty() && (text[0] == '-' || (text[0] >= '0' && text[0] <= '9'))) type = Type::Number;
+        else return fail();
+        uint32_t n = addNode(type);
+        nodes[n].text = text;
+        return n;
+    }
+
+    uint32_t parseContainer(bool isObject) {
+        uint32_t self = addNode(isObject ? Type::Object : Type::Array);
+        char close = isObject ? '}' : ']';
+        pos++;
+        skipSpace();
+        if (pos < src.size() && src[pos] == close) {
+            pos++;
+            return self;
+        }
+        uint32_t last = NONE;
+        for (;;) {
+            std::string_view key;
+            if (isObject) {
+                if (pos >= src.size() || src[pos] != '"' || !parseString(key)) return fail();
+                skipSpace();
+                if (pos >= src.size() || src[pos] != ':') return fail();
+                pos++;
+                skipSpace();
+            }
+            uint32_t child = parseValue();
+            if (child == NONE) return NONE;
+            nodes[child].key = key;
+            if (last == NONE) nodes[self].firstChild = child;
+            else nodes[last].nextSibling = child;
+            last = child;
+
+            skipSpace();
+            if (pos >= src.size()) return fail();
+            if (src[pos] == ',') {
+                pos++;
+                skipSpace();
+                continue;
+            }
+            if (src[pos] == close) {
+                pos++;
+                return self;
+            }
+            return fail();
+        }
+    }
+
+    std::string_view src;
+    size_t pos = 0;
+    size_t errorOffset = SIZE_MAX;
+    std::vector<Node> nodes;
+};
+
+#endif // JSON_READER_H
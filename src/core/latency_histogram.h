@@ -0,0 +1,151 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+// HDR-style log-linear histogram of nanosecond values.
+// Values below 128 get exact buckets; above that every power of two is split
+// into 64 linear sub-buckets, giving ~1.6% relative precision over the whole
+// uint64_t range in a fixed 30 KB array.
+//
+// Recording is lock-free for a single writer thread (relaxed load + store, no
+// RMW), while other threads may read counts concurrently for reporting.
+// Histograms from different writers or processes are combined with merge(),
+// never by averaging percentiles.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 7;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+    static constexpr int BUCKET_COUNT = SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF;
+
+    static size_t indexOf(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) return static_cast<size_t>(value);
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - (SUB_BUCKET_BITS - 1);
+        return SUB_BUCKET_COUNT + static_cast<size_t>(shift - 1) * SUB_BUCKET_HALF +
+               static_cast<size_t>((value >> shift) - SUB_BUCKET_HALF);
+    }
+
+    static uint64_t lowestValueAt(size_t index) {
+        if (index < SUB_BUCKET_COUNT) return index;
+        size_t k = index - SUB_BUCKET_COUNT;
+        int shift = static_cast<int>(k / SUB_BUCKET_HALF) + 1;
+        return static_cast<uint64_t>(k % SUB_BUCKET_HALF + SUB_BUCKET_HALF) << shift;
+    }
+
+    static uint64_t highestValueAt(size_t index) {
+        if (index < SUB_BUCKET_COUNT) return index;
+        int shift = static_cast<int>((index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF) + 1;
+        return lowestValueAt(index) + ((uint64_t(1) << shift) - 1);
+    }
+
+    void record(uint64_t value) {
+        bump(counts[indexOf(value)], 1);
+        bump(total, 1);
+        if (value > maxValue.load(std::memory_order_relaxed)) {
+            maxValue.store(value, std::memory_order_relaxed);
+        }
+        if (value < minValue.load(std::memory_order_relaxed)) {
+            minValue.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // Add count samples to a bucket, e.g. when rebuilding from serialized form
+    void addToBucket(size_t index, uint64_t count) {
+        if (index >= BUCKET_COUNT || count == 0) return;
+        bump(counts[index], count);
+        bump(total, count);
+        uint64_t lo = lowestValueAt(index);
+        uint64_t hi = highestValueAt(index);
+        if (hi > maxValue.load(std::memory_order_relaxed)) maxValue.store(hi, std::memory_order_relaxed);
+        if (lo < minValue.load(std::memory_order_relaxed)) minValue.store(lo, std::memory_order_relaxed);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            uint64_t c = other.counts[i].load(std::memory_order_relaxed);
+            if (c != 0) bump(counts[i], c);
+        }
+        bump(total, other.count());
+        if (other.max() > max()) maxValue.store(other.max(), std::memory_order_relaxed);
+        if (other.count() > 0 && other.min() < minValue.load(std::memory_order_relaxed)) {
+            minValue.store(other.min(), std::memory_order_relaxed);
+        }
+    }
+
+    void reset() {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+        minValue.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    uint64_t min() const {
+        uint64_t v = minValue.load(std::memory_order_relaxed);
+        return v == UINT64_MAX ? 0 : v;
+    }
+    uint64_t bucketCount(size_t index) const { return counts[index].load(std::memory_order_relaxed); }
+
+    // Value at the given percentile (0-100), reported as the highest value
+    // equivalent to the bucket it falls in, capped at the recorded max
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(p / 100.0 * n + 0.5);
+        if (target < 1) target = 1;
+        if (target > n) target = n;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= target) {
+                uint64_t v = highestValueAt(i);
+                return v < max() ? v : max();
+            }
+        }
+        return max();
+    }
+
+    // Serialize non-empty buckets as [[index,count],...]
+    void writeBucketsJson(std::ostream& out) const {
+        out << "[";
+        bool first = true;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            uint64_t c = counts[i].load(std::memory_order_relaxed);
+            if (c == 0) continue;
+            if (!first) out << ",";
+            out << "[" << i << "," << c << "]";
+            first = false;
+        }
+        out << "]";
+    }
+
+    // Serialize the percentile summary in microseconds
+    void writeSummaryJson(std::ostream& out) const {
+        auto us = [](uint64_t ns) { return ns / 1000.0; };
+        out << "{\"count\": " << count()
+            << ", \"min\": " << us(min())
+            << ", \"p50\": " << us(percentile(50.0))
+            << ", \"p90\": " << us(percentile(90.0))
+            << ", \"p99\": " << us(percentile(99.0))
+            << ", \"p999\": " << us(percentile(99.9))
+            << ", \"max\": " << us(max()) << "}";
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts{};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> maxValue{0};
+    std::atomic<uint64_t> minValue{UINT64_MAX};
+};
+
+#endif // LATENCY_HISTOGRAM_H
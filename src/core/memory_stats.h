@@ -0,0 +1,261 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <fcntl.h>
+#include <malloc.h>
+#include <unistd.h>
+
+// Process memory over a run, to see what fills the container's mem_limit:
+//   rss / peak_rss  /proc/self/status VmRSS and VmHWM (peak since start, or
+//                   since the last resetPeakRss())
+//   heap            glibc mallinfo2(): bytes in use in malloc arenas plus
+//                   large mmap'ed chunks, i.e. our buffers, hiredis reader
+//                   buffers and the nats.c pending queues together
+//
+// Built with -DFANOUT_ALLOC_STATS, malloc/calloc/realloc/free and the
+// aligned variants are also interposed with counting wrappers around glibc's
+// own allocator. Because the executable's definitions win symbol
+// resolution, this counts the allocations of hiredis, nats.c and libstdc++
+// (operator new) as well as ours; glibc's internal allocations are not
+// seen. Counters are relaxed atomics spread over cache-line shards picked
+// per thread, so threads do not contend on one line. Without the flag
+// nothing is interposed and allocation counts are reported as disabled.
+//
+// The wrappers are definitions, not inline: include this header from
+// exactly one translation unit per binary (each app is a single one).
+
+// Allocation counters at one instant; subtract two for a window
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0;  // requested
+
+    AllocationCounts operator-(const AllocationCounts& earlier) const {
+        return { allocations - earlier.allocations, frees - earlier.frees, bytes - earlier.bytes };
+    }
+};
+
+#ifdef FANOUT_ALLOC_STATS
+
+constexpr bool ALLOCATION_COUNTING = true;
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace alloc_stats {
+
+struct alignas(64) Shard {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes{0};
+};
+
+constexpr size_t SHARD_COUNT = 64;
+inline Shard shards[SHARD_COUNT];
+inline std::atomic<uint32_t> nextShard{0};
+
+// Constant-initialized thread_local: no TLS constructor, so this is safe to
+// reach from malloc itself, including while a thread is being set up
+inline Shard& shard() {
+    static thread_local uint32_t index = UINT32_MAX;
+    if (index == UINT32_MAX) index = nextShard.fetch_add(1, std::memory_order_relaxed) % SHARD_COUNT;
+    return shards[index];
+}
+
+inline void* counted(void* ptr, size_t size) {
+    if (ptr != nullptr) {
+        Shard& s = shard();
+        s.allocations.fetch_add(1, std::memory_order_relaxed);
+        s.bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return ptr;
+}
+
+inline void countFree(void* ptr) {
+    if (ptr != nullptr) shard().frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace alloc_stats
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    return alloc_stats::counted(__libc_malloc(size), size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    return alloc_stats::counted(__libc_calloc(count, size), count * size);
+}
+
+// A moving realloc is a new allocation plus a free of the old block
+void* realloc(void* ptr, size_t size) noexcept {
+    void* result = __libc_realloc(ptr, size);
+    if (ptr == nullptr) return alloc_stats::counted(result, size);
+    if (size == 0) {
+        alloc_stats::countFree(ptr);
+    } else if (result != nullptr) {
+        alloc_stats::countFree(ptr);
+        alloc_stats::counted(result, size);
+    }
+    return result;
+}
+
+void free(void* ptr) noexcept {
+    alloc_stats::countFree(ptr);
+    __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    return alloc_stats::counted(__libc_memalign(alignment, size), size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    return alloc_stats::counted(__libc_memalign(alignment, size), size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) noexcept {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* ptr = alloc_stats::counted(__libc_memalign(alignment, size), size);
+    if (ptr == nullptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+} // extern "C"
+
+inline AllocationCounts allocationCounts() {
+    AllocationCounts counts;
+    for (const alloc_stats::Shard& s : alloc_stats::shards) {
+        counts.allocations += s.allocations.load(std::memory_order_relaxed);
+        counts.frees += s.frees.load(std::memory_order_relaxed);
+        counts.bytes += s.bytes.load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+#else
+
+constexpr bool ALLOCATION_COUNTING = false;
+
+inline AllocationCounts allocationCounts() { return {}; }
+
+#endif // FANOUT_ALLOC_STATS
+
+// Resident set size from /proc/self/statm; cheap enough for the sampler
+// thread (one read, no allocation)
+inline uint64_t currentRssBytes() {
+    int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd < 0) return 0;
+    char buffer[128];
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buffer[n] = '\0';
+    char* field = std::strchr(buffer, ' ');
+    if (field == nullptr) return 0;
+    return std::strtoull(field + 1, nullptr, 10) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Restart VmHWM from the current RSS, so a persistent process reports each
+// run's own peak. Best effort: older kernels ignore it.
+inline void resetPeakRss() {
+    int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0) return;
+    ssize_t ignored = write(fd, "5", 1);
+    (void)ignored;
+    close(fd);
+}
+
+struct MemoryUsage {
+    uint64_t rssBytes = 0;
+    uint64_t peakRssBytes = 0;
+    uint64_t heapInUseBytes = 0;
+    uint64_t heapMappedBytes = 0;  // of heapInUseBytes, in chunks mmap'ed on their own
+
+    static MemoryUsage read() {
+        MemoryUsage usage;
+        int fd = open("/proc/self/status", O_RDONLY);
+        if (fd >= 0) {
+            char buffer[4096];
+            ssize_t n = ::read(fd, buffer, sizeof(buffer) - 1);
+            close(fd);
+            if (n > 0) {
+                buffer[n] = '\0';
+                usage.rssBytes = statusKb(buffer, "VmRSS:") * 1024;
+                usage.peakRssBytes = statusKb(buffer, "VmHWM:") * 1024;
+            }
+        }
+        struct mallinfo2 info = mallinfo2();
+        usage.heapInUseBytes = info.uordblks + info.hblkhd;
+        usage.heapMappedBytes = info.hblkhd;
+        return usage;
+    }
+
+private:
+    static uint64_t statusKb(const char* status, const char* field) {
+        const char* line = std::strstr(status, field);
+        return line != nullptr ? std::strtoull(line + std::strlen(field), nullptr, 10) : 0;
+    }
+};
+
+// The "memory" object of a result file: usage at the end of the run and
+// the allocations made during it, per message sent or delivered
+//   {"rss_bytes": ..., "peak_rss_bytes": ..., "heap_in_use_bytes": ...,
+//    "heap_mapped_bytes": ..., "allocations": {"enabled": true, "count": ...,
+//    "frees": ..., "bytes": ..., "messages": ..., "per_message": 0.02,
+//    "bytes_per_message": 1.9}}
+struct MemoryReport {
+    MemoryUsage usage;
+    AllocationCounts allocations;
+    uint64_t messages = 0;
+
+    // Usage now, allocations since atStart
+    static MemoryReport since(const AllocationCounts& atStart, uint64_t messages) {
+        MemoryReport report;
+        report.usage = MemoryUsage::read();
+        report.allocations = allocationCounts() - atStart;
+        report.messages = messages;
+        return report;
+    }
+
+    double allocationsPerMessage() const {
+        return messages > 0 ? static_cast<double>(allocations.allocations) / messages : 0;
+    }
+
+    double bytesPerMessage() const {
+        return messages > 0 ? static_cast<double>(allocations.bytes) / messages : 0;
+    }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\"rss_bytes\": " << usage.rssBytes
+            << ", \"peak_rss_bytes\": " << usage.peakRssBytes
+            << ", \"heap_in_use_bytes\": " << usage.heapInUseBytes
+            << ", \"heap_mapped_bytes\": " << usage.heapMappedBytes
+            << ", \"allocations\": {\"enabled\": " << (ALLOCATION_COUNTING ? "true" : "false");
+        if (ALLOCATION_COUNTING) {
+            out << ", \"count\": " << allocations.allocations
+                << ", \"frees\": " << allocations.frees
+                << ", \"bytes\": " << allocations.bytes
+                << ", \"messages\": " << messages
+                << std::fixed << std::setprecision(4)
+                << ", \"per_message\": " << allocationsPerMessage()
+                << ", \"bytes_per_message\": " << std::setprecision(2) << bytesPerMessage();
+        }
+        out << "}}";
+    }
+};
+
+#endif // MEMORY_STATS_H
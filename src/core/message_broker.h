@@ -2,7 +2,30 @@
 #define MESSAGE_BROKER_H
 
 #include <string>
+#include <string_view>
 #include <functional>
+#include <span>
+#include <cstdint>
+
+// Non-owning view of a delivered message. The views point into the broker
+// client's receive buffers and are only valid for the duration of the
+// callback; copy anything that has to outlive it.
+struct MessageView {
+    std::string_view channel;
+    std::string_view payload;
+    uint64_t receiveTimestampNs = 0;  // wall clock when the client read the message
+};
+
+using MessageHandler = std::function<void(const MessageView&)>;
+
+// Client-side counters a broker can report next to the benchmark results
+struct BrokerStats {
+    uint64_t droppedMessages = 0;  // discarded by the client library (slow consumer)
+    uint64_t disconnects = 0;      // subscriber connections lost (closed, reset or slow-consumer kick)
+    uint64_t reconnects = 0;       // and re-established, subscriptions restored
+    uint64_t lastDisconnectNs = 0; // wall clock of the latest of each, 0 if none
+    uint64_t lastReconnectNs = 0;
+};
 
 class MessageBroker {
 public:
@@ -17,14 +40,46 @@ public:
     virtual bool publish(const std::string& channel, const std::string& message) = 0;
     virtual void flush() = 0;
     
+    // Publish several messages to one channel in a single call, so brokers
+    // can coalesce them into one write. Returns how many were accepted.
+    // The default falls back to one publish() per message.
+    virtual size_t publishBatch(const std::string& channel, std::span<const std::string_view> messages) {
+        size_t accepted = 0;
+        for (std::string_view message : messages) {
+            if (publish(channel, std::string(message))) accepted++;
+        }
+        return accepted;
+    }
+    
     // Subscriber methods
-    virtual bool subscribe(const std::string& channel, 
-                          std::function<void(const std::string&)> callback) = 0;
+    virtual bool subscribe(const std::string& channel, MessageHandler handler) = 0;
+    
+    // Adapter for callbacks that want an owned copy of the payload.
+    // Derived classes need `using MessageBroker::subscribe;` to keep it visible.
+    bool subscribe(const std::string& channel,
+                   std::function<void(const std::string&)> callback) {
+        return subscribe(channel, MessageHandler(
+            [callback = std::move(callback)](const MessageView& message) {
+                callback(std::string(message.payload));
+            }));
+    }
+    
+    // Subscribe to every channel matching pattern (Redis glob, NATS * / >).
+    // MessageView::channel carries the concrete channel. Returns false if
+    // the broker has no pattern subscriptions.
+    virtual bool subscribePattern(const std::string& pattern, MessageHandler handler) {
+        (void)pattern;
+        (void)handler;
+        return false;
+    }
+
     virtual void unsubscribe(const std::string& channel) = 0;
     virtual void processMessages(int timeoutMs = 1000) = 0;
     
     // Utility
     virtual std::string getName() const = 0;
+    virtual std::string getPublishMode() const { return "sync"; }
+    virtual BrokerStats getStats() const { return {}; }
 };
 
 #endif // MESSAGE_BROKER_H
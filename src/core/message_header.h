@@ -0,0 +1,95 @@
+#ifndef MESSAGE_HEADER_H
+#define MESSAGE_HEADER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// Compact binary header at the front of every benchmark payload.
+// Control messages (START_BENCHMARK / END_BENCHMARK) are plain text and never
+// start with MAGIC, so subscribers can tell the two apart with one compare.
+struct MessageHeader {
+    static constexpr uint16_t MAGIC = 0x4E46;  // "FN" little-endian
+
+    uint16_t magic = MAGIC;
+    uint16_t rateStep = 0;  // index into the publisher's rate schedule (0 for closed loop)
+    uint32_t publisherId = 0;
+    uint64_t sequence = 0;
+    uint64_t sendTimestampNs = 0;  // CLOCK_REALTIME, comparable across containers on one host;
+                                   // the intended send time when publishing open-loop
+};
+
+static_assert(sizeof(MessageHeader) == 24, "MessageHeader must stay 24 bytes on the wire");
+
+// Write the header into the first sizeof(MessageHeader) bytes of buf
+inline void encodeHeader(char* buf, const MessageHeader& header) {
+    std::memcpy(buf, &header, sizeof(MessageHeader));
+}
+
+// Returns false if the payload is too short or does not carry a header
+inline bool decodeHeader(std::string_view payload, MessageHeader& header) {
+    if (payload.size() < sizeof(MessageHeader)) return false;
+    std::memcpy(&header, payload.data(), sizeof(MessageHeader));
+    return header.magic == MessageHeader::MAGIC;
+}
+
+// Steady-state measurement window, in wall-clock ns like sendTimestampNs.
+// Messages stamped before fromNs are warm-up, at or after toNs cool-down.
+// The default window covers everything (no warm-up or cool-down).
+struct MeasurementWindow {
+    enum Phase { Warmup = 0, Steady = 1, Cooldown = 2 };
+
+    uint64_t fromNs = 0;
+    uint64_t toNs = UINT64_MAX;
+
+    bool enabled() const { return fromNs != 0 || toNs != UINT64_MAX; }
+
+    Phase phaseOf(uint64_t timestampNs) const {
+        if (timestampNs < fromNs) return Warmup;
+        return timestampNs < toNs ? Steady : Cooldown;
+    }
+
+    double seconds() const { return enabled() ? (toNs - fromNs) / 1e9 : 0; }
+};
+
+inline bool isStartMarker(std::string_view payload) {
+    return payload.substr(0, 15) == "START_BENCHMARK";
+}
+
+// START_BENCHMARK optionally carries the window and the publisher's batch
+// id: "START_BENCHMARK <fromNs> <toNs> [<batchId>]". Subscribers that stay
+// up across runs (SUBSCRIBER_PERSISTENT) file each run under that batch.
+inline std::string formatStartMarker(const MeasurementWindow& window, const std::string& batchId = "") {
+    if (!window.enabled() && batchId.empty()) return "START_BENCHMARK";
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "START_BENCHMARK %llu %llu",
+                  static_cast<unsigned long long>(window.fromNs),
+                  static_cast<unsigned long long>(window.toNs));
+    return batchId.empty() ? std::string(buf) : std::string(buf) + " " + batchId;
+}
+
+// Returns false if the payload is not a START marker; a bare marker leaves
+// the window covering everything and batchId (if given) empty
+inline bool parseStartMarker(std::string_view payload, MeasurementWindow& window,
+                             std::string* batchId = nullptr) {
+    constexpr std::string_view marker = "START_BENCHMARK";
+    if (!isStartMarker(payload)) return false;
+    window = MeasurementWindow();
+    if (batchId != nullptr) batchId->clear();
+    if (payload.size() > marker.size()) {
+        std::string args(payload.substr(marker.size()));
+        unsigned long long from = 0, to = 0;
+        char batch[128] = {0};
+        int fields = std::sscanf(args.c_str(), "%llu %llu %127s", &from, &to, batch);
+        if (fields >= 2 && to > from) {
+            window.fromNs = from;
+            window.toNs = to;
+        }
+        if (fields == 3 && batchId != nullptr) *batchId = batch;
+    }
+    return true;
+}
+
+#endif // MESSAGE_HEADER_H
@@ -0,0 +1,195 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include "latency_histogram.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Prometheus text exposition (format 0.0.4) for one scrape. Every metric of
+// the process carries the same constant labels, e.g.
+//   {broker="redis",subscriber="redis_subscriber"}
+class PrometheusWriter {
+public:
+    PrometheusWriter(std::ostream& o, std::string constantLabels)
+        : out(o), labels(std::move(constantLabels)) {
+        out.precision(10);
+    }
+
+    void counter(const char* name, const char* help, uint64_t value, const std::string& extra = "") {
+        header(name, help, "counter");
+        sample(name, extra, value);
+    }
+
+    template <typename Value>
+    void gauge(const char* name, const char* help, Value value, const std::string& extra = "") {
+        header(name, help, "gauge");
+        sample(name, extra, value);
+    }
+
+    // Several samples of one metric, told apart by a label (e.g. phase="warmup")
+    void header(const char* name, const char* help, const char* type) {
+        out << "# HELP " << name << ' ' << help << '\n'
+            << "# TYPE " << name << ' ' << type << '\n';
+    }
+
+    template <typename Value>
+    void sample(const char* name, const std::string& extra, Value value) {
+        out << name << '{' << labels;
+        if (!extra.empty()) out << (labels.empty() ? "" : ",") << extra;
+        out << "} " << value << '\n';
+    }
+
+    // A nanosecond LatencyHistogram as a histogram in seconds, folded into
+    // 1-2-5 steps from 1us to 10s. A sample counts as <= le only if its
+    // whole bucket is, so le counts are slight underestimates; _sum takes
+    // each bucket at its midpoint.
+    void latencyHistogram(const char* name, const char* help, const LatencyHistogram& histogram) {
+        static constexpr uint64_t BOUNDS_NS[] = {
+            1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+            1000000, 2000000, 5000000, 10000000, 20000000, 50000000, 100000000,
+            200000000, 500000000, 1000000000, 2000000000, 5000000000, 10000000000
+        };
+        header(name, help, "histogram");
+        std::string bucket = std::string(name) + "_bucket";
+        uint64_t cumulative = 0;
+        double sumNs = 0;
+        size_t index = 0;
+        for (uint64_t bound : BOUNDS_NS) {
+            for (; index < LatencyHistogram::BUCKET_COUNT && LatencyHistogram::highestValueAt(index) <= bound; index++) {
+                uint64_t c = histogram.bucketCount(index);
+                cumulative += c;
+                sumNs += c * midpoint(index);
+            }
+            std::ostringstream le;
+            le << "le=\"" << bound / 1e9 << '"';
+            sample(bucket.c_str(), le.str(), cumulative);
+        }
+        for (; index < LatencyHistogram::BUCKET_COUNT; index++) {
+            uint64_t c = histogram.bucketCount(index);
+            cumulative += c;
+            sumNs += c * midpoint(index);
+        }
+        sample(bucket.c_str(), "le=\"+Inf\"", cumulative);
+        sample((std::string(name) + "_sum").c_str(), "", sumNs / 1e9);
+        sample((std::string(name) + "_count").c_str(), "", cumulative);
+    }
+
+private:
+    static double midpoint(size_t index) {
+        return (static_cast<double>(LatencyHistogram::lowestValueAt(index)) +
+                static_cast<double>(LatencyHistogram::highestValueAt(index))) / 2;
+    }
+
+    std::ostream& out;
+    std::string labels;
+};
+
+// Live metrics for long runs: a background thread answers HTTP GETs on
+// port with whatever render() writes, Prometheus text for /metrics. It
+// serves one scrape at a time and never touches the receive path; render()
+// should only do relaxed loads (LocalCounter::get(), histogram buckets),
+// as ThroughputSampler's read callback does.
+class MetricsExporter {
+public:
+    using Render = std::function<void(PrometheusWriter&)>;
+
+    ~MetricsExporter() {
+        stop();
+    }
+
+    // False if the port cannot be bound
+    bool start(int metricsPort, std::string constantLabels, Render renderMetrics) {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd < 0) return false;
+        int yes = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(metricsPort));
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 8) != 0) {
+            std::cerr << "Warning: metrics endpoint cannot listen on port " << metricsPort << ": "
+                      << std::strerror(errno) << std::endl;
+            close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+        labels = std::move(constantLabels);
+        render = std::move(renderMetrics);
+        running.store(true, std::memory_order_relaxed);
+        worker = std::thread([this] { serve(); });
+        return true;
+    }
+
+    void stop() {
+        running.store(false, std::memory_order_relaxed);
+        if (worker.joinable()) worker.join();
+        if (listenFd >= 0) close(listenFd);
+        listenFd = -1;
+    }
+
+private:
+    int listenFd = -1;
+    std::string labels;
+    Render render;
+    std::atomic<bool> running{false};
+    std::thread worker;
+
+    void serve() {
+        while (running.load(std::memory_order_relaxed)) {
+            // Wake up now and then to notice stop()
+            struct pollfd pfd = { listenFd, POLLIN, 0 };
+            if (poll(&pfd, 1, 500) <= 0) continue;
+            int client = accept(listenFd, nullptr, nullptr);
+            if (client < 0) continue;
+            respond(client);
+            close(client);
+        }
+    }
+
+    void respond(int client) {
+        struct timeval timeout = { 2, 0 };  // a stalled scraper must not hold the next one
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        char request[2048];
+        ssize_t n = recv(client, request, sizeof(request) - 1, 0);
+        if (n <= 0) return;
+        request[n] = '\0';
+
+        std::string status = "200 OK";
+        std::ostringstream body;
+        if (std::strncmp(request, "GET /metrics", 12) == 0 || std::strncmp(request, "GET / ", 6) == 0) {
+            PrometheusWriter writer(body, labels);
+            render(writer);
+        } else {
+            status = "404 Not Found";
+            body << "metrics are at /metrics\n";
+        }
+        std::string text = body.str();
+        std::ostringstream response;
+        response << "HTTP/1.1 " << status << "\r\n"
+                 << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                 << "Content-Length: " << text.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << text;
+        std::string bytes = response.str();
+        for (size_t sent = 0; sent < bytes.size();) {
+            ssize_t written = send(client, bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+            if (written <= 0) return;
+            sent += static_cast<size_t>(written);
+        }
+    }
+};
+
+#endif // METRICS_EXPORTER_H
@@ -0,0 +1,112 @@
+#ifndef OUTAGE_TRACKER_H
+#define OUTAGE_TRACKER_H
+
+#include "benchmark_common.h"
+#include "message_broker.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// One loss of a subscriber connection, in wall-clock ns:
+//   downNs          the client noticed the connection was gone
+//   upNs            reconnected and resubscribed, 0 if it never came back
+//   firstMessageNs  first benchmark message received after that, 0 if none
+//   lostMessages    sequence loss that appeared from downNs to a second
+//                   after the first message back
+struct Outage {
+    uint64_t downNs = 0;
+    uint64_t upNs = 0;
+    uint64_t firstMessageNs = 0;
+    uint64_t lostMessages = 0;
+};
+
+// Outages of one subscriber thread, followed from the BrokerStats the
+// receive loop reads after every processMessages(). The message path only
+// calls onMessage(), one relaxed load while no outage is open; the bookkeeping
+// runs on the receiving thread and locks only when something changes, so
+// main can take outages() at any time.
+class OutageTracker {
+public:
+    // Any thread that records messages (the handoff worker included)
+    void onMessage(uint64_t receivedNs) {
+        if (!awaitingMessage.load(std::memory_order_relaxed)) return;
+        firstMessageNs.store(receivedNs, std::memory_order_relaxed);
+        awaitingMessage.store(false, std::memory_order_release);
+    }
+
+    // Receiving thread; lostNow is the thread's live sequence loss
+    void update(const BrokerStats& stats, uint64_t lostNow) {
+        if (stats.disconnects > disconnectsSeen) {
+            disconnectsSeen = stats.disconnects;
+            std::lock_guard<std::mutex> lock(mutex);
+            // A second drop before anything came back extends the open outage
+            if (!open) {
+                current = Outage{};
+                current.downNs = stats.lastDisconnectNs != 0 ? stats.lastDisconnectNs : wallClockNs();
+                lostAtDown = lostNow;
+                open = true;
+            }
+            current.upNs = 0;
+            current.firstMessageNs = 0;
+            awaitingMessage.store(true, std::memory_order_relaxed);
+        }
+        if (stats.reconnects > reconnectsSeen) {
+            reconnectsSeen = stats.reconnects;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (open) current.upNs = stats.lastReconnectNs != 0 ? stats.lastReconnectNs : wallClockNs();
+        }
+        if (!open || current.upNs == 0) return;
+
+        if (current.firstMessageNs == 0) {
+            if (awaitingMessage.load(std::memory_order_acquire)) return;
+            uint64_t first = firstMessageNs.load(std::memory_order_relaxed);
+            if (first < current.upNs) {
+                // Still draining what was buffered before the drop
+                awaitingMessage.store(true, std::memory_order_relaxed);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            current.firstMessageNs = first;
+        }
+        // Gaps are counted once later messages arrive, so give loss a moment
+        if (wallClockNs() - current.firstMessageNs >= SETTLE_NS) {
+            std::lock_guard<std::mutex> lock(mutex);
+            current.lostMessages = lostNow > lostAtDown ? lostNow - lostAtDown : 0;
+            closed.push_back(current);
+            open = false;
+        }
+    }
+
+    // Closed outages plus the open one, if any
+    std::vector<Outage> outages() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Outage> all = closed;
+        if (open) all.push_back(current);
+        return all;
+    }
+
+    // Persistent mode: forget the outages of the run just written
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed.clear();
+    }
+
+private:
+    static constexpr uint64_t SETTLE_NS = 1000000000;
+
+    std::atomic<bool> awaitingMessage{false};
+    std::atomic<uint64_t> firstMessageNs{0};
+
+    // Receiving thread only
+    uint64_t disconnectsSeen = 0;
+    uint64_t reconnectsSeen = 0;
+    uint64_t lostAtDown = 0;
+
+    mutable std::mutex mutex;  // guards current, open and closed
+    Outage current;
+    bool open = false;
+    std::vector<Outage> closed;
+};
+
+#endif // OUTAGE_TRACKER_H
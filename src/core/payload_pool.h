@@ -0,0 +1,133 @@
+#ifndef PAYLOAD_POOL_H
+#define PAYLOAD_POOL_H
+
+#include "message_header.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Payload size model, configured from .env:
+//
+//   PAYLOAD_DISTRIBUTION=fixed      PAYLOAD_SIZE=256
+//   PAYLOAD_DISTRIBUTION=uniform    PAYLOAD_SIZE_MIN=256 PAYLOAD_SIZE_MAX=16384
+//   PAYLOAD_DISTRIBUTION=histogram  PAYLOAD_HISTOGRAM_FILE=/app/sizes.txt
+//
+// The histogram file has one "<size_bytes> <weight>" pair per line, which is
+// enough to express bimodal or measured production size mixes.
+// Sizes are clamped so every payload can hold a MessageHeader.
+class PayloadSizeDistribution {
+public:
+    std::string kind = "fixed";
+    size_t fixedSize = sizeof(MessageHeader);
+    size_t minSize = sizeof(MessageHeader);
+    size_t maxSize = sizeof(MessageHeader);
+    std::vector<size_t> histogramSizes;
+    std::vector<double> histogramWeights;
+
+    static PayloadSizeDistribution fromConfig(const std::string& kind, int size, int minSize, int maxSize,
+                                              const std::string& histogramFile) {
+        PayloadSizeDistribution d;
+        d.kind = kind.empty() ? "fixed" : kind;
+        d.fixedSize = clampSize(size);
+        d.minSize = clampSize(minSize);
+        d.maxSize = std::max(d.minSize, clampSize(maxSize));
+
+        if (d.kind == "histogram") {
+            std::ifstream file(histogramFile);
+            if (!file.is_open()) {
+                std::cerr << "Warning: Could not open payload histogram: " << histogramFile
+                          << ", falling back to fixed size" << std::endl;
+                d.kind = "fixed";
+                return d;
+            }
+            std::string line;
+            while (std::getline(file, line)) {
+                if (line.empty() || line[0] == '#') continue;
+                std::istringstream in(line);
+                long long bytes = 0;
+                double weight = 0;
+                if (in >> bytes >> weight && weight > 0) {
+                    d.histogramSizes.push_back(clampSize(static_cast<int>(bytes)));
+                    d.histogramWeights.push_back(weight);
+                }
+            }
+            if (d.histogramSizes.empty()) {
+                std::cerr << "Warning: Empty payload histogram, falling back to fixed size" << std::endl;
+                d.kind = "fixed";
+            }
+        } else if (d.kind != "uniform" && d.kind != "fixed") {
+            std::cerr << "Warning: Unknown PAYLOAD_DISTRIBUTION '" << d.kind << "', using fixed" << std::endl;
+            d.kind = "fixed";
+        }
+        return d;
+    }
+
+    template <typename Rng>
+    size_t sample(Rng& rng) const {
+        if (kind == "uniform") {
+            return std::uniform_int_distribution<size_t>(minSize, maxSize)(rng);
+        }
+        if (kind == "histogram") {
+            std::discrete_distribution<size_t> pick(histogramWeights.begin(), histogramWeights.end());
+            return histogramSizes[pick(rng)];
+        }
+        return fixedSize;
+    }
+
+    std::string describe() const {
+        std::ostringstream out;
+        if (kind == "uniform") out << "uniform " << minSize << "-" << maxSize << " bytes";
+        else if (kind == "histogram") out << "histogram (" << histogramSizes.size() << " sizes)";
+        else out << "fixed " << fixedSize << " bytes";
+        return out.str();
+    }
+
+private:
+    static size_t clampSize(int size) {
+        return std::max(static_cast<size_t>(size > 0 ? size : 0), sizeof(MessageHeader));
+    }
+};
+
+// Per-thread ring of pre-filled payload buffers. All sampling and allocation
+// happens up front; the publish loop only patches the header in place and
+// moves to the next slot, so it never touches the allocator.
+class PayloadPool {
+public:
+    PayloadPool(const PayloadSizeDistribution& distribution, size_t slots, uint32_t seed) {
+        std::mt19937_64 rng(seed);
+        buffers.reserve(std::max<size_t>(slots, 1));
+        for (size_t i = 0; i < std::max<size_t>(slots, 1); i++) {
+            std::string buffer(distribution.sample(rng), '\0');
+            // Non-zero filler so compression or zero-page tricks don't flatter anyone
+            for (size_t j = sizeof(MessageHeader); j < buffer.size(); j++) {
+                buffer[j] = static_cast<char>('a' + (j + i) % 26);
+            }
+            buffers.push_back(std::move(buffer));
+        }
+    }
+
+    // Next buffer in the ring with the header written into its first bytes
+    std::string& next(const MessageHeader& header) {
+        std::string& buffer = buffers[cursor];
+        if (++cursor == buffers.size()) cursor = 0;
+        encodeHeader(buffer.data(), header);
+        return buffer;
+    }
+
+    size_t averageSize() const {
+        size_t total = 0;
+        for (const auto& b : buffers) total += b.size();
+        return buffers.empty() ? 0 : total / buffers.size();
+    }
+
+private:
+    std::vector<std::string> buffers;
+    size_t cursor = 0;
+};
+
+#endif // PAYLOAD_POOL_H
@@ -0,0 +1,99 @@
+#ifndef RATE_SCHEDULE_H
+#define RATE_SCHEDULE_H
+
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Hint to the CPU that we are in a spin-wait loop
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Precise wait: sleep while the target is far away, then spin the last stretch.
+// Plain sleep_for overshoots by tens of microseconds, which would cap the
+// achievable per-thread rate well below what the broker can take.
+inline void waitUntil(std::chrono::steady_clock::time_point target) {
+    constexpr auto spinThreshold = std::chrono::microseconds(100);
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= target) return;
+        auto remaining = target - now;
+        if (remaining > spinThreshold) {
+            std::this_thread::sleep_for(remaining - spinThreshold);
+        } else {
+            cpuRelax();
+        }
+    }
+}
+
+// Aggregate publish rate over time for open-loop runs.
+// An empty schedule means closed loop (publish as fast as possible).
+//
+//   PUBLISH_RATE=100000                 constant 100k msg/s
+//   PUBLISH_RATE_RAMP=10000,50000,100000  explicit steps
+//   PUBLISH_RATE_RAMP=10000:500000:50000  start:end:increment
+//
+// Each step lasts stepSeconds; the last step holds until the run ends.
+class RateSchedule {
+public:
+    std::vector<double> rates;  // aggregate msg/s per step
+    double stepSeconds = 0;
+
+    static RateSchedule parse(const std::string& ramp, double fixedRate,
+                              double durationSeconds, double stepSecondsOverride) {
+        RateSchedule schedule;
+        if (!ramp.empty()) {
+            if (ramp.find(':') != std::string::npos) {
+                double start = 0, end = 0, increment = 0;
+                char sep1 = 0, sep2 = 0;
+                std::istringstream in(ramp);
+                in >> start >> sep1 >> end >> sep2 >> increment;
+                if (start > 0 && increment > 0) {
+                    for (double r = start; r <= end + 1e-9; r += increment) {
+                        schedule.rates.push_back(r);
+                    }
+                }
+            } else {
+                std::istringstream in(ramp);
+                std::string item;
+                while (std::getline(in, item, ',')) {
+                    double r = std::atof(item.c_str());
+                    if (r > 0) schedule.rates.push_back(r);
+                }
+            }
+        } else if (fixedRate > 0) {
+            schedule.rates.push_back(fixedRate);
+        }
+
+        if (!schedule.rates.empty()) {
+            schedule.stepSeconds = stepSecondsOverride > 0
+                ? stepSecondsOverride
+                : durationSeconds / schedule.rates.size();
+        }
+        return schedule;
+    }
+
+    bool isOpenLoop() const { return !rates.empty(); }
+
+    size_t stepAt(std::chrono::steady_clock::duration elapsed) const {
+        if (rates.size() <= 1 || stepSeconds <= 0) return 0;
+        double seconds = std::chrono::duration<double>(elapsed).count();
+        size_t step = seconds <= 0 ? 0 : static_cast<size_t>(seconds / stepSeconds);
+        return step < rates.size() ? step : rates.size() - 1;
+    }
+
+    // Total run length implied by the schedule, or 0 to keep the configured duration
+    double totalSeconds() const {
+        return rates.size() > 1 ? stepSeconds * rates.size() : 0;
+    }
+};
+
+#endif // RATE_SCHEDULE_H
@@ -0,0 +1,171 @@
+#ifndef SEQUENCE_TRACKER_H
+#define SEQUENCE_TRACKER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// Sliding-window loss/duplicate detector for one publisher's sequence stream.
+// Keeps a ring bitmap of the last WINDOW sequence numbers, indexed by
+// sequence % WINDOW, so the in-order case is a compare and a single bit set.
+// A gap is counted as lost up front and credited back if the missing
+// sequence shows up later (out of order) while still inside the window.
+class SequenceWindow {
+public:
+    static constexpr uint64_t WINDOW = 4096;
+
+    uint64_t received = 0;
+    uint64_t lost = 0;           // missing and not (yet) recovered
+    uint64_t duplicates = 0;
+    uint64_t outOfOrder = 0;     // arrived after a higher sequence
+    uint64_t tooLate = 0;        // older than the window, cannot classify
+    uint64_t longestGap = 0;
+
+    void observe(uint64_t sequence) {
+        received++;
+        if (sequence >= next) {
+            uint64_t gap = sequence - next;
+            if (gap != 0) {
+                lost += gap;
+                if (gap > longestGap) longestGap = gap;
+                clearRange(next, sequence);
+            }
+            setBit(sequence);
+            next = sequence + 1;
+            return;
+        }
+
+        if (next - sequence > WINDOW) {
+            tooLate++;
+        } else if (testBit(sequence)) {
+            duplicates++;
+        } else {
+            setBit(sequence);
+            outOfOrder++;
+            lost--;
+        }
+    }
+
+    uint64_t highestSeen() const { return next == 0 ? 0 : next - 1; }
+
+private:
+    static constexpr uint64_t WORDS = WINDOW / 64;
+
+    void setBit(uint64_t seq) { bits[(seq % WINDOW) / 64] |= (uint64_t(1) << (seq % 64)); }
+    bool testBit(uint64_t seq) const { return bits[(seq % WINDOW) / 64] & (uint64_t(1) << (seq % 64)); }
+
+    // Clear slots for sequences [from, to) so stale bits from one window ago
+    // are not mistaken for receipts
+    void clearRange(uint64_t from, uint64_t to) {
+        if (to - from >= WINDOW) {
+            bits.fill(0);
+            return;
+        }
+        for (uint64_t seq = from; seq < to;) {
+            if (seq % 64 == 0 && to - seq >= 64) {
+                bits[(seq % WINDOW) / 64] = 0;
+                seq += 64;
+            } else {
+                bits[(seq % WINDOW) / 64] &= ~(uint64_t(1) << (seq % 64));
+                seq++;
+            }
+        }
+    }
+
+    uint64_t next = 0;  // one past the highest sequence seen
+    std::array<uint64_t, WORDS> bits{};
+};
+
+// Tracks one SequenceWindow per sequence stream: a publisher id, or a
+// (topic, publisher) pair when publishers number each topic separately
+// (see streamKey). Consecutive messages usually come from the same stream,
+// so the last window is cached to skip the hash lookup. Single-threaded:
+// each subscriber thread owns its tracker. Only liveLost() and
+// liveDuplicates() may be read from other threads while it observes.
+class SequenceTracker {
+public:
+    struct Summary {
+        uint64_t publishers = 0;
+        uint64_t streams = 0;
+        uint64_t received = 0;
+        uint64_t lost = 0;
+        uint64_t duplicates = 0;
+        uint64_t outOfOrder = 0;
+        uint64_t tooLate = 0;
+        uint64_t longestGap = 0;
+
+        // Combine summaries from independent connections (e.g. subscriber threads)
+        void add(const Summary& other) {
+            if (other.publishers > publishers) publishers = other.publishers;
+            if (other.streams > streams) streams = other.streams;
+            received += other.received;
+            lost += other.lost;
+            duplicates += other.duplicates;
+            outOfOrder += other.outOfOrder;
+            tooLate += other.tooLate;
+            if (other.longestGap > longestGap) longestGap = other.longestGap;
+        }
+    };
+
+    static uint64_t streamKey(uint32_t publisherId, uint32_t topic = 0) {
+        return (static_cast<uint64_t>(topic) << 32) | publisherId;
+    }
+
+    void observe(uint64_t stream, uint64_t sequence) {
+        if (cached == nullptr || cachedId != stream) {
+            cached = &windows[stream];
+            cachedId = stream;
+        }
+        uint64_t lost = cached->lost;
+        uint64_t duplicates = cached->duplicates;
+        cached->observe(sequence);
+        // Published only on change, so the in-order path stays a compare.
+        // Unsigned wrap-around also covers lost going down.
+        if (cached->lost != lost) bump(lostTotal, cached->lost - lost);
+        if (cached->duplicates != duplicates) bump(duplicatesTotal, 1);
+    }
+
+    void reset() {
+        windows.clear();
+        cached = nullptr;
+        lostTotal.store(0, std::memory_order_relaxed);
+        duplicatesTotal.store(0, std::memory_order_relaxed);
+    }
+
+    // Running totals over every stream, for live metrics during the run
+    uint64_t liveLost() const { return lostTotal.load(std::memory_order_relaxed); }
+    uint64_t liveDuplicates() const { return duplicatesTotal.load(std::memory_order_relaxed); }
+
+    Summary summary() const {
+        Summary s;
+        s.streams = windows.size();
+        std::unordered_set<uint32_t> publisherIds;
+        for (const auto& entry : windows) {
+            publisherIds.insert(static_cast<uint32_t>(entry.first));
+            const SequenceWindow& w = entry.second;
+            s.received += w.received;
+            s.lost += w.lost;
+            s.duplicates += w.duplicates;
+            s.outOfOrder += w.outOfOrder;
+            s.tooLate += w.tooLate;
+            if (w.longestGap > s.longestGap) s.longestGap = w.longestGap;
+        }
+        s.publishers = publisherIds.size();
+        return s;
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& total, uint64_t delta) {
+        total.store(total.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::unordered_map<uint64_t, SequenceWindow> windows;
+    SequenceWindow* cached = nullptr;
+    uint64_t cachedId = 0;
+    std::atomic<uint64_t> lostTotal{0};
+    std::atomic<uint64_t> duplicatesTotal{0};
+};
+
+#endif // SEQUENCE_TRACKER_H
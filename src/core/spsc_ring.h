@@ -0,0 +1,80 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded single-producer single-consumer ring. The slots are allocated up
+// front and handed to the caller in place (tryPush fills one, tryPop reads
+// one), so slot types that own buffers, like std::string, keep their
+// capacity from one lap to the next and the steady state allocates nothing.
+//
+// Each side keeps its index on its own cache line together with a cached
+// copy of the other side's, and only reloads that when the ring looks full
+// (producer) or empty (consumer).
+template <typename T>
+class SpscRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscRing(size_t capacity) : slots(roundUp(capacity)), mask(slots.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: fill(T&) writes the next slot; false if the ring is full
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        size_t tail = producer.tail.load(std::memory_order_relaxed);
+        if (tail - producer.cachedHead >= slots.size()) {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            if (tail - producer.cachedHead >= slots.size()) return false;
+        }
+        fill(slots[tail & mask]);
+        producer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: consume(T&) reads the oldest slot; false if the ring is empty
+    template <typename Consume>
+    bool tryPop(Consume&& consume) {
+        size_t head = consumer.head.load(std::memory_order_relaxed);
+        if (head == consumer.cachedTail) {
+            consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+            if (head == consumer.cachedTail) return false;
+        }
+        consume(slots[head & mask]);
+        consumer.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Occupancy as the consumer sees it; exact only on the consumer thread
+    size_t size() const {
+        return producer.tail.load(std::memory_order_acquire) - consumer.head.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return slots.size(); }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t size = 1;
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+    struct alignas(64) ProducerSide {
+        std::atomic<size_t> tail{0};
+        size_t cachedHead = 0;
+    };
+    struct alignas(64) ConsumerSide {
+        std::atomic<size_t> head{0};
+        size_t cachedTail = 0;
+    };
+
+    std::vector<T> slots;
+    size_t mask;
+    ProducerSide producer;
+    ConsumerSide consumer;
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,196 @@
+#ifndef START_BARRIER_H
+#define START_BARRIER_H
+
+#include "message_broker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+// Readiness handshake between subscriber processes and the publisher,
+// replacing fixed sleeps before the run:
+//
+//   1. each subscriber process, once every thread is subscribed, repeats
+//      "READY <instance> <threads>" on CONTROL_CHANNEL until it sees START
+//   2. the publisher waits for NUM_SUBSCRIBERS distinct instances, then sends
+//      START on the data channel
+//   3. each subscriber answers "STARTED <instance>" once all its threads
+//      have seen START; the publisher waits for those, then releases its
+//      publisher threads together on an in-process Barrier
+//
+// With PUBLISHER_PROCESSES=P > 1 the publisher processes (possibly on other
+// nodes) first gather on the same channel:
+//
+//   0. each repeats "PUBLISHER <instance> <threads>" until it has seen all
+//      P; ranked by instance id, the first one leads and the others follow
+//   1-3 as above, run by the leader alone, which also sends
+//      "GO <wall clock ns>": the start time every process waits for
+//
+// Each process sends its own END, so subscribers wait for P of them.
+//
+// Control messages always travel over plain pub/sub (Redis or core NATS),
+// whatever the data-plane broker, so durable streams never see them.
+constexpr const char* CONTROL_CHANNEL = "benchmark_control";
+
+// Unique per subscriber process: replicas share SUBSCRIBER_ID but not the hostname
+inline std::string controlInstanceId(const std::string& subscriberId) {
+    const char* hostname = std::getenv("HOSTNAME");
+    return subscriberId + "@" + (hostname ? hostname : "local") + "-" + std::to_string(getpid());
+}
+
+inline bool announceReady(MessageBroker& control, const std::string& instance, int threads) {
+    bool sent = control.publish(CONTROL_CHANNEL, "READY " + instance + " " + std::to_string(threads));
+    control.flush();
+    return sent;
+}
+
+inline bool announceStarted(MessageBroker& control, const std::string& instance) {
+    bool sent = control.publish(CONTROL_CHANNEL, "STARTED " + instance);
+    control.flush();
+    return sent;
+}
+
+inline bool announcePublisher(MessageBroker& control, const std::string& instance, int threads) {
+    bool sent = control.publish(CONTROL_CHANNEL, "PUBLISHER " + instance + " " + std::to_string(threads));
+    control.flush();
+    return sent;
+}
+
+inline bool announceGo(MessageBroker& control, uint64_t startWallNs) {
+    bool sent = control.publish(CONTROL_CHANNEL, "GO " + std::to_string(startWallNs));
+    control.flush();
+    return sent;
+}
+
+// Where one publisher process stands among its peers
+struct PublisherRank {
+    size_t index = 0;          // position by instance id; 0 leads
+    size_t processes = 1;      // peers seen, including this one
+    int publisherIdBase = 0;   // threads of the processes ranked before this one
+};
+
+// Publisher side: collects READY / STARTED announcements, and the other
+// publisher processes' PUBLISHER / GO. Duplicates (READY and PUBLISHER are
+// repeated) are folded by instance id.
+class SubscriberReadiness {
+public:
+    explicit SubscriberReadiness(MessageBroker& controlBroker) : control(controlBroker) {}
+
+    bool listen() {
+        return control.subscribe(CONTROL_CHANNEL, [this](const MessageView& message) { onMessage(message); });
+    }
+
+    // Both return how many distinct instances had announced when they returned
+    size_t waitForReady(size_t expected, std::chrono::milliseconds timeout) {
+        return waitFor(ready, expected, timeout);
+    }
+
+    size_t waitForStarted(size_t expected, std::chrono::milliseconds timeout) {
+        return waitFor(started, expected, timeout);
+    }
+
+    // Subscriber threads behind the READY announcements
+    int readyThreads() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return threads;
+    }
+
+    // Wait for expected publisher processes, calling announce every 250 ms
+    // in the meantime, since peers may start listening after us
+    size_t waitForPublishers(size_t expected, std::chrono::milliseconds timeout,
+                             const std::function<void()>& announce) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            announce();
+            auto slice = std::min<std::chrono::steady_clock::duration>(
+                std::chrono::milliseconds(250), deadline - std::chrono::steady_clock::now());
+            size_t seen = waitFor(publishers, expected,
+                                  std::chrono::duration_cast<std::chrono::milliseconds>(slice));
+            if (seen >= expected || std::chrono::steady_clock::now() >= deadline) return seen;
+        }
+    }
+
+    PublisherRank rankOf(const std::string& instance) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        PublisherRank rank;
+        rank.processes = publishers.size();
+        for (const auto& [id, count] : publisherThreads) {
+            if (id >= instance) break;
+            rank.index++;
+            rank.publisherIdBase += count;
+        }
+        return rank;
+    }
+
+    // Start time announced by the leading publisher, or 0 on timeout
+    uint64_t waitForGo(std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (goWallNs != 0 || std::chrono::steady_clock::now() >= deadline) return goWallNs;
+            }
+            control.processMessages(20);
+        }
+    }
+
+private:
+    void onMessage(const MessageView& message) {
+        std::string_view text = message.payload;
+        std::lock_guard<std::mutex> lock(mtx);
+        if (text.substr(0, 6) == "READY ") {
+            text.remove_prefix(6);
+            size_t space = text.rfind(' ');
+            std::string instance(text.substr(0, space));
+            if (ready.insert(instance).second && space != std::string_view::npos) {
+                threads += std::atoi(std::string(text.substr(space + 1)).c_str());
+            }
+        } else if (text.substr(0, 8) == "STARTED ") {
+            started.insert(std::string(text.substr(8)));
+        } else if (text.substr(0, 10) == "PUBLISHER ") {
+            text.remove_prefix(10);
+            size_t space = text.rfind(' ');
+            std::string instance(text.substr(0, space));
+            if (publishers.insert(instance).second && space != std::string_view::npos) {
+                publisherThreads[instance] = std::atoi(std::string(text.substr(space + 1)).c_str());
+            }
+        } else if (text.substr(0, 3) == "GO ") {
+            goWallNs = std::strtoull(std::string(text.substr(3)).c_str(), nullptr, 10);
+        }
+    }
+
+    size_t waitFor(const std::set<std::string>& announced, size_t expected,
+                   std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (announced.size() >= expected || std::chrono::steady_clock::now() >= deadline) {
+                    return announced.size();
+                }
+            }
+            // Dispatches on this thread for Redis and sync NATS; async NATS
+            // delivers on its own thread, hence the mutex
+            control.processMessages(20);
+        }
+    }
+
+    MessageBroker& control;
+    mutable std::mutex mtx;
+    std::set<std::string> ready;
+    std::set<std::string> started;
+    int threads = 0;
+    std::set<std::string> publishers;
+    std::map<std::string, int> publisherThreads;
+    uint64_t goWallNs = 0;
+};
+
+#endif // START_BARRIER_H
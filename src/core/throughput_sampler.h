@@ -0,0 +1,125 @@
+#ifndef THROUGHPUT_SAMPLER_H
+#define THROUGHPUT_SAMPLER_H
+
+#include "benchmark_common.h"
+#include "memory_stats.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Cumulative counters at one instant; the sampler turns them into
+// per-interval deltas when writing
+struct CounterSnapshot {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t dropped = 0;
+};
+
+// Background thread that snapshots the run's counters every intervalMs into
+// a ring preallocated up front, so sampling never allocates or locks. The
+// read callback should only do relaxed loads (e.g. LocalCounter::get()).
+// When the ring is full the oldest samples are overwritten. Each sample
+// also records the process RSS and, built with FANOUT_ALLOC_STATS, the
+// allocation counters (memory_stats.h).
+//
+// Written as
+//   {"interval_ms": 100, "columns": ["t_ms", "messages", "bytes", "dropped", "rss_bytes",
+//    "allocs", "alloc_bytes"], "samples": [[1718000000100, 81234, 20796, 0, 41943040, 12, 960], ...]}
+// where t_ms is the wall-clock end of each interval (comparable across
+// containers), rss_bytes the RSS at that instant and the other columns are
+// deltas over that interval. allocs and alloc_bytes are only present when
+// allocations are counted.
+class ThroughputSampler {
+public:
+    using ReadCounters = std::function<CounterSnapshot()>;
+
+    ThroughputSampler(int intervalMs, size_t capacity)
+        : interval(intervalMs > 0 ? intervalMs : 100),
+          ring(capacity > 1 ? capacity : 2) {}
+
+    ~ThroughputSampler() {
+        stop();
+    }
+
+    void start(ReadCounters readCounters) {
+        read = std::move(readCounters);
+        running.store(true, std::memory_order_relaxed);
+        worker = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        running.store(false, std::memory_order_relaxed);
+        if (worker.joinable()) worker.join();
+    }
+
+    int intervalMs() const { return static_cast<int>(interval.count()); }
+
+    // Emit the intervals ending within [fromNs, toNs + one interval] (wall
+    // clock), or everything retained when both are 0. Call after stop(), or
+    // while running for a range well inside the ring (persistent subscribers).
+    void writeJson(std::ostream& out, uint64_t fromNs = 0, uint64_t toNs = 0) const {
+        uint64_t written = next.load(std::memory_order_acquire);
+        uint64_t first = written > ring.size() ? written - ring.size() : 0;
+        uint64_t slack = static_cast<uint64_t>(interval.count()) * 1000000ull;
+
+        out << "{\"interval_ms\": " << interval.count()
+            << ", \"columns\": [\"t_ms\", \"messages\", \"bytes\", \"dropped\", \"rss_bytes\""
+            << (ALLOCATION_COUNTING ? ", \"allocs\", \"alloc_bytes\"" : "") << "], \"samples\": [";
+        bool firstRow = true;
+        for (uint64_t i = first + 1; i < written; i++) {
+            const Sample& prev = ring[(i - 1) % ring.size()];
+            const Sample& cur = ring[i % ring.size()];
+            if (fromNs != 0 && (cur.timestampNs < fromNs || cur.timestampNs > toNs + slack)) continue;
+            out << (firstRow ? "" : ", ") << "[" << cur.timestampNs / 1000000
+                << ", " << cur.counters.messages - prev.counters.messages
+                << ", " << cur.counters.bytes - prev.counters.bytes
+                << ", " << cur.counters.dropped - prev.counters.dropped
+                << ", " << cur.rssBytes;
+            if (ALLOCATION_COUNTING) {
+                out << ", " << cur.allocations.allocations - prev.allocations.allocations
+                    << ", " << cur.allocations.bytes - prev.allocations.bytes;
+            }
+            out << "]";
+            firstRow = false;
+        }
+        out << "]}";
+    }
+
+private:
+    struct Sample {
+        uint64_t timestampNs = 0;
+        CounterSnapshot counters;
+        uint64_t rssBytes = 0;
+        AllocationCounts allocations;
+    };
+
+    void run() {
+        auto due = std::chrono::steady_clock::now();
+        while (running.load(std::memory_order_relaxed)) {
+            uint64_t i = next.load(std::memory_order_relaxed);
+            Sample& slot = ring[i % ring.size()];
+            slot.timestampNs = wallClockNs();
+            slot.counters = read();
+            slot.rssBytes = currentRssBytes();
+            slot.allocations = allocationCounts();
+            next.store(i + 1, std::memory_order_release);
+
+            // Fixed schedule, so a late wake-up does not shift later samples
+            due += interval;
+            std::this_thread::sleep_until(due);
+        }
+    }
+
+    std::chrono::milliseconds interval;
+    std::vector<Sample> ring;
+    std::atomic<uint64_t> next{0};  // total samples taken
+    std::atomic<bool> running{false};
+    ReadCounters read;
+    std::thread worker;
+};
+
+#endif // THROUGHPUT_SAMPLER_H
@@ -0,0 +1,116 @@
+#ifndef TOPIC_MODEL_H
+#define TOPIC_MODEL_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// How publishers spread messages over topics and which of them subscribers
+// listen to.
+//
+//   NUM_TOPICS=1             everything on "benchmark_channel" (the default)
+//   NUM_TOPICS=1000          topics "benchmark_channel.0" .. "benchmark_channel.999"
+//   TOPIC_DISTRIBUTION=zipf  topic of each publish: uniform | zipf
+//   TOPIC_ZIPF_EXPONENT=1.0  skew, topic 0 being the most popular
+//
+// START/END always go to MARKER_CHANNEL, which every subscriber subscribes
+// to in addition to its topics, so markers reach everyone whatever the
+// topic selection. With one topic the two are the same channel.
+struct TopicModel {
+    static constexpr const char* MARKER_CHANNEL = "benchmark_channel";
+
+    std::vector<std::string> names;
+    bool zipf = false;
+    double zipfExponent = 1.0;
+    std::vector<double> cdf;  // zipf only: cumulative probability by topic index
+
+    static TopicModel fromConfig(int numTopics, const std::string& distribution, double exponent) {
+        TopicModel model;
+        numTopics = std::max(numTopics, 1);
+        if (numTopics == 1) {
+            model.names.push_back(MARKER_CHANNEL);
+        } else {
+            model.names.reserve(numTopics);
+            for (int i = 0; i < numTopics; i++) {
+                model.names.push_back(std::string(MARKER_CHANNEL) + "." + std::to_string(i));
+            }
+        }
+
+        model.zipf = (distribution == "zipf" && numTopics > 1);
+        if (model.zipf) {
+            model.zipfExponent = exponent > 0 ? exponent : 1.0;
+            model.cdf.resize(numTopics);
+            double sum = 0;
+            for (int i = 0; i < numTopics; i++) {
+                sum += 1.0 / std::pow(i + 1, model.zipfExponent);
+                model.cdf[i] = sum;
+            }
+            for (double& c : model.cdf) c /= sum;
+            model.cdf.back() = 1.0;
+        }
+        return model;
+    }
+
+    size_t size() const { return names.size(); }
+    bool isMultiTopic() const { return names.size() > 1; }
+
+    // Pattern matching every topic: a Redis glob and a NATS wildcard alike
+    static std::string defaultPattern() { return std::string(MARKER_CHANNEL) + ".*"; }
+
+    std::string describe() const {
+        std::ostringstream out;
+        if (!isMultiTopic()) return MARKER_CHANNEL;
+        out << names.size() << " topics, ";
+        if (zipf) out << "zipf s=" << zipfExponent;
+        else out << "uniform";
+        return out.str();
+    }
+};
+
+// Topic index from a channel name ("benchmark_channel.42" -> 42). Markers
+// and single-topic runs map to 0.
+inline uint32_t topicIndexOf(std::string_view channel) {
+    size_t dot = channel.rfind('.');
+    if (dot == std::string_view::npos) return 0;
+    uint32_t index = 0;
+    for (size_t i = dot + 1; i < channel.size(); i++) {
+        char c = channel[i];
+        if (c < '0' || c > '9') return 0;
+        index = index * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return index;
+}
+
+// Per-thread topic choice: xorshift for the random draw, binary search over
+// the CDF for zipf. Single-topic runs never touch the generator.
+class TopicPicker {
+public:
+    TopicPicker(const TopicModel& topicModel, uint64_t seed)
+        : model(topicModel), state(seed ? seed * 0x9E3779B97F4A7C15ull : 0x9E3779B97F4A7C15ull) {}
+
+    size_t next() {
+        size_t n = model.names.size();
+        if (n == 1) return 0;
+        uint64_t r = random();
+        if (!model.zipf) return static_cast<size_t>(r % n);
+        double u = (r >> 11) * (1.0 / 9007199254740992.0);  // [0, 1)
+        return static_cast<size_t>(std::upper_bound(model.cdf.begin(), model.cdf.end(), u) - model.cdf.begin());
+    }
+
+private:
+    uint64_t random() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    const TopicModel& model;
+    uint64_t state;
+};
+
+#endif // TOPIC_MODEL_H